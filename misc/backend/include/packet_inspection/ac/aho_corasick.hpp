@@ -4,18 +4,27 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 #include <memory>
 #include <queue>
+#include <functional>
+#include <cstdint>
+#include <atomic>
 #include <nlohmann/json.hpp>
+#include "packet_inspection/simd/simd_kernels.hpp"
+#include "packet_inspection/engine/pattern_hit.hpp"
+#include "packet_inspection/engine/byte_span.hpp"
+#include "packet_inspection/engine/batch_hits.hpp"
 
 using json = nlohmann::json;
 
 /**
  * Represents a single pattern match result
+ * The pattern is referenced by id; AhoCorasick::getPattern() has its text
  */
 struct PatternMatch {
-    std::string pattern;
-    uint32_t position;  // Position in the text where pattern was found
+    uint32_t patternId;  // Lowest id with the matched pattern's text
+    uint32_t position;   // Position in the text where pattern was found
 };
 
 /**
@@ -23,20 +32,25 @@ struct PatternMatch {
  */
 struct MatchStep {
     uint8_t byte;
-    char character;
     uint32_t nodeId;
-    std::vector<std::string> outputs;  // Patterns matched at this node
+    const std::vector<uint32_t>* outputs;  // Ids of the patterns ending at this node, owned by the automaton
 };
 
 /**
  * Represents scan results
+ * Holds ids and positions only: the payload stays with the caller and the
+ * pattern texts and step outputs with the automaton (valid until it is
+ * rebuilt). Scanning into an existing result reuses its capacity.
  */
 struct ScanResult {
-    uint32_t packetId;
-    std::string payloadHex;
-    std::string payloadAscii;
+    uint32_t packetId = 0;
     std::vector<PatternMatch> matches;
     std::vector<MatchStep> steps;
+
+    void clear() {
+        matches.clear();
+        steps.clear();
+    }
 };
 
 /**
@@ -44,6 +58,8 @@ struct ScanResult {
  * - Builds trie with fail links from pattern list
  * - Provides match() function for pattern matching
  * - Returns matches with positions and step-by-step transitions
+ * - Optional hotspot profiling: sampled scans count state visits and the
+ *   fail-link chains followed from each node (see enableProfiling)
  */
 class AhoCorasick {
 private:
@@ -55,6 +71,27 @@ private:
         std::map<char, std::shared_ptr<TrieNode>> children;
         std::shared_ptr<TrieNode> failLink;
         std::vector<std::string> output;  // Patterns ending at this node
+        std::vector<uint32_t> outputIds;  // Pattern indices, parallel to output
+    };
+
+    /**
+     * NodeProfile: Sampled cost counters for one trie node
+     */
+    struct NodeProfile {
+        std::atomic<uint64_t> visits{0};        // Times the scan entered this state
+        std::atomic<uint64_t> failChains{0};    // Mismatches here that had to follow fail links
+        std::atomic<uint64_t> failSteps{0};     // Fail links followed in those chains
+        std::atomic<uint64_t> maxFailChain{0};  // Longest single chain
+    };
+
+    /**
+     * Profile: Counters for all nodes plus the sampling state
+     */
+    struct Profile {
+        uint32_t sampleEvery = 1;
+        std::atomic<uint64_t> sampledScans{0};
+        std::atomic<uint64_t> sampledBytes{0};
+        std::vector<NodeProfile> nodes;  // Indexed by TrieNode::id
     };
 
 public:
@@ -71,12 +108,74 @@ public:
      * Scan text for pattern matches
      * @param text Text to scan
      * @param packetId ID of the packet being scanned
-     * @param payloadHex Hex representation of payload
-     * @param payloadAscii ASCII representation of payload
-     * @return ScanResult with all matches and steps
+     * @return ScanResult with the first match of each pattern and every step
+     */
+    ScanResult scan(const std::string& text, uint32_t packetId);
+
+    /**
+     * Scan a scattered payload without concatenating it
+     * The automaton state carries over span boundaries, so matches crossing
+     * them are found; positions are offsets into the logical payload
+     * @param spans Payload pieces in order
+     * @param spanCount Number of spans
+     * @param packetId ID of the packet being scanned
+     * @return ScanResult with the first match of each pattern and every step
+     */
+    ScanResult scan(const ByteSpan* spans, size_t spanCount, uint32_t packetId);
+
+    /**
+     * Scan into an existing result, reusing its buffers (no allocation once they are large enough)
+     * @param spans Payload pieces in order
+     * @param spanCount Number of spans
+     * @param packetId ID of the packet being scanned
+     * @param result Cleared, then filled like the returned result of scan()
+     */
+    void scan(const ByteSpan* spans, size_t spanCount, uint32_t packetId, ScanResult& result);
+
+    /**
+     * Scan raw bytes for pattern matches without recording steps
+     * Unlike scan(), every occurrence is reported, not only the first per pattern
+     * @param data Bytes to scan
+     * @param length Number of bytes
+     * @param hits Output vector, matches are appended
+     */
+    void scanHits(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const;
+
+    /**
+     * Scan scattered spans as one payload, reporting every occurrence
+     * @param spans Payload pieces in order
+     * @param count Number of spans
+     * @param hits Output vector, matches are appended with logical offsets
+     */
+    void scanHits(const ByteSpan* spans, size_t count, std::vector<PatternHit>& hits) const;
+
+    /**
+     * Scan many packets in one call, reporting every occurrence like scanHits()
+     * Tracing and setup are paid once per batch; profiling still samples per packet
+     * @param packets One contiguous buffer per packet
+     * @param count Number of packets
+     * @param out Output columns, rows are appended grouped by packet in ascending order
+     */
+    void scanBatch(const ByteSpan* packets, size_t count, BatchHits& out) const;
+
+    /**
+     * Get a pattern by the index reported in PatternHit
+     * @param patternId Pattern index
+     * @return Pattern string
+     */
+    const std::string& getPattern(uint32_t patternId) const { return patterns[patternId]; }
+
+    /**
+     * Get number of patterns in the automaton
+     * @return Pattern count
      */
-    ScanResult scan(const std::string& text, uint32_t packetId, 
-                    const std::string& payloadHex, const std::string& payloadAscii);
+    size_t getPatternCount() const { return patterns.size(); }
+
+    /**
+     * Get number of trie nodes
+     * @return Node count
+     */
+    uint32_t getNodeCount() const { return nextNodeId; }
 
     /**
      * Export the automaton to JSON format
@@ -84,6 +183,45 @@ public:
      */
     json exportToJson() const;
 
+    /**
+     * Export the automaton with the hotspot profile merged in
+     * Same format as exportToJson(); nodes gain visits, failChains, failSteps,
+     * maxFailChain, failDepth and heat (0-1, relative to the costliest non-root node), and
+     * a top-level "profile" object summarizes the sample
+     * @return JSON representation of the trie with heatmap
+     */
+    json exportHeatmapJson() const;
+
+    /**
+     * Start profiling scans (not thread-safe against concurrent scans)
+     * @param sampleEvery Profile one scan in this many per thread (1 = every scan)
+     */
+    void enableProfiling(uint32_t sampleEvery);
+
+    /**
+     * Stop profiling and drop the collected counters
+     */
+    void disableProfiling() { profile.reset(); }
+
+    /**
+     * Check if scans are being profiled
+     * @return true after enableProfiling()
+     */
+    bool isProfiling() const { return profile != nullptr; }
+
+    /**
+     * Zero the collected counters, keeping profiling on
+     */
+    void resetProfile();
+
+    /**
+     * Feed traffic scanned by another engine into the profile
+     * Walks the trie only for sampled calls; otherwise returns at once
+     * @param data Bytes to profile
+     * @param length Number of bytes
+     */
+    void profileScan(const uint8_t* data, size_t length) const;
+
     /**
      * Clear the automaton (delete all nodes)
      */
@@ -92,6 +230,10 @@ public:
 private:
     std::shared_ptr<TrieNode> root;
     uint32_t nextNodeId;
+    std::vector<std::string> patterns;
+    std::vector<uint32_t> canonicalIds;  // Lowest id with the same text, per pattern id
+    ByteSet startBytes;    // First bytes of all patterns (both cases), for root skip-scan
+    bool rootSkip = false; // false if the root itself has outputs (empty pattern)
 
     /**
      * Create a new trie node
@@ -102,8 +244,9 @@ private:
     /**
      * Insert a single pattern into the trie
      * @param pattern Pattern to insert
+     * @param patternId Index of the pattern in the pattern list
      */
-    void insertPattern(const std::string& pattern);
+    void insertPattern(const std::string& pattern, uint32_t patternId);
 
     /**
      * Build fail links using BFS (after all patterns inserted)
@@ -117,6 +260,31 @@ private:
      * @return JSON representation of node
      */
     json nodeToJson(const std::shared_ptr<TrieNode>& node, std::set<uint32_t>& visited) const;
+
+    std::unique_ptr<Profile> profile;  // Null unless profiling
+
+    /**
+     * Decide if the calling thread profiles its next scan
+     * @return true one scan in sampleEvery
+     */
+    bool sampleThisScan() const;
+
+    /**
+     * Count one fail-link chain starting at a node
+     * @param nodeId Node where the mismatch happened
+     * @param steps Fail links followed
+     */
+    void recordFailChain(uint32_t nodeId, uint64_t steps) const;
+
+    /**
+     * scanHits() body over one contiguous chunk; the profiled instance also
+     * counts visits and fail chains
+     * @param base Logical offset of the chunk, added to hit positions
+     * @param current State to start from, updated to the state after the chunk
+     */
+    template <bool Profiled>
+    void scanHitsLoop(const uint8_t* data, size_t length, size_t base, const TrieNode*& current,
+                      std::vector<PatternHit>& hits) const;
 };
 
 #endif // AHO_CORASICK_HPP
@@ -0,0 +1,114 @@
+#ifndef CAPTURE_STREAM_HPP
+#define CAPTURE_STREAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "packet_inspection/async/executor.hpp"
+#include "packet_inspection/async/generator.hpp"
+#include "packet_inspection/async/task.hpp"
+#include "packet_inspection/engine/byte_span.hpp"
+#include "packet_inspection/engine/matcher.hpp"
+#include "packet_inspection/pcap/packet_reader.hpp"
+
+/**
+ * Coroutine front end for capture scanning
+ * Packet sources are generators, scans are tasks on an Executor, so a
+ * consumer reads as straight-line code:
+ *
+ *   CaptureCursor cursor;
+ *   if (reader.openCapture(path, cursor) < 0) return;
+ *   for (const PacketView& packet : capturePayloads(reader, cursor)) {
+ *       co_await scanAsync(executor, matcher, {packet.payload, packet.payloadLength}, hits);
+ *   }
+ *
+ * One executor hop costs a queue round trip, so per-packet awaits suit
+ * light traffic; scanCaptureAsync() batches packets and keeps several
+ * batches in flight for line-rate captures.
+ */
+
+/**
+ * Captured frames of an opened capture, TCP or not
+ * @param reader Reader the cursor was opened on; must outlive the generator
+ * @param cursor Cursor from PacketReader::openCapture()
+ */
+Generator<PacketView> captureFrames(const PacketReader& reader, CaptureCursor cursor);
+
+/**
+ * TCP payloads of an opened capture (the packets forEachPayload() visits)
+ * Views point into the reader's buffer and stay valid until it loads another capture.
+ * @param reader Reader the cursor was opened on; must outlive the generator
+ * @param cursor Cursor from PacketReader::openCapture()
+ */
+Generator<PacketView> capturePayloads(const PacketReader& reader, CaptureCursor cursor);
+
+/**
+ * Chunks read from a file descriptor (socket, pipe or file) until EOF
+ * Reads block the consuming thread. A chunk is valid until the next one is
+ * requested. A read error ends the sequence after printing it.
+ * @param fd Open descriptor; not closed by the generator
+ * @param chunkSize Largest chunk to read at once
+ */
+Generator<ByteSpan> readChunks(int fd, size_t chunkSize = 64 * 1024);
+
+/**
+ * Scan one buffer on the executor
+ * @param executor Executor the scan runs on
+ * @param matcher Engine to scan with
+ * @param data Bytes to scan; must stay valid until the task finishes
+ * @param hits Output vector, matches are appended
+ */
+Task<void> scanAsync(Executor& executor, const Matcher& matcher, ByteSpan data, std::vector<PatternHit>& hits);
+
+/**
+ * Packets scanned together in one executor hop
+ */
+struct AsyncScanBatch {
+    std::vector<PacketView> packets;
+    std::vector<PatternHit> hits;         // Hits of all packets, positions relative to each payload
+    std::vector<uint32_t> hitOffsets;     // Hits of packets[i] are hits[hitOffsets[i]..hitOffsets[i + 1])
+
+    void clear() {
+        packets.clear();
+        hits.clear();
+        hitOffsets.clear();
+    }
+};
+
+/**
+ * Scan a batch of packets on the executor, filling hits and hitOffsets
+ * @param executor Executor the scan runs on
+ * @param matcher Engine to scan with
+ * @param batch Packets to scan; payloads must stay valid until the task finishes
+ */
+Task<void> scanAsync(Executor& executor, const Matcher& matcher, AsyncScanBatch& batch);
+
+/**
+ * Totals of one scanCaptureAsync() run
+ */
+struct AsyncScanSummary {
+    int64_t bytesRead = -1;  // Capture file size, -1 if it could not be opened
+    uint64_t packets = 0;    // Packets with a TCP payload
+    uint64_t payloadBytes = 0;
+    uint64_t hits = 0;
+    uint64_t batches = 0;
+};
+
+/**
+ * Scan the TCP payloads of a capture on the executor
+ * Packets are gathered into batches; up to inFlight batches are scanned
+ * concurrently before the next ones are gathered.
+ * @param executor Executor the scans run on
+ * @param matcher Engine to scan with
+ * @param path Path to the .pcap file
+ * @param batchSize Packets per batch
+ * @param inFlight Batches scanned concurrently (0 = executor thread count)
+ * @param onBatch Called with each scanned batch, in capture order, on an executor thread
+ * @return Totals; bytesRead is -1 if the capture could not be read
+ */
+Task<AsyncScanSummary> scanCaptureAsync(Executor& executor, const Matcher& matcher, std::string path,
+                                        size_t batchSize = 256, size_t inFlight = 0,
+                                        std::function<void(const AsyncScanBatch&)> onBatch = nullptr);
+
+#endif // CAPTURE_STREAM_HPP
@@ -0,0 +1,87 @@
+#ifndef EXECUTOR_HPP
+#define EXECUTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+/**
+ * Executor: Thread pool that resumes coroutines
+ * - co_await executor.schedule() moves the awaiting coroutine onto a pool
+ *   thread; everything after it runs there
+ * - Workers take a share of the ready queue (its size over the thread count)
+ *   in one lock and resume it as a batch, so under load the lock is taken
+ *   once per batch rather than once per coroutine
+ * - Posting only signals when a worker is actually asleep
+ *
+ * The destructor drains the queue and joins the workers; coroutines must not
+ * schedule onto an executor that is being destroyed.
+ */
+class Executor {
+public:
+    /**
+     * @param threads Worker threads (0 = hardware concurrency)
+     */
+    explicit Executor(unsigned threads = 0);
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    /**
+     * Awaiter returned by schedule()
+     */
+    struct ScheduleAwaiter {
+        Executor& executor;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { executor.post(handle); }
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * Continue the awaiting coroutine on a pool thread
+     *   co_await executor.schedule();
+     */
+    ScheduleAwaiter schedule() { return ScheduleAwaiter{*this}; }
+
+    /**
+     * Queue a suspended coroutine to be resumed by a worker
+     * @param handle Coroutine to resume
+     */
+    void post(std::coroutine_handle<> handle);
+
+    unsigned threadCount() const { return workers; }
+
+    /**
+     * Counters since construction
+     * @return {"threads", "posted", "resumed", "batches", "wakeups"}
+     */
+    json statsJson() const;
+
+private:
+    void workerLoop();
+
+    unsigned workers;  // Fixed before any thread starts; threads.size() is not while they are spawned
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::coroutine_handle<>> ready;   // Guarded by mutex
+    unsigned sleeping = 0;                       // Workers waiting on wake, guarded by mutex
+    bool stopping = false;                       // Guarded by mutex
+    std::vector<std::thread> threads;
+
+    std::atomic<uint64_t> posted{0};
+    std::atomic<uint64_t> resumed{0};
+    std::atomic<uint64_t> batches{0};
+    std::atomic<uint64_t> wakeups{0};
+};
+
+#endif // EXECUTOR_HPP
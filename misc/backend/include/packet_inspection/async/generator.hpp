@@ -0,0 +1,112 @@
+#ifndef GENERATOR_HPP
+#define GENERATOR_HPP
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <utility>
+
+/**
+ * Generator: Synchronous pull-based coroutine sequence
+ * The body runs on the consuming thread, one co_yield per iteration step.
+ * Yielded values are referenced, not copied: a reference from the iterator
+ * stays valid until the iterator is advanced.
+ *
+ *   Generator<int> count(int n) { for (int i = 0; i < n; ++i) co_yield i; }
+ *   for (int i : count(3)) { ... }
+ */
+template <typename T>
+class Generator {
+public:
+    struct promise_type {
+        const T* current = nullptr;
+        std::exception_ptr error;
+
+        Generator get_return_object() {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+
+        // The yielded object outlives the suspension (it is a local or a temporary of the co_yield)
+        std::suspend_always yield_value(const T& value) noexcept {
+            current = &value;
+            return {};
+        }
+
+        void return_void() noexcept {}
+        void unhandled_exception() { error = std::current_exception(); }
+
+        // co_await is meaningless in a synchronous generator
+        template <typename U>
+        std::suspend_never await_transform(U&&) = delete;
+    };
+
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+        explicit Iterator(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+        const T& operator*() const { return *handle.promise().current; }
+        const T* operator->() const { return handle.promise().current; }
+
+        Iterator& operator++() {
+            advance(handle);
+            return *this;
+        }
+        void operator++(int) { ++*this; }
+
+        bool operator==(std::default_sentinel_t) const { return !handle || handle.done(); }
+
+    private:
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    Generator(Generator&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Generator& operator=(Generator&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+
+    ~Generator() {
+        if (handle) handle.destroy();
+    }
+
+    /**
+     * Run the body to its first co_yield
+     * A generator can be iterated once; begin() on a started one continues where it stopped.
+     */
+    Iterator begin() {
+        if (handle && !started) {
+            started = true;
+            advance(handle);
+        }
+        return Iterator(handle);
+    }
+
+    std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+    explicit Generator(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    static void advance(std::coroutine_handle<promise_type> handle) {
+        handle.resume();
+        if (handle.done() && handle.promise().error) {
+            std::rethrow_exception(handle.promise().error);
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle;
+    bool started = false;
+};
+
+#endif // GENERATOR_HPP
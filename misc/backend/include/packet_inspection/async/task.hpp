@@ -0,0 +1,295 @@
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <latch>
+#include <optional>
+#include <utility>
+#include <vector>
+
+template <typename T = void>
+class Task;
+
+namespace task_detail {
+
+/**
+ * Resumes whoever awaited the task once its body finishes
+ * (symmetric transfer, so long chains of awaits do not grow the stack)
+ */
+struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+        std::coroutine_handle<> continuation = handle.promise().continuation;
+        return continuation ? continuation : std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+};
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+
+    void rethrowIfFailed() const {
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+template <typename T>
+struct Promise : PromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& result) {
+        value.emplace(std::forward<U>(result));
+    }
+
+    T take() {
+        rethrowIfFailed();
+        return std::move(*value);
+    }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    Task<void> get_return_object() noexcept;
+
+    void return_void() noexcept {}
+
+    void take() const { rethrowIfFailed(); }
+};
+
+} // namespace task_detail
+
+/**
+ * Task: Lazily started, awaitable coroutine
+ * - Nothing runs until the task is awaited (or passed to syncWait/whenAll)
+ * - The body runs on the awaiting thread until it awaits something that
+ *   moves it, such as Executor::schedule(); the awaiter then continues on
+ *   whatever thread the task finished on
+ * - Exceptions thrown by the body are rethrown from co_await
+ *
+ *   Task<size_t> count(Executor& executor) { co_await executor.schedule(); co_return 42; }
+ *   size_t n = syncWait(count(executor));
+ *
+ * Move-only; a Task is awaited at most once.
+ */
+template <typename T>
+class Task {
+public:
+    using promise_type = task_detail::Promise<T>;
+
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if (handle) handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return !handle || handle.done(); }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+
+    T await_resume() { return handle.promise().take(); }
+
+private:
+    friend promise_type;
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+namespace task_detail {
+
+template <typename T>
+Task<T> Promise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+/**
+ * Frame that runs one awaitable from plain code and reports when it is done
+ * Used to start tasks from syncWait() and whenAll(). The report happens
+ * after the frame has suspended for the last time, so the callback (or
+ * another thread it wakes) may destroy the frame straight away.
+ */
+struct Starter {
+    struct promise_type;
+
+    struct DoneAwaiter {
+        bool await_ready() const noexcept { return false; }
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+            promise_type& promise = handle.promise();
+            return promise.onDone(promise.context);
+        }
+        void await_resume() const noexcept {}
+    };
+
+    struct promise_type {
+        // Returns the coroutine to continue with (noop_coroutine() for none)
+        std::coroutine_handle<> (*onDone)(void*) = nullptr;
+        void* context = nullptr;
+
+        Starter get_return_object() noexcept {
+            return Starter{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        DoneAwaiter final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }  // Bodies below catch everything
+    };
+
+    void start(std::coroutine_handle<> (*onDone)(void*), void* context) {
+        handle.promise().onDone = onDone;
+        handle.promise().context = context;
+        handle.resume();
+    }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+template <typename T>
+Starter runCapturing(Task<T>& task, std::optional<T>& result, std::exception_ptr& error) {
+    try {
+        result.emplace(co_await task);
+    } catch (...) {
+        error = std::current_exception();
+    }
+}
+
+inline Starter runCapturing(Task<void>& task, std::exception_ptr& error) {
+    try {
+        co_await task;
+    } catch (...) {
+        error = std::current_exception();
+    }
+}
+
+inline std::coroutine_handle<> countDown(void* latch) {
+    static_cast<std::latch*>(latch)->count_down();
+    return std::noop_coroutine();
+}
+
+/**
+ * State shared by the members of one whenAll()
+ */
+struct WhenAllState {
+    std::atomic<size_t> remaining{0};
+    std::coroutine_handle<> continuation;
+    std::vector<std::exception_ptr> errors;  // One slot per member, so no locking
+
+    // The last member to finish continues the awaiting coroutine
+    static std::coroutine_handle<> memberDone(void* self) {
+        WhenAllState& state = *static_cast<WhenAllState*>(self);
+        if (state.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            return state.continuation;
+        }
+        return std::noop_coroutine();
+    }
+};
+
+/**
+ * Awaiter that starts every member and resumes once all of them finished
+ */
+struct WhenAllAwaiter {
+    std::vector<Task<void>>& tasks;
+    WhenAllState& state;
+    std::vector<Starter>& members;
+
+    bool await_ready() const noexcept { return tasks.empty(); }
+
+    bool await_suspend(std::coroutine_handle<> awaiting) {
+        state.continuation = awaiting;
+        state.errors.resize(tasks.size());
+        // One extra count held while starting, so an early finisher cannot resume us mid-loop
+        state.remaining.store(tasks.size() + 1, std::memory_order_relaxed);
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            members.push_back(runCapturing(tasks[i], state.errors[i]));
+        }
+        for (auto& member : members) {
+            member.start(&WhenAllState::memberDone, &state);
+        }
+        // Members that all finished synchronously leave nothing to wait for
+        return state.remaining.fetch_sub(1, std::memory_order_acq_rel) != 1;
+    }
+
+    void await_resume() const noexcept {}
+};
+
+} // namespace task_detail
+
+/**
+ * Run a task from plain code and block until it finishes
+ * @param task Task to run; it starts on the calling thread
+ * @return The task's result (exceptions are rethrown here)
+ */
+template <typename T>
+T syncWait(Task<T> task) {
+    std::optional<T> result;
+    std::exception_ptr error;
+    std::latch done(1);
+    task_detail::Starter starter = task_detail::runCapturing(task, result, error);
+    starter.start(&task_detail::countDown, &done);
+    done.wait();
+    starter.handle.destroy();
+    if (error) std::rethrow_exception(error);
+    return std::move(*result);
+}
+
+inline void syncWait(Task<void> task) {
+    std::exception_ptr error;
+    std::latch done(1);
+    task_detail::Starter starter = task_detail::runCapturing(task, error);
+    starter.start(&task_detail::countDown, &done);
+    done.wait();
+    starter.handle.destroy();
+    if (error) std::rethrow_exception(error);
+}
+
+/**
+ * Run tasks concurrently and finish when all of them have
+ * Every task starts on the awaiting thread and runs up to its first
+ * suspension, so tasks that begin with co_await executor.schedule() fan out
+ * over the executor. The awaiting coroutine continues on the thread of the
+ * task that finished last. The first failed task's exception (by position)
+ * is rethrown once all are done.
+ */
+inline Task<void> whenAll(std::vector<Task<void>> tasks) {
+    task_detail::WhenAllState state;
+    std::vector<task_detail::Starter> members;
+    members.reserve(tasks.size());
+    co_await task_detail::WhenAllAwaiter{tasks, state, members};
+    for (auto& member : members) {
+        member.handle.destroy();
+    }
+    for (auto& error : state.errors) {
+        if (error) std::rethrow_exception(error);
+    }
+}
+
+#endif // TASK_HPP
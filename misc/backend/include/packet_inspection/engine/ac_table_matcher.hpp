@@ -0,0 +1,156 @@
+#ifndef AC_TABLE_MATCHER_HPP
+#define AC_TABLE_MATCHER_HPP
+
+#include "packet_inspection/engine/matcher.hpp"
+#include "packet_inspection/simd/simd_kernels.hpp"
+#include "packet_inspection/mem/huge_page_buffer.hpp"
+
+/**
+ * AcTableMatcher: Aho-Corasick compiled to a flat, pointer-free DFA
+ * - Alphabet compression: case-folded bytes that occur in patterns get their
+ *   own class, everything else shares class 0, so rows are a few dozen words
+ * - Fail links are resolved at build time: one table load per input byte
+ * - Targets are stored premultiplied by the row stride, with the top bit set
+ *   when the target state has outputs, so the hot loop has no multiply and
+ *   touches the output lists only on a match; state count * stride must stay
+ *   below OUTPUT_FLAG, larger automata throw std::length_error on build
+ * - All tables live in one contiguous uint32_t image (layout below), so the
+ *   automaton can be copied or mapped as a single block
+ * - Images of 2 MB or more are placed on huge pages and pre-faulted (see
+ *   HugePageBuffer for the PKTINSPECT_HUGEPAGES / PKTINSPECT_PREFAULT knobs),
+ *   since random row accesses over a large table are mostly TLB misses
+ *
+ * Image layout (uint32_t words):
+ *   [0] IMAGE_MAGIC  [1] IMAGE_VERSION  [2] state count  [3] stride
+ *   [4] pattern count  [5] output id count
+ *   [HEADER_WORDS .. +64)      byte -> class map, 256 bytes packed
+ *   transitions                state count * stride
+ *   output offsets             state count + 1
+ *   output ids                 output id count
+ */
+class AcTableMatcher : public Matcher {
+public:
+    static constexpr uint32_t IMAGE_MAGIC = 0x31544341;  // "ACT1"
+    static constexpr uint32_t IMAGE_VERSION = 1;
+    static constexpr uint32_t HEADER_WORDS = 6;
+    static constexpr uint32_t OUTPUT_FLAG = 0x80000000u;
+
+    explicit AcTableMatcher(std::shared_ptr<const PatternSet> patterns);
+
+    /**
+     * Build with a specific page backing instead of the configured one
+     * @param patterns Pattern set
+     * @param backing Page size for the image
+     */
+    AcTableMatcher(std::shared_ptr<const PatternSet> patterns, PageBacking backing);
+
+    /**
+     * Use an image built elsewhere (e.g. mapped from shared memory) without copying
+     * @param patterns Pattern set the image was built from
+     * @param owner Keeps the image memory alive as long as the matcher
+     * @param words Image words
+     * @param wordCount Number of words
+     */
+    AcTableMatcher(std::shared_ptr<const PatternSet> patterns, std::shared_ptr<const void> owner,
+                   const uint32_t* words, size_t wordCount);
+
+    /**
+     * Check that an image is complete and consistent with its header
+     * @param words Image words
+     * @param wordCount Number of words
+     * @param patternCount Number of patterns the image must refer to
+     * @return true if the image can be scanned safely
+     */
+    static bool validateImage(const uint32_t* words, size_t wordCount, size_t patternCount);
+
+    /**
+     * Check if the engine suits a pattern set
+     * @param patterns Pattern set
+     * @return true if the premultiplied targets are sure to stay below OUTPUT_FLAG
+     */
+    static bool supports(const PatternSet& patterns);
+
+    const char* name() const override { return "ac-table"; }
+    void scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const override;
+    void scanSpans(const ByteSpan* spans, size_t count, std::vector<PatternHit>& hits) const override;
+
+    /**
+     * Run BATCH_LANES packets through the DFA in lockstep. Each packet's
+     * states form a chain of dependent table loads; stepping independent
+     * chains side by side lets those loads overlap. Between blocks of up to
+     * BATCH_BLOCK bytes the lanes at the root skip-scan and finished lanes
+     * take the next packet; the rows are put back in packet order at the end.
+     */
+    void scanBatch(const ByteSpan* packets, size_t count, BatchHits& out) const override;
+
+    static constexpr size_t BATCH_LANES = 4;
+    static constexpr size_t BATCH_BLOCK = 256;  // Most lockstep bytes between root skips
+
+    /**
+     * Resume a scan over the next piece of a stream whose bytes arrive in
+     * pieces (e.g. decoder output); a match may straddle the pieces
+     * @param base Stream offset of data, added to hit positions
+     * @param state State returned for the previous piece (0 to start)
+     * @param hits Receives the matches, appended
+     * @return State to pass with the next piece
+     */
+    uint32_t scanStream(const uint8_t* data, size_t length, size_t base, uint32_t state,
+                        std::vector<PatternHit>& hits) const;
+
+    size_t memoryUsage() const override { return imageWordCount * sizeof(uint32_t); }
+
+    uint32_t getStateCount() const { return stateCount; }
+    uint32_t getStride() const { return stride; }
+
+    /**
+     * Get the serialized automaton
+     * @return Contiguous image words (imageSize() of them)
+     */
+    const uint32_t* imageData() const { return imageWords; }
+    size_t imageSize() const { return imageWordCount; }
+
+    /**
+     * Get the page size the image actually sits on
+     * @return Page backing
+     */
+    PageBacking pageBacking() const { return hugeImage.data() ? hugeImage.backing() : PageBacking::Small; }
+
+    /**
+     * Get the image bytes currently backed by huge pages
+     * @return Huge page bytes
+     */
+    size_t hugePageBytes() const { return hugeImage.hugePageBytes(); }
+
+private:
+    std::vector<uint32_t> build();
+    void placeImage(std::vector<uint32_t>&& built, PageBacking backing, bool forceBuffer);
+    void bindImage();
+
+    /**
+     * Run the DFA over one chunk starting from a given state
+     * @param base Logical offset of the chunk, added to hit positions
+     * @param state Premultiplied state to start from (0 = root)
+     * @return State after the last byte
+     */
+    uint32_t scanChunk(const uint8_t* data, size_t length, size_t base, uint32_t state,
+                       std::vector<PatternHit>& hits) const;
+
+    std::vector<uint32_t> heapImage;  // Image storage for small tables
+    HugePageBuffer hugeImage;         // Image storage for large or explicitly placed tables
+    std::shared_ptr<const void> externalImage;  // Owner of an image mapped from elsewhere
+    const uint32_t* imageWords = nullptr;
+    size_t imageWordCount = 0;
+
+    // Views into the image
+    const uint8_t* classOf = nullptr;
+    const uint32_t* transitions = nullptr;
+    const uint32_t* outputStart = nullptr;
+    const uint32_t* outputIds = nullptr;
+    uint32_t stateCount = 0;
+    uint32_t stride = 0;
+
+    ByteSet startBytes;
+    bool rootSkip = false;
+};
+
+#endif // AC_TABLE_MATCHER_HPP
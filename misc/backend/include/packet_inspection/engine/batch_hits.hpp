@@ -0,0 +1,50 @@
+#ifndef BATCH_HITS_HPP
+#define BATCH_HITS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Matches of a batch of packets in columnar form (structure of arrays)
+ * Row i is pattern patternId[i] ending at offset[i] (last byte, like
+ * PatternHit::position) of packet packetIndex[i], an index into the
+ * caller's packet array. Rows are grouped by packet in ascending packet
+ * order; within a packet the order is engine specific. Scanning appends,
+ * and clear() keeps the capacity, so a reused BatchHits stops allocating.
+ */
+struct BatchHits {
+    std::vector<uint32_t> packetIndex;
+    std::vector<uint32_t> patternId;
+    std::vector<uint32_t> offset;
+
+    size_t size() const { return patternId.size(); }
+    bool empty() const { return patternId.empty(); }
+
+    void clear() {
+        packetIndex.clear();
+        patternId.clear();
+        offset.clear();
+    }
+
+    void push(uint32_t packet, uint32_t pattern, uint32_t position) {
+        packetIndex.push_back(packet);
+        patternId.push_back(pattern);
+        offset.push_back(position);
+    }
+
+    /**
+     * Find the end of one packet's rows
+     * @param row First row of the packet
+     * @return One past its last row
+     */
+    size_t packetEnd(size_t row) const {
+        size_t end = row;
+        while (end < packetIndex.size() && packetIndex[end] == packetIndex[row]) {
+            ++end;
+        }
+        return end;
+    }
+};
+
+#endif // BATCH_HITS_HPP
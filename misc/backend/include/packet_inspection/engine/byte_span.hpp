@@ -0,0 +1,17 @@
+#ifndef BYTE_SPAN_HPP
+#define BYTE_SPAN_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * One piece of a scattered payload (like struct iovec)
+ * A sequence of spans is scanned as one logical buffer: match positions are
+ * offsets into the concatenation, which is never built.
+ */
+struct ByteSpan {
+    const uint8_t* data;
+    size_t length;
+};
+
+#endif // BYTE_SPAN_HPP
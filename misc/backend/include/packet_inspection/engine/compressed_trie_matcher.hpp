@@ -0,0 +1,76 @@
+#ifndef COMPRESSED_TRIE_MATCHER_HPP
+#define COMPRESSED_TRIE_MATCHER_HPP
+
+#include "packet_inspection/engine/matcher.hpp"
+#include "packet_inspection/simd/simd_kernels.hpp"
+
+/**
+ * CompressedTrieMatcher: Aho-Corasick with path-compressed edges
+ * - Chains of trie nodes with one child and no output (own or inherited via
+ *   fail links) are collapsed into edge labels; only branching and output
+ *   nodes remain explicit
+ * - A state is either an explicit node or a position inside an edge label;
+ *   every label position keeps the fail target of the node it replaced, so
+ *   fail-link semantics are exactly those of the uncompressed trie
+ * - Inside a label, input is compared 8 bytes at a time (SWAR case fold and
+ *   xor) instead of one transition per byte
+ * - Per replaced node the cost is 5 bytes (label byte and fail target)
+ *   instead of a heap-allocated node
+ * - A label state keeps the edge id in 23 bits, so a build that needs
+ *   MAX_EDGES edges or more throws std::length_error
+ */
+class CompressedTrieMatcher : public Matcher {
+public:
+    static constexpr uint32_t MAX_RUN_OFFSET = 255;  // Label positions per edge before a forced explicit node
+    static constexpr uint32_t MAX_EDGES = 1u << 23;   // Edge ids that fit a label state
+
+    explicit CompressedTrieMatcher(std::shared_ptr<const PatternSet> patterns);
+
+    const char* name() const override { return "ac-compressed"; }
+    void scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const override;
+    size_t memoryUsage() const override;
+
+    /**
+     * Check if the engine suits a pattern set
+     * @param patterns Pattern set
+     * @return true if the set is sure to need fewer than MAX_EDGES edges
+     */
+    static bool supports(const PatternSet& patterns);
+
+    size_t getNodeCount() const { return nodes.size(); }
+    size_t getUncompressedNodeCount() const { return uncompressedNodes; }
+
+private:
+    struct Node {
+        uint32_t fail;         // Encoded state
+        uint32_t edgeBegin;
+        uint32_t edgeEnd;
+        uint32_t outputBegin;  // Range in outputIds, own and inherited outputs
+        uint32_t outputEnd;
+    };
+
+    struct Edge {
+        uint32_t labelStart;   // Index into labels and failAt
+        uint32_t labelLength;
+        uint32_t target;       // Explicit node reached after the whole label
+    };
+
+    // State encoding: explicit node id << 1, or ((edge << 8 | offset) << 1) | 1
+    static uint32_t explicitState(uint32_t node) { return node << 1; }
+    static uint32_t labelState(uint32_t edge, uint32_t offset) { return (((edge << 8) | offset) << 1) | 1; }
+
+    void build();
+    uint32_t findEdge(uint32_t node, uint8_t byte) const;
+
+    std::vector<Node> nodes;
+    std::vector<Edge> edges;
+    std::vector<uint8_t> edgeFirst;    // First label byte per edge, for the child search
+    std::vector<uint8_t> labels;       // Folded label bytes, padded for 8-byte loads
+    std::vector<uint32_t> failAt;      // Fail target of each label position
+    std::vector<uint32_t> outputIds;
+    uint32_t rootEdge[256];            // Root child by folded byte (UINT32_MAX if none)
+    ByteSet startBytes;
+    size_t uncompressedNodes = 0;
+};
+
+#endif // COMPRESSED_TRIE_MATCHER_HPP
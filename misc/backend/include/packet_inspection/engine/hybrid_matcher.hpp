@@ -0,0 +1,40 @@
+#ifndef HYBRID_MATCHER_HPP
+#define HYBRID_MATCHER_HPP
+
+#include "packet_inspection/engine/matcher.hpp"
+
+/**
+ * HybridMatcher: Splits a pattern set by length
+ * - Patterns of RabinKarpMatcher::WINDOW bytes or more go to the rolling-hash
+ *   stage, so the long secrets never become deep trie chains
+ * - The rest go to an AcTableMatcher
+ * - Hits of both stages are mapped back to the ids of the full set
+ */
+class HybridMatcher : public Matcher {
+public:
+    explicit HybridMatcher(std::shared_ptr<const PatternSet> patterns);
+
+    const char* name() const override { return "hybrid"; }
+    void scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const override;
+    size_t memoryUsage() const override;
+
+    /**
+     * Check if the engine suits a pattern set
+     * @param patterns Pattern set
+     * @return true if the set mixes long and short patterns
+     */
+    static bool supports(const PatternSet& patterns);
+
+private:
+    struct Stage {
+        std::unique_ptr<Matcher> matcher;
+        std::vector<uint32_t> originalId;  // Stage pattern id -> id in the full set
+    };
+
+    void scanStage(const Stage& stage, const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const;
+
+    Stage shortStage;
+    Stage longStage;
+};
+
+#endif // HYBRID_MATCHER_HPP
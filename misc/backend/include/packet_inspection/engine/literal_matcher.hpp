@@ -0,0 +1,41 @@
+#ifndef LITERAL_MATCHER_HPP
+#define LITERAL_MATCHER_HPP
+
+#include "packet_inspection/engine/matcher.hpp"
+#include "packet_inspection/simd/simd_kernels.hpp"
+
+/**
+ * LiteralMatcher: One memchr-style pass per pattern, for 1-3 patterns
+ * - Each pattern is anchored on its rarest byte (both cases), found with the
+ *   SIMD findFirstOf kernel, then the surrounding window is verified
+ * - Cost grows linearly with the pattern count, so the selector only offers
+ *   it for very small sets
+ */
+class LiteralMatcher : public Matcher {
+public:
+    static constexpr size_t MAX_PATTERNS = 3;
+
+    explicit LiteralMatcher(std::shared_ptr<const PatternSet> patterns);
+
+    const char* name() const override { return "literal"; }
+    void scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const override;
+    size_t memoryUsage() const override { return literals.size() * sizeof(Literal); }
+
+    /**
+     * Check if the engine suits a pattern set
+     * @param patterns Pattern set
+     * @return true for 1-3 patterns
+     */
+    static bool supports(const PatternSet& patterns);
+
+private:
+    struct Literal {
+        uint32_t patternId;
+        uint32_t anchorOffset;  // Offset of the anchor byte inside the pattern
+        ByteSet anchor;
+    };
+
+    std::vector<Literal> literals;
+};
+
+#endif // LITERAL_MATCHER_HPP
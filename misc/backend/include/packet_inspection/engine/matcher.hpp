@@ -0,0 +1,125 @@
+#ifndef MATCHER_HPP
+#define MATCHER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "packet_inspection/engine/pattern_hit.hpp"
+#include "packet_inspection/engine/byte_span.hpp"
+#include "packet_inspection/engine/batch_hits.hpp"
+
+/**
+ * PatternSet: Compiled pattern table shared by all matcher engines
+ * - Pattern ids are indices into the list given to the constructor
+ * - Matching is ASCII case-insensitive, like AhoCorasick
+ * - Empty patterns are kept for id stability but never match
+ */
+class PatternSet {
+public:
+    explicit PatternSet(const std::vector<std::string>& patterns);
+
+    size_t size() const { return patterns.size(); }
+
+    /**
+     * Get a pattern as given
+     * @param id Pattern id
+     * @return Original pattern text
+     */
+    const std::string& pattern(uint32_t id) const { return patterns[id]; }
+
+    /**
+     * Get a pattern lowercased (A-Z only)
+     * @param id Pattern id
+     * @return Case-folded pattern
+     */
+    const std::string& folded(uint32_t id) const { return foldedPatterns[id]; }
+
+    /**
+     * Get the lowest id with the same text, for per-pattern dedup
+     * @param id Pattern id
+     * @return Canonical id
+     */
+    uint32_t canonicalId(uint32_t id) const { return canonical[id]; }
+
+    const std::vector<std::string>& all() const { return patterns; }
+    size_t minLength() const { return minLen; }
+    size_t maxLength() const { return maxLen; }
+    size_t totalLength() const { return totalLen; }
+
+    /**
+     * ASCII case fold of one byte
+     */
+    static uint8_t fold(uint8_t byte) {
+        return static_cast<uint8_t>(byte - 'A') < 26 ? static_cast<uint8_t>(byte | 0x20) : byte;
+    }
+
+private:
+    std::vector<std::string> patterns;
+    std::vector<std::string> foldedPatterns;
+    std::vector<uint32_t> canonical;
+    size_t minLen = 0;
+    size_t maxLen = 0;
+    size_t totalLen = 0;
+};
+
+/**
+ * Matcher: Common interface of the multi-pattern engines
+ * Engines are immutable after construction, so one instance can be shared
+ * by any number of scanning threads.
+ */
+class Matcher {
+public:
+    explicit Matcher(std::shared_ptr<const PatternSet> patterns) : patterns(std::move(patterns)) {}
+    virtual ~Matcher() = default;
+
+    /**
+     * Engine name as used by MatcherSelector and PKTINSPECT_ENGINE
+     */
+    virtual const char* name() const = 0;
+
+    /**
+     * Scan bytes and append every (pattern, end position) match
+     * Order of the appended hits is engine specific
+     * @param data Bytes to scan
+     * @param length Number of bytes
+     * @param hits Output vector, matches are appended
+     */
+    virtual void scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const = 0;
+
+    /**
+     * Scan scattered spans as one logical buffer
+     * Positions are offsets into the concatenation of the spans. The default
+     * scans each span in place and rescans only the bytes around each span
+     * boundary (at most 2 x (longest pattern - 1)) for matches crossing it;
+     * automaton engines override it to carry their state across spans instead
+     * @param spans Spans in logical order
+     * @param count Number of spans
+     * @param hits Output vector, matches are appended
+     */
+    virtual void scanSpans(const ByteSpan* spans, size_t count, std::vector<PatternHit>& hits) const;
+
+    /**
+     * Scan many packets in one call
+     * Per-call work (tracing, setup) is paid once per batch, and engines may
+     * interleave packets internally; the rows still come out grouped by
+     * packet in ascending order. The default scans the packets one by one
+     * @param packets One contiguous buffer per packet
+     * @param count Number of packets
+     * @param out Output columns, rows are appended
+     */
+    virtual void scanBatch(const ByteSpan* packets, size_t count, BatchHits& out) const;
+
+    /**
+     * Approximate heap bytes held by the engine (pattern table excluded)
+     */
+    virtual size_t memoryUsage() const = 0;
+
+    const PatternSet& patternSet() const { return *patterns; }
+    std::shared_ptr<const PatternSet> sharedPatternSet() const { return patterns; }
+
+protected:
+    std::shared_ptr<const PatternSet> patterns;
+};
+
+#endif // MATCHER_HPP
@@ -0,0 +1,70 @@
+#ifndef MATCHER_SELECTOR_HPP
+#define MATCHER_SELECTOR_HPP
+
+#include "packet_inspection/engine/matcher.hpp"
+#include <string>
+#include <vector>
+#include <memory>
+
+/**
+ * Registry entry for one matcher engine
+ */
+struct EngineInfo {
+    const char* name;
+    bool (*supports)(const PatternSet& patterns);
+    std::unique_ptr<Matcher> (*create)(std::shared_ptr<const PatternSet> patterns);
+};
+
+/**
+ * Calibration result for one candidate engine
+ */
+struct EngineTiming {
+    std::string name;
+    double nsPerByte;
+    size_t memoryBytes;
+};
+
+/**
+ * MatcherSelector: Picks the fastest engine for a pattern set
+ * - Every registered engine that supports the set is built and timed on a
+ *   calibration sample (best of a few passes), the fastest one is kept
+ * - PKTINSPECT_ENGINE=<name> skips calibration and forces an engine
+ */
+class MatcherSelector {
+public:
+    /**
+     * Get all registered engines, in preference order for ties
+     * @return Engine registry
+     */
+    static const std::vector<EngineInfo>& engines();
+
+    /**
+     * Build a specific engine
+     * @param name Engine name
+     * @param patterns Pattern set
+     * @return Engine, or nullptr if unknown or not suited to the set
+     */
+    static std::unique_ptr<Matcher> create(const std::string& name, std::shared_ptr<const PatternSet> patterns);
+
+    /**
+     * Build all candidates and keep the fastest on the sample
+     * @param patterns Pattern set
+     * @param sample Calibration payloads
+     * @param timings Optional output of per-candidate results
+     * @return Selected engine (never nullptr, ac-trie supports every set)
+     */
+    static std::unique_ptr<Matcher> select(std::shared_ptr<const PatternSet> patterns,
+                                           const std::vector<std::string>& sample,
+                                           std::vector<EngineTiming>* timings = nullptr);
+
+    /**
+     * Generate a calibration sample with the traffic generator
+     * Attack payloads embed the set's own patterns so verification paths are exercised
+     * @param patterns Pattern set
+     * @param packetCount Number of payloads
+     * @return Payloads
+     */
+    static std::vector<std::string> calibrationSample(const PatternSet& patterns, size_t packetCount = 256);
+};
+
+#endif // MATCHER_SELECTOR_HPP
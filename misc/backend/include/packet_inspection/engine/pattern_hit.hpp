@@ -0,0 +1,14 @@
+#ifndef PATTERN_HIT_HPP
+#define PATTERN_HIT_HPP
+
+#include <cstdint>
+
+/**
+ * Compact match record: pattern index instead of a pattern copy
+ */
+struct PatternHit {
+    uint32_t patternId;  // Index into the pattern list the engine was built from
+    uint32_t position;   // Position of the last byte of the match
+};
+
+#endif // PATTERN_HIT_HPP
@@ -0,0 +1,45 @@
+#ifndef PREFILTER_MATCHER_HPP
+#define PREFILTER_MATCHER_HPP
+
+#include "packet_inspection/engine/matcher.hpp"
+#include "packet_inspection/simd/simd_kernels.hpp"
+
+/**
+ * PrefilterMatcher: SIMD start-byte skip plus bigram filter, for tens of patterns
+ * - findFirstOf jumps to the next byte that starts any pattern
+ * - A 64K-bit table of folded pattern prefixes rejects most candidates
+ * - Survivors are verified against the patterns bucketed by their prefix
+ * - Degrades when the start bytes are common in the traffic; the selector
+ *   measures that on the calibration sample
+ */
+class PrefilterMatcher : public Matcher {
+public:
+    static constexpr size_t MAX_PATTERNS = 256;
+
+    explicit PrefilterMatcher(std::shared_ptr<const PatternSet> patterns);
+
+    const char* name() const override { return "prefilter"; }
+    void scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const override;
+    size_t memoryUsage() const override;
+
+    /**
+     * Check if the engine suits a pattern set
+     * @param patterns Pattern set
+     * @return true for up to MAX_PATTERNS patterns
+     */
+    static bool supports(const PatternSet& patterns);
+
+private:
+    static constexpr uint32_t BUCKET_BITS = 10;
+
+    static uint32_t bucketOf(uint32_t bigram) { return (bigram * 0x9E3779B1u) >> (32 - BUCKET_BITS); }
+
+    ByteSet startBytes;
+    std::vector<uint64_t> bigramBits;       // 65536 bits indexed by (fold(b0) << 8) | fold(b1)
+    std::vector<uint32_t> bucketStart;      // CSR offsets into bucketIds, by bucketOf(bigram)
+    std::vector<uint32_t> bucketIds;        // Pattern ids of length >= 2
+    std::vector<uint32_t> singleStart;      // CSR offsets into singleIds, by folded byte
+    std::vector<uint32_t> singleIds;        // Pattern ids of length 1
+};
+
+#endif // PREFILTER_MATCHER_HPP
@@ -0,0 +1,52 @@
+#ifndef RABIN_KARP_MATCHER_HPP
+#define RABIN_KARP_MATCHER_HPP
+
+#include "packet_inspection/engine/matcher.hpp"
+
+/**
+ * RabinKarpMatcher: Rolling-hash stage for very long patterns (32+ bytes)
+ * - Every pattern is keyed by the hash of its first WINDOW case-folded bytes
+ * - Input is hashed with one rolling update per byte; each window hash is
+ *   tested against a blocked Bloom filter (all probe bits in one cache line)
+ * - Only Bloom hits look up the exact hash table and verify the pattern
+ * - The input is split into LANES segments rolled in lockstep, so the
+ *   multiply chains and Bloom loads of independent windows overlap
+ * - Memory depends on the pattern count only: Bloom bits plus one
+ *   (hash, id) pair per pattern
+ */
+class RabinKarpMatcher : public Matcher {
+public:
+    static constexpr size_t WINDOW = 32;
+    static constexpr size_t LANES = 4;
+    static constexpr size_t BLOOM_BITS_PER_PATTERN = 16;
+
+    explicit RabinKarpMatcher(std::shared_ptr<const PatternSet> patterns);
+
+    const char* name() const override { return "rabin-karp"; }
+    void scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const override;
+    size_t memoryUsage() const override;
+
+    /**
+     * Check if the engine suits a pattern set
+     * @param patterns Pattern set
+     * @return true if every pattern is at least WINDOW bytes
+     */
+    static bool supports(const PatternSet& patterns);
+
+private:
+    struct Block {
+        alignas(64) uint64_t words[8];
+    };
+
+    bool bloomMayContain(uint32_t hash) const;
+    void bloomAdd(uint32_t hash);
+    void verify(uint32_t hash, const uint8_t* data, size_t length, size_t start,
+                std::vector<PatternHit>& hits) const;
+
+    std::vector<Block> bloom;
+    uint32_t blockShift = 64;                       // 64 - log2(block count)
+    std::vector<std::pair<uint32_t, uint32_t>> keys; // (window hash, pattern id), sorted
+    uint32_t outFactor = 1;                          // BASE^WINDOW, removes the outgoing byte
+};
+
+#endif // RABIN_KARP_MATCHER_HPP
@@ -0,0 +1,90 @@
+#ifndef SCAN_ARENA_HPP
+#define SCAN_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "packet_inspection/engine/matcher.hpp"
+#include "packet_inspection/engine/pattern_hit.hpp"
+
+/**
+ * Matches of one packet inside a ScanArena
+ */
+struct PacketMatches {
+    uint64_t sequence = 0;             // Capture order
+    uint32_t packetId = 0;
+    const uint8_t* payload = nullptr;  // Not owned: must outlive the arena's use of it
+    uint32_t payloadLength = 0;
+    uint32_t firstMatch = 0;           // Index of the packet's first match in ScanArena::matchAt()
+    uint32_t matchCount = 0;
+};
+
+/**
+ * ScanArena: Reusable store for the results of a bulk scan
+ * - Packets reference their payload where it already lives (a capture
+ *   buffer) and patterns by id in the shared PatternSet; nothing is copied
+ *   per packet beyond two small records and the match ids
+ * - All packets' matches share one array, so a packet costs no allocation
+ *   of its own; clear() keeps the capacity, and once an arena has seen a
+ *   capture of a given size, scanning another costs no allocations at all
+ *
+ * Matches are kept in AhoCorasick::scan() form: the first match of each
+ * pattern text, ordered by position with longer patterns first.
+ */
+class ScanArena {
+public:
+    ScanArena() = default;
+
+    /**
+     * Empty the arena for a new scan, keeping its buffers
+     * @param patterns Pattern table the next packets' hits refer to
+     */
+    void reset(std::shared_ptr<const PatternSet> patterns);
+
+    /**
+     * Add a packet with the raw hits of an engine scan
+     * @param sequence Capture order
+     * @param packetId Packet id
+     * @param payload Scanned bytes (referenced, not copied)
+     * @param payloadLength Number of bytes
+     * @param hits Engine hits, any order, duplicates allowed
+     * @param hitCount Number of hits
+     */
+    void add(uint64_t sequence, uint32_t packetId, const uint8_t* payload, uint32_t payloadLength,
+             const PatternHit* hits, size_t hitCount);
+
+    /**
+     * Sort the packets by sequence (capture order)
+     */
+    void sortBySequence();
+
+    size_t size() const { return packets.size(); }
+    const PacketMatches& packetAt(size_t index) const { return packets[index]; }
+    const PatternHit& matchAt(size_t index) const { return matches[index]; }
+    size_t matchCount() const { return matches.size(); }
+
+    /**
+     * Append one packet as a /scan-pcap result object
+     * {"matches":[{"pattern","position"}...],"packetId","payloadAscii","payloadHex"},
+     * byte for byte what nlohmann::json would print for it
+     * @param out Output buffer, appended to
+     * @param packet Packet of this arena
+     */
+    void appendJson(std::string& out, const PacketMatches& packet) const;
+
+    /**
+     * Heap bytes held by the arena's buffers
+     */
+    size_t memoryUsage() const;
+
+private:
+    std::shared_ptr<const PatternSet> patterns;
+    std::vector<PacketMatches> packets;
+    std::vector<PatternHit> matches;
+    std::vector<uint32_t> seenStamps;  // Per canonical pattern id: generation of the last add() that kept it
+    uint32_t generation = 0;
+};
+
+#endif // SCAN_ARENA_HPP
@@ -0,0 +1,54 @@
+#ifndef SHIFT_OR_MATCHER_HPP
+#define SHIFT_OR_MATCHER_HPP
+
+#include "packet_inspection/engine/matcher.hpp"
+
+/**
+ * ShiftOrMatcher: Bit-parallel Shift-Or (bitap) over all patterns at once
+ * - Patterns are packed into 64-bit lanes, one bit per pattern byte; a pattern
+ *   never straddles two lanes, so lanes shift independently without carries
+ * - Per input byte: one table row load, then shift / and-not / or per lane,
+ *   with no memory-dependent branches (the match test is a rarely taken jump)
+ * - Masks are case-insensitive: both cases of a letter clear the same bit
+ * - The lane loop is instantiated for 1, 2, 4 and 8 lanes so it is fully
+ *   unrolled and the compiler can keep the state in vector registers
+ */
+class ShiftOrMatcher : public Matcher {
+public:
+    static constexpr size_t MAX_LANES = 8;
+
+    explicit ShiftOrMatcher(std::shared_ptr<const PatternSet> patterns);
+
+    const char* name() const override { return "shift-or"; }
+    void scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const override;
+    size_t memoryUsage() const override;
+
+    /**
+     * Check if the engine suits a pattern set
+     * @param patterns Pattern set
+     * @return true if every pattern is at most 64 bytes and all fit in MAX_LANES lanes
+     */
+    static bool supports(const PatternSet& patterns);
+
+    size_t getLaneCount() const { return lanes; }
+
+private:
+    /**
+     * Pack patterns into lanes (first fit, in id order)
+     * @return Lane count, or 0 if the set does not fit
+     */
+    static size_t packLanes(const PatternSet& patterns, std::vector<uint32_t>* laneOf, std::vector<uint32_t>* bitOf);
+
+    template <size_t Lanes>
+    void scanLanes(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const;
+
+    void reportLane(size_t lane, uint64_t matched, size_t pos, std::vector<PatternHit>& hits) const;
+
+    size_t lanes = 0;                   // Rounded up to 1, 2, 4 or 8
+    std::vector<uint64_t> masks;        // 256 rows of `lanes` words; 0 bit = byte matches there
+    std::vector<uint64_t> startMask;    // Per lane: first bit of each pattern
+    std::vector<uint64_t> finalMask;    // Per lane: last bit of each pattern
+    std::vector<uint32_t> patternAtBit; // lane * 64 + final bit -> pattern id
+};
+
+#endif // SHIFT_OR_MATCHER_HPP
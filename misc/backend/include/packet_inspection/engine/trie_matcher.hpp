@@ -0,0 +1,26 @@
+#ifndef TRIE_MATCHER_HPP
+#define TRIE_MATCHER_HPP
+
+#include "packet_inspection/engine/matcher.hpp"
+#include "packet_inspection/ac/aho_corasick.hpp"
+
+/**
+ * TrieMatcher: Adapter exposing the pointer-based AhoCorasick as a Matcher
+ * Kept as the reference engine and as a fallback candidate for the selector.
+ */
+class TrieMatcher : public Matcher {
+public:
+    explicit TrieMatcher(std::shared_ptr<const PatternSet> patterns);
+
+    const char* name() const override { return "ac-trie"; }
+    void scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const override;
+    void scanSpans(const ByteSpan* spans, size_t count, std::vector<PatternHit>& hits) const override;
+    size_t memoryUsage() const override;
+
+    const AhoCorasick& automaton() const { return ac; }
+
+private:
+    AhoCorasick ac;
+};
+
+#endif // TRIE_MATCHER_HPP
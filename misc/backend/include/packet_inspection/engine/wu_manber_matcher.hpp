@@ -0,0 +1,54 @@
+#ifndef WU_MANBER_MATCHER_HPP
+#define WU_MANBER_MATCHER_HPP
+
+#include "packet_inspection/engine/matcher.hpp"
+
+/**
+ * WuManberMatcher: Block-hash shift engine for sets of long literals
+ * - Looks at the last 3 bytes (q-gram) of an m-byte window, m = shortest
+ *   pattern; the SHIFT table says how far the window can jump when that
+ *   q-gram does not end any pattern prefix, up to m - 2 bytes at a time
+ * - Windows with shift 0 are checked against the patterns whose m-prefix
+ *   ends with that q-gram, first by a 2-byte prefix tag, then in full
+ * - q-grams are case-folded with SWAR arithmetic on one 32-bit load instead
+ *   of per-byte table lookups
+ * - Memory is independent of pattern length (one byte per hash bucket plus
+ *   the bucket lists), unlike the trie engines
+ */
+class WuManberMatcher : public Matcher {
+public:
+    static constexpr size_t BLOCK = 3;
+    static constexpr size_t MIN_PATTERN_LENGTH = 4;
+    static constexpr uint32_t HASH_BITS = 15;
+
+    explicit WuManberMatcher(std::shared_ptr<const PatternSet> patterns);
+
+    const char* name() const override { return "wu-manber"; }
+    void scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const override;
+    size_t memoryUsage() const override;
+
+    /**
+     * Check if the engine suits a pattern set
+     * @param patterns Pattern set
+     * @return true if the shortest pattern is at least MIN_PATTERN_LENGTH bytes
+     */
+    static bool supports(const PatternSet& patterns);
+
+private:
+    /**
+     * Hash of the case-folded q-gram ending at data[pos] (pos >= 3)
+     */
+    static uint32_t hashAt(const uint8_t* data, size_t pos);
+
+    static uint16_t prefixTag(const uint8_t* bytes) {
+        return static_cast<uint16_t>(PatternSet::fold(bytes[0]) | (PatternSet::fold(bytes[1]) << 8));
+    }
+
+    size_t window = 0;                 // m: length of the shortest pattern
+    std::vector<uint8_t> shift;        // By q-gram hash
+    std::vector<uint32_t> bucketStart; // CSR offsets into bucketIds, by hash of the m-prefix's last q-gram
+    std::vector<uint32_t> bucketIds;
+    std::vector<uint16_t> bucketTags;  // Folded first two bytes, parallel to bucketIds
+};
+
+#endif // WU_MANBER_MATCHER_HPP
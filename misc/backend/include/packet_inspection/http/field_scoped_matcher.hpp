@@ -0,0 +1,125 @@
+#ifndef FIELD_SCOPED_MATCHER_HPP
+#define FIELD_SCOPED_MATCHER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "packet_inspection/engine/ac_table_matcher.hpp"
+#include "packet_inspection/http/http_spans.hpp"
+
+/**
+ * Part of a payload a pattern applies to
+ */
+struct FieldTarget {
+    enum class Kind : uint8_t {
+        Payload,  // Anywhere (the default)
+        Field,    // One HTTP field; HeaderValue means any header's value
+        Header    // The value of one named header
+    };
+
+    Kind kind = Kind::Payload;
+    HttpField field = HttpField::Body;  // Kind::Field
+    std::string header;                 // Kind::Header, lowercased
+
+    /**
+     * Parse a target: "payload" or empty, a field name as httpFieldName()
+     * gives it ("method", "uri", "headerValue"...), "header" for any header
+     * value, or "header:<name>" for the value of one header
+     * @param text Target text
+     * @param target Receives the target
+     * @return false if the text names no target
+     */
+    static bool parse(const std::string& text, FieldTarget& target);
+
+    bool scoped() const { return kind != Kind::Payload; }
+
+    /**
+     * Check if a match in a field can count for this target (header names are not checked)
+     */
+    bool admits(HttpField candidate) const;
+};
+
+/**
+ * Match of a field-scoped pattern
+ */
+struct FieldHit {
+    HttpField field;
+    uint32_t patternId;  // Into the full pattern list
+    uint32_t position;   // Last byte of the match in the scanned buffer
+};
+
+/**
+ * FieldScopedMatcher: Scans each HTTP field only for the patterns aimed at it
+ * - Patterns are grouped by target, and each group gets its own ac-table
+ *   sub-automaton (URI patterns, body patterns, "header:user-agent"...)
+ * - A buffer is parsed into field spans (HttpSpanCollector) and each span
+ *   is scanned in place against its group's automaton only. The state
+ *   carries across the spans of one field, so a match across a chunk
+ *   boundary of a chunked body is found
+ * - Payload-wide patterns are left out: scan those with a Matcher as before
+ */
+class FieldScopedMatcher {
+public:
+    /**
+     * Build the sub-automata
+     * @param patterns Full pattern list; hit ids index into it
+     * @param targets Target of each pattern (same order)
+     */
+    FieldScopedMatcher(std::shared_ptr<const PatternSet> patterns, const std::vector<FieldTarget>& targets);
+
+    /**
+     * Get the number of field-scoped patterns
+     */
+    size_t scopedCount() const { return scoped; }
+
+    /**
+     * Parse a buffer as HTTP and scan its fields
+     * @param data Bytes
+     * @param length Number of bytes
+     * @param hits Receives the matches, appended in span order
+     * @return false if the buffer is not HTTP (nothing is scanned)
+     */
+    bool scan(const uint8_t* data, size_t length, std::vector<FieldHit>& hits) const;
+
+    /**
+     * Scan fields already located in a buffer
+     * @param data Buffer the spans refer to
+     * @param spans Spans, as HttpSpanCollector records them
+     * @param count Number of spans
+     * @param hits Receives the matches, appended in span order
+     */
+    void scanSpans(const uint8_t* data, const HttpSpan* spans, size_t count, std::vector<FieldHit>& hits) const;
+
+    const PatternSet& patternSet() const { return *patterns; }
+
+private:
+    /**
+     * Sub-automaton over the patterns of one target
+     */
+    struct Scope {
+        std::shared_ptr<const AcTableMatcher> table;  // Null when no pattern has this target
+        std::vector<uint32_t> ids;                    // Sub-automaton id -> full pattern id
+    };
+
+    /**
+     * Scan one field instance (spans[first, end)) against a scope
+     */
+    void scanField(const Scope& scope, const uint8_t* data, const HttpSpan* spans, size_t first, size_t end,
+                   std::vector<FieldHit>& hits) const;
+
+    /**
+     * Find the scope of a named header
+     * @return Scope, or nullptr if no pattern targets that header
+     */
+    const Scope* headerScope(const uint8_t* name, size_t length) const;
+
+    std::shared_ptr<const PatternSet> patterns;
+    Scope fieldScopes[HTTP_FIELD_COUNT];
+    std::vector<std::string> headerNames;  // Lowercased, parallel to headerScopes
+    std::vector<Scope> headerScopes;
+    size_t scoped = 0;
+};
+
+#endif // FIELD_SCOPED_MATCHER_HPP
@@ -0,0 +1,196 @@
+#ifndef HTTP_NORMALIZER_HPP
+#define HTTP_NORMALIZER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "packet_inspection/http/http_stream_parser.hpp"
+
+/**
+ * What the normalizer decodes
+ */
+struct HttpNormalizerConfig {
+    enum class Base64 {
+        Off,       // Never; a body declared base64 is passed on raw
+        Declared,  // Bodies whose headers declare base64
+        All        // Every body, after its declared codings; raw from the first non-base64 byte
+    };
+
+    bool percentDecode = true;          // URI, and form-encoded bodies
+    bool inflate = true;                // gzip and deflate bodies (needs zlib)
+    Base64 base64 = Base64::Declared;
+    uint64_t maxDecodedBytes = 8 << 20; // Per body; decoding stops there (decompression bombs)
+
+    /**
+     * Defaults overridden by PKTINSPECT_HTTP_PERCENT (0/1), PKTINSPECT_HTTP_INFLATE (0/1),
+     * PKTINSPECT_HTTP_BASE64 ("off", "declared" or "all") and PKTINSPECT_HTTP_MAX_DECODED (bytes)
+     */
+    static HttpNormalizerConfig fromEnvironment();
+
+    /**
+     * Check if this build can inflate gzip and deflate bodies
+     */
+    static bool inflateSupported();
+};
+
+/**
+ * HttpNormalizer: Decodes HTTP fields on the fly for matching
+ * - Driven by HttpStreamParser: bytes go in as they arrive (any chunking),
+ *   normalized field bytes come out to a Sink in small runs
+ * - URI: percent-decoding ('+' is a space in the query)
+ * - Body: the coding stack from the headers is unwound stage by stage
+ *   (gzip/deflate inflation, base64), then form-encoded bodies are
+ *   percent-decoded. Every stage streams through a fixed buffer, and
+ *   inflation keeps zlib's 32 KB window, so no decoded body is ever held
+ *   in memory whatever its size
+ * - A body with a coding that cannot be decoded (br, or no zlib), and the
+ *   rest of a body after a decoding error, are passed on raw
+ * - Other fields are passed on as they are
+ *
+ * One instance follows one stream; reset() starts another and keeps the buffers.
+ */
+class HttpNormalizer : private HttpStreamParser::Listener {
+public:
+    /**
+     * Receives normalized field bytes
+     */
+    class Sink {
+    public:
+        virtual ~Sink() = default;
+        virtual void onNormalized(HttpField field, const uint8_t* data, size_t length) = 0;
+        virtual void onFieldEnd(HttpField field) = 0;
+        virtual void onMessageEnd() {}
+    };
+
+    /**
+     * Counters since construction
+     */
+    struct Stats {
+        uint64_t messages = 0;
+        uint64_t percentDecoded = 0;     // %XX escapes decoded
+        uint64_t inflatedBytes = 0;      // Bytes produced by inflation
+        uint64_t base64Bytes = 0;        // Bytes produced by base64 decoding
+        uint64_t undecodableBodies = 0;  // Bodies passed on raw because of their codings
+        uint64_t decodeErrors = 0;       // Bodies that fell back to raw part way through
+        uint64_t truncatedBodies = 0;    // Bodies cut at maxDecodedBytes
+    };
+
+    HttpNormalizer(Sink& sink, HttpNormalizerConfig config = HttpNormalizerConfig());
+    ~HttpNormalizer() override;
+
+    HttpNormalizer(const HttpNormalizer&) = delete;
+    HttpNormalizer& operator=(const HttpNormalizer&) = delete;
+
+    /**
+     * Normalize the next chunk of the stream
+     * @param data Bytes
+     * @param length Number of bytes
+     * @return false once the stream is not valid HTTP (nothing more is emitted)
+     */
+    bool feed(const uint8_t* data, size_t length) { return parser.feed(data, length); }
+
+    /**
+     * End of stream: completes a close-delimited body and flushes the decoders
+     */
+    void finish() { parser.finish(); }
+
+    /**
+     * Start a new stream (counters are kept)
+     */
+    void reset();
+
+    bool failed() const { return parser.failed(); }
+    const Stats& getStats() const { return stats; }
+    const HttpNormalizerConfig& getConfig() const { return config; }
+
+private:
+    class Inflater;
+
+    /**
+     * Streaming percent-decoder state
+     */
+    struct PercentState {
+        uint8_t pending = 0;  // 0, or 1/2 after '%' and one hex digit
+        uint8_t high = 0;     // First hex digit
+        bool plusIsSpace = false;
+        bool detectQuery = false;  // A literal '?' makes '+' a space (URIs)
+    };
+
+    /**
+     * Streaming base64 state
+     */
+    struct Base64State {
+        uint32_t bits = 0;
+        uint8_t sextets = 0;  // Sextets in bits (0-3)
+    };
+
+    enum class StageKind : uint8_t {
+        Inflate,
+        Base64,
+        Percent
+    };
+
+    /**
+     * One step of unwinding the body's coding stack
+     */
+    struct Stage {
+        StageKind kind = StageKind::Inflate;
+        Inflater* inflater = nullptr;  // Inflate only, from inflaters
+        Base64State base64;
+        PercentState percent;
+    };
+
+    void onField(HttpField field, const uint8_t* data, size_t length) override;
+    void onFieldEnd(HttpField field) override;
+    void onHeadersComplete(const HttpMessageInfo& info) override;
+    void onMessageEnd() override;
+
+    /**
+     * Pass bytes through the body stages from index on
+     * @return false if a stage could not decode them
+     */
+    bool runStages(size_t index, const uint8_t* data, size_t length);
+
+    /**
+     * Flush stage index and everything after it at the end of the body
+     */
+    void flushStages(size_t index);
+
+    /**
+     * Hand decoded body bytes to the sink, up to maxDecodedBytes
+     */
+    void emitBody(const uint8_t* data, size_t length);
+
+    template <typename Out>
+    void percentFlush(PercentState& state, Out&& out);
+
+    /**
+     * Percent-decode into out
+     * @param out Called with each decoded run
+     */
+    template <typename Out>
+    void percentDecode(PercentState& state, const uint8_t* data, size_t length, Out&& out);
+
+    /**
+     * Base64-decode into out, skipping whitespace
+     * @return false at the first byte outside the base64 alphabets
+     */
+    template <typename Out>
+    bool base64Decode(Base64State& state, const uint8_t* data, size_t length, Out&& out);
+
+    Sink& sink;
+    HttpNormalizerConfig config;
+    HttpStreamParser parser;
+    Stats stats;
+
+    PercentState uriState;
+    std::vector<Stage> stages;                       // Body stages of the current message
+    std::vector<std::unique_ptr<Inflater>> inflaters; // Reused across messages
+    bool rawBody = false;                            // Pass the body on undecoded
+    bool speculativeBase64 = false;                  // Last stage added by Base64::All, failing is expected
+    bool bodyCut = false;                            // maxDecodedBytes reached: drop the rest
+    uint64_t bodyBytes = 0;                          // Decoded bytes emitted for this body
+};
+
+#endif // HTTP_NORMALIZER_HPP
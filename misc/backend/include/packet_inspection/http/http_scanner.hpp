@@ -0,0 +1,76 @@
+#ifndef HTTP_SCANNER_HPP
+#define HTTP_SCANNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "packet_inspection/engine/ac_table_matcher.hpp"
+#include "packet_inspection/http/http_normalizer.hpp"
+
+/**
+ * Match in a normalized HTTP field
+ */
+struct HttpHit {
+    HttpField field;
+    uint32_t patternId;  // Into the matcher's PatternSet
+    uint32_t position;   // Last byte of the match in the normalized field
+    uint32_t message;    // Message index in the stream (pipelined messages count up)
+};
+
+/**
+ * HttpScanner: Matches patterns against normalized HTTP fields
+ * - The normalizer's output runs go straight into a resumable DFA scan
+ *   (AcTableMatcher::scanStream()): the state carries across runs, so a
+ *   match split by a decoder buffer or a packet boundary is still found,
+ *   and decoded bodies are never collected
+ * - The scan restarts at each field end; positions are relative to the
+ *   start of the normalized field
+ *
+ * One instance follows one stream, like HttpNormalizer.
+ */
+class HttpScanner : private HttpNormalizer::Sink {
+public:
+    HttpScanner(std::shared_ptr<const AcTableMatcher> matcher, HttpNormalizerConfig config = HttpNormalizerConfig());
+
+    /**
+     * Scan the next chunk of the stream
+     * @param data Bytes
+     * @param length Number of bytes
+     * @return false once the stream is not valid HTTP
+     */
+    bool feed(const uint8_t* data, size_t length) { return normalizer.feed(data, length); }
+
+    /**
+     * End of stream (see HttpNormalizer::finish())
+     */
+    void finish() { normalizer.finish(); }
+
+    /**
+     * Start a new stream; hits are kept until clearHits()
+     */
+    void reset();
+
+    /**
+     * Get the matches since the last clearHits(), in stream order
+     */
+    const std::vector<HttpHit>& getHits() const { return hits; }
+    void clearHits() { hits.clear(); }
+
+    const HttpNormalizer& getNormalizer() const { return normalizer; }
+
+private:
+    void onNormalized(HttpField field, const uint8_t* data, size_t length) override;
+    void onFieldEnd(HttpField field) override;
+    void onMessageEnd() override { ++message; }
+
+    std::shared_ptr<const AcTableMatcher> matcher;
+    HttpNormalizer normalizer;
+    std::vector<HttpHit> hits;
+    std::vector<PatternHit> scratch;
+    uint32_t state = 0;   // DFA state inside the current field
+    size_t offset = 0;    // Normalized bytes of the current field so far
+    uint32_t message = 0;
+};
+
+#endif // HTTP_SCANNER_HPP
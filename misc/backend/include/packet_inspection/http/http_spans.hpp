@@ -0,0 +1,62 @@
+#ifndef HTTP_SPANS_HPP
+#define HTTP_SPANS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "packet_inspection/http/http_stream_parser.hpp"
+
+/**
+ * Where a field run lies in a buffer
+ * A field broken up by framing (chunked body, continuation lines) is
+ * several spans with the same instance.
+ */
+struct HttpSpan {
+    HttpField field;
+    uint32_t offset;     // Into the buffer passed to HttpSpanCollector::collect()
+    uint32_t length;
+    uint32_t instance;   // Field occurrence: spans of one header value, one body... share it
+    uint32_t name;       // Header values: index of their header name span, else NO_NAME
+
+    static constexpr uint32_t NO_NAME = UINT32_MAX;
+};
+
+/**
+ * HttpSpanCollector: Field map of a buffer holding HTTP messages
+ * Runs HttpStreamParser over the buffer and records each field run as a
+ * (field, offset, length) span instead of copying it, so the fields can
+ * be scanned in place afterwards. Reusing a collector keeps its storage.
+ */
+class HttpSpanCollector : private HttpStreamParser::Listener {
+public:
+    HttpSpanCollector() : parser(*this) {}
+
+    HttpSpanCollector(const HttpSpanCollector&) = delete;
+    HttpSpanCollector& operator=(const HttpSpanCollector&) = delete;
+
+    /**
+     * Parse a buffer as one HTTP stream (a truncated last message is kept)
+     * @param data Bytes
+     * @param length Number of bytes
+     * @return false if the buffer is not valid HTTP; no spans are kept then
+     */
+    bool collect(const uint8_t* data, size_t length);
+
+    const std::vector<HttpSpan>& getSpans() const { return spans; }
+
+private:
+    void onField(HttpField field, const uint8_t* data, size_t length) override;
+    void onFieldEnd(HttpField field) override;
+    void onHeadersComplete(const HttpMessageInfo&) override {}
+    void onMessageEnd() override {}
+
+    HttpStreamParser parser;
+    std::vector<HttpSpan> spans;
+    const uint8_t* base = nullptr;
+    size_t baseLength = 0;
+    uint32_t instance = 0;
+    bool open = false;        // The last span's field has not ended yet
+    uint32_t lastName = HttpSpan::NO_NAME;
+};
+
+#endif // HTTP_SPANS_HPP
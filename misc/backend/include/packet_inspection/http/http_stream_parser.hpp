@@ -0,0 +1,203 @@
+#ifndef HTTP_STREAM_PARSER_HPP
+#define HTTP_STREAM_PARSER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Parts of an HTTP/1.x message the parser reports
+ */
+enum class HttpField : uint8_t {
+    Method,       // Request line
+    Uri,
+    Version,      // Request or status line
+    Status,       // Status line
+    Reason,
+    HeaderName,   // Headers and chunked trailers
+    HeaderValue,
+    Body          // After chunked framing is removed, still content-coded
+};
+
+constexpr size_t HTTP_FIELD_COUNT = 8;
+
+/**
+ * Lowercase field name, as used in JSON output
+ */
+const char* httpFieldName(HttpField field);
+
+/**
+ * Body codings the parser recognizes
+ */
+enum class HttpCoding : uint8_t {
+    Gzip,     // gzip, x-gzip
+    Deflate,  // deflate (zlib or raw)
+    Base64,   // Content-Transfer-Encoding: base64, or base64 in Content-Encoding
+    Unknown   // Anything else (br, compress...): the body cannot be decoded
+};
+
+/**
+ * What the headers say about the body, final once onHeadersComplete() is called
+ */
+struct HttpMessageInfo {
+    static constexpr size_t MAX_CODINGS = 4;
+
+    bool response = false;
+    bool chunked = false;
+    bool hasContentLength = false;
+    uint64_t contentLength = 0;
+    bool formEncoded = false;            // Content-Type: application/x-www-form-urlencoded
+    uint8_t codingCount = 0;
+    HttpCoding codings[MAX_CODINGS] = {};  // In the order applied; decode from the back
+    bool tooManyCodings = false;         // More than MAX_CODINGS were listed
+};
+
+/**
+ * HttpStreamParser: Resumable HTTP/1.x parser (pushdown automaton)
+ * - Bytes arrive in chunks of any size, split anywhere; the state carries
+ *   over, so a message spread over several packets parses as one
+ * - Field bytes are reported as runs pointing into the caller's chunk (a
+ *   field split across chunks arrives as several runs); nothing is copied
+ *   except the values of the few headers that frame the body
+ * - Header parsing pushes the body's codings (Content-Encoding, then
+ *   Transfer-Encoding codings other than chunked, then a base64
+ *   Content-Transfer-Encoding) onto a bounded stack, which the listener
+ *   pops to decode the body; chunked framing is removed here
+ * - Requests and responses, pipelined messages, obs-fold continuation lines
+ *   and bare LF line endings are accepted
+ *
+ * After a syntax error the parser stops (failed()) and ignores further input.
+ */
+class HttpStreamParser {
+public:
+    /**
+     * Receives the parse events, in stream order
+     */
+    class Listener {
+    public:
+        virtual ~Listener() = default;
+
+        /**
+         * A run of field bytes
+         * @param field Field the bytes belong to
+         * @param data Bytes, inside the chunk passed to feed()
+         * @param length Number of bytes
+         */
+        virtual void onField(HttpField field, const uint8_t* data, size_t length) = 0;
+
+        /**
+         * The field's last run has been reported
+         */
+        virtual void onFieldEnd(HttpField field) = 0;
+
+        /**
+         * The headers are complete; the body (if any) follows
+         */
+        virtual void onHeadersComplete(const HttpMessageInfo& info) = 0;
+
+        /**
+         * The message is complete (a pipelined one may follow)
+         */
+        virtual void onMessageEnd() = 0;
+    };
+
+    explicit HttpStreamParser(Listener& listener) : listener(listener) {}
+
+    /**
+     * Parse the next chunk of the stream
+     * @param data Bytes
+     * @param length Number of bytes
+     * @return false once the stream is not valid HTTP
+     */
+    bool feed(const uint8_t* data, size_t length);
+
+    /**
+     * End of stream: completes a body delimited by the connection close
+     */
+    void finish();
+
+    /**
+     * Start a new stream
+     */
+    void reset();
+
+    bool failed() const { return state == State::Failed; }
+    uint64_t messages() const { return messageCount; }
+
+private:
+    enum class State : uint8_t {
+        FirstToken,      // Method, or the version of a status line
+        Uri,
+        Version,
+        Status,
+        Reason,
+        LineEnd,         // Saw CR, expecting LF
+        HeaderLineStart,
+        HeaderName,
+        HeaderValueStart,
+        HeaderValue,
+        ChunkSize,
+        ChunkExtension,
+        ChunkData,
+        ChunkDataEnd,
+        Body,            // Content-Length bytes
+        BodyUntilClose,
+        Failed
+    };
+
+    /**
+     * Line a CR/LF ends, for LineEnd
+     */
+    enum class LineKind : uint8_t {
+        StartLine,
+        Header,
+        Blank,
+        ChunkSize,
+        ChunkDataEnd
+    };
+
+    static constexpr size_t TOKEN_MAX = 16;     // Longest method or version accepted
+    static constexpr size_t CAPTURE_MAX = 128;  // Header bytes kept for framing headers
+
+    /**
+     * Enter LineEnd on CR, or finish the line at once on a bare LF
+     */
+    void startLineEnd(LineKind kind, uint8_t byte);
+    void lineDone();
+
+    /**
+     * End the pending header value and apply it if it frames the body
+     */
+    void headerDone();
+    void pushCoding(HttpCoding* stack, uint8_t& count, HttpCoding coding);
+    void headersDone();
+    void messageDone();
+    void fail() { state = State::Failed; }
+
+    Listener& listener;
+    State state = State::FirstToken;
+    LineKind lineKind = LineKind::StartLine;
+    bool inTrailers = false;
+    bool valueOpen = false;  // A header value may still get continuation lines
+    bool hadBody = false;    // The message has a body (onFieldEnd(Body) is due)
+
+    char token[TOKEN_MAX];
+    size_t tokenLength = 0;
+    uint16_t statusCode = 0;
+    char name[CAPTURE_MAX];  // Lowercased
+    size_t nameLength = 0;
+    char value[CAPTURE_MAX]; // Lowercased
+    size_t valueLength = 0;
+    uint64_t remaining = 0;  // Body or chunk bytes left
+    uint8_t chunkDigits = 0;
+
+    // Coding stack: Transfer-Encoding and Content-Transfer-Encoding are
+    // pushed on top of the content codings once the headers are complete
+    HttpCoding transferCodings[HttpMessageInfo::MAX_CODINGS] = {};
+    uint8_t transferCount = 0;
+    bool base64Transfer = false;
+
+    HttpMessageInfo info;
+    uint64_t messageCount = 0;
+};
+
+#endif // HTTP_STREAM_PARSER_HPP
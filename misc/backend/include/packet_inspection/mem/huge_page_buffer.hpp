@@ -0,0 +1,92 @@
+#ifndef HUGE_PAGE_BUFFER_HPP
+#define HUGE_PAGE_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Page size backing a buffer
+ */
+enum class PageBacking {
+    Small,        // 4 KB pages (THP explicitly disabled for the range)
+    Transparent,  // 2 MB aligned, madvise(MADV_HUGEPAGE), kernel promotes to THP
+    Explicit      // MAP_HUGETLB from the hugetlbfs pool (vm.nr_hugepages)
+};
+
+/**
+ * HugePageBuffer: Anonymous mapping for large read-mostly tables
+ * - Explicit falls back to Transparent when the hugetlb pool is empty, and
+ *   Transparent to Small on kernels without THP; backing() tells what was
+ *   actually obtained
+ * - Optional pre-faulting touches every page at allocation, so the first
+ *   scans do not pay page faults and huge pages are assigned up front
+ * - PKTINSPECT_HUGEPAGES=off|thp|hugetlb picks the backing for automaton
+ *   tables (default: thp for tables of 2 MB or more), PKTINSPECT_PREFAULT=0
+ *   disables pre-faulting
+ */
+class HugePageBuffer {
+public:
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+    HugePageBuffer() = default;
+    ~HugePageBuffer();
+
+    HugePageBuffer(const HugePageBuffer&) = delete;
+    HugePageBuffer& operator=(const HugePageBuffer&) = delete;
+    HugePageBuffer(HugePageBuffer&& other) noexcept;
+    HugePageBuffer& operator=(HugePageBuffer&& other) noexcept;
+
+    /**
+     * Allocate a zero-filled buffer, releasing any previous one
+     * @param bytes Requested size
+     * @param backing Requested page size
+     * @param prefault Touch every page now
+     * @return true on success
+     */
+    bool allocate(size_t bytes, PageBacking backing, bool prefault);
+
+    /**
+     * Unmap the buffer
+     */
+    void release();
+
+    void* data() { return start; }
+    const void* data() const { return start; }
+    size_t size() const { return length; }
+    PageBacking backing() const { return obtained; }
+
+    /**
+     * Bytes of the buffer currently backed by huge pages (from /proc/self/smaps)
+     * @return Huge page bytes, 0 if unknown
+     */
+    size_t hugePageBytes() const;
+
+    /**
+     * Get the backing configured for automaton tables
+     * @param bytes Table size
+     * @return Backing from PKTINSPECT_HUGEPAGES, or the size-based default
+     */
+    static PageBacking configuredBacking(size_t bytes);
+
+    /**
+     * Check if tables should be pre-faulted (PKTINSPECT_PREFAULT)
+     * @return true unless disabled
+     */
+    static bool prefaultEnabled();
+
+    /**
+     * Get the printable name of a backing
+     * @param backing Page backing
+     * @return Name as accepted by PKTINSPECT_HUGEPAGES
+     */
+    static const char* backingName(PageBacking backing);
+
+private:
+    void* mapping = nullptr;   // What mmap returned (may be larger than the buffer)
+    size_t mappingLength = 0;
+    void* start = nullptr;
+    size_t length = 0;
+    PageBacking obtained = PageBacking::Small;
+};
+
+#endif // HUGE_PAGE_BUFFER_HPP
@@ -4,7 +4,9 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <cstdio>
 #include <memory>
+#include <functional>
 
 /**
  * Represents a single packet extracted from a PCAP file
@@ -18,6 +20,28 @@ struct Packet {
     uint32_t timestamp;
 };
 
+/**
+ * Non-owning view of a packet's TCP payload
+ * Points into the reader's file buffer: valid until the next read on that
+ * reader or its destruction
+ */
+struct PacketView {
+    uint32_t packetId;
+    uint32_t timestamp;
+    const uint8_t* payload;
+    uint32_t payloadLength;
+};
+
+/**
+ * Position in a capture opened with PacketReader::openCapture()
+ */
+struct CaptureCursor {
+    size_t offset = 0;      // Next record header in the reader's file buffer
+    size_t end = 0;         // Bytes loaded
+    uint32_t packetId = 0;  // Id of the next frame
+    bool swapped = false;   // File written with the other byte order
+};
+
 /**
  * PacketReader: Loads PCAP files and extracts TCP payloads
  * Provides raw bytes, hex encoding, and ASCII representation
@@ -34,6 +58,54 @@ public:
      */
     std::vector<Packet> readPcapFile(const std::string& pcapFilePath);
 
+    /**
+     * Stream TCP payloads of a PCAP file without building hex/ASCII copies
+     * The file is read with a single bulk read into a buffer reused across calls
+     * @param pcapFilePath Path to the .pcap file
+     * @param callback Invoked for each packet with a non-empty TCP payload
+     * @return Number of bytes read from the file, or -1 if it is not a readable PCAP file
+     */
+    int64_t forEachPayload(const std::string& pcapFilePath,
+                           const std::function<void(const PacketView&)>& callback);
+
+    /**
+     * Stream captured frames of a PCAP file, TCP or not, without decoding them
+     * The view covers the whole frame; locateTcpPayload() finds the payload in it.
+     * Frames stay valid until the next call on this reader.
+     * @param pcapFilePath Path to the .pcap file
+     * @param callback Invoked for each frame with a sane captured length
+     * @return Number of bytes read from the file, or -1 if it is not a readable PCAP file
+     */
+    int64_t forEachFrame(const std::string& pcapFilePath,
+                         const std::function<void(const PacketView&)>& callback);
+
+    /**
+     * Load a PCAP file for pull-style reading with nextFrame()
+     * Replaces whatever the reader had loaded before.
+     * @param pcapFilePath Path to the .pcap file
+     * @param cursor Set to the first frame
+     * @return Number of bytes read from the file, or -1 if it is not a readable PCAP file
+     */
+    int64_t openCapture(const std::string& pcapFilePath, CaptureCursor& cursor);
+
+    /**
+     * Read the next captured frame (the same frames forEachFrame() visits)
+     * @param cursor Cursor from openCapture(), advanced past the frame
+     * @param frame Set to the frame, valid until the next openCapture() or read on this reader
+     * @return false at the end of the capture
+     */
+    bool nextFrame(CaptureCursor& cursor, PacketView& frame) const;
+
+    /**
+     * Locate the TCP payload inside a raw IP packet
+     * @param packetData Raw packet data
+     * @param packetLength Length of packet data
+     * @param payloadLength Set to the payload length (0 if none)
+     * @return Pointer to payload start, or nullptr if not a TCP packet with payload
+     */
+    const uint8_t* locateTcpPayload(const uint8_t* packetData, uint32_t packetLength,
+                                    uint32_t& payloadLength) const;
+
     /**
      * Extract TCP payload from packet data
      * @param packetData Raw packet data
@@ -48,6 +120,15 @@ public:
      * @return Hex string representation (lowercase)
      */
     static std::string bytesToHex(const std::vector<uint8_t>& data);
+    static std::string bytesToHex(const uint8_t* data, size_t length);
+
+    /**
+     * Convert a hex string back to bytes (a trailing odd digit is ignored)
+     * @param hex Hex digits, either case
+     * @return Decoded bytes
+     * @throws std::invalid_argument on a character that is not a hex digit
+     */
+    static std::string hexToBytes(const std::string& hex);
 
     /**
      * Convert bytes to ASCII string (non-printable chars as '.')
@@ -55,6 +136,7 @@ public:
      * @return ASCII string representation
      */
     static std::string bytesToAscii(const std::vector<uint8_t>& data);
+    static std::string bytesToAscii(const uint8_t* data, size_t length);
 
 private:
     /**
@@ -79,6 +161,8 @@ private:
      * @return Offset to start of TCP payload
      */
     uint32_t findTcpPayloadStart(const uint8_t* packetData, uint32_t packetLength) const;
+
+    std::vector<uint8_t> fileBuffer;  // Reused by forEachPayload()
 };
 
 #endif // PACKET_READER_HPP
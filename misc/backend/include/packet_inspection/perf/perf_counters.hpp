@@ -0,0 +1,113 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+/**
+ * Hardware events collected around engine calls
+ */
+enum class PerfEvent {
+    Cycles,
+    Instructions,
+    L1DMisses,
+    LLCMisses,
+    BranchMisses,
+    DTLBMisses,
+    Count
+};
+
+const size_t PERF_EVENT_COUNT = static_cast<size_t>(PerfEvent::Count);
+
+/**
+ * Accumulated counter values
+ * Events the kernel or CPU refused to open are left out of availableMask
+ */
+struct PerfCounts {
+    uint64_t values[PERF_EVENT_COUNT] = {};
+    uint32_t availableMask = 0;
+
+    uint64_t get(PerfEvent event) const { return values[static_cast<size_t>(event)]; }
+    bool has(PerfEvent event) const { return availableMask & (1u << static_cast<size_t>(event)); }
+
+    PerfCounts& operator+=(const PerfCounts& other);
+
+    /**
+     * Export raw counts plus per-byte and per-packet ratios
+     * @param bytes Bytes processed while counting
+     * @param packets Packets processed while counting
+     * @return JSON object keyed by event name
+     */
+    json toJson(uint64_t bytes, uint64_t packets) const;
+};
+
+/**
+ * PerfCounters: perf_event_open group for the calling thread
+ * - User-space only (exclude_kernel), so it works with perf_event_paranoid <= 2
+ * - Counts are scaled when the kernel multiplexes the group
+ * - On non-Linux builds or without permission, open() returns false
+ */
+class PerfCounters {
+public:
+    PerfCounters() = default;
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /**
+     * Open the counter group for the calling thread
+     * @return true if at least one event could be opened
+     */
+    bool open();
+
+    /**
+     * Check if counters are open
+     * @return true if open() succeeded
+     */
+    bool isOpen() const { return groupFd >= 0; }
+
+    /**
+     * Reset and start counting
+     */
+    void start();
+
+    /**
+     * Stop counting and read the counters
+     * @return Counts since start()
+     */
+    PerfCounts stop();
+
+    /**
+     * Get the printable name of an event
+     * @param event Event
+     * @return Name used in reports
+     */
+    static const char* eventName(PerfEvent event);
+
+private:
+    int groupFd = -1;
+    int fds[PERF_EVENT_COUNT] = {-1, -1, -1, -1, -1, -1};
+    uint64_t eventIds[PERF_EVENT_COUNT] = {};  // Kernel ids, to map group reads back to events
+    uint32_t availableMask = 0;
+};
+
+/**
+ * PerfScope: RAII helper that adds the counts of its lifetime to a total
+ */
+class PerfScope {
+public:
+    PerfScope(PerfCounters& counters, PerfCounts& total) : counters(counters), total(total) {
+        counters.start();
+    }
+    ~PerfScope() { total += counters.stop(); }
+
+private:
+    PerfCounters& counters;
+    PerfCounts& total;
+};
+
+#endif // PERF_COUNTERS_HPP
@@ -0,0 +1,120 @@
+#ifndef FLOW_TABLE_HPP
+#define FLOW_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Direction-independent TCP/UDP connection key
+ * Endpoints are stored in canonical order (lower address, then lower port,
+ * first), so both directions of a flow produce equal keys.
+ */
+struct FlowKey {
+    uint8_t lowAddress[16] = {};   // IPv4 addresses use the first 4 bytes
+    uint8_t highAddress[16] = {};
+    uint16_t lowPort = 0;
+    uint16_t highPort = 0;
+    uint8_t protocol = 0;
+    uint8_t version = 0;           // 4 or 6, 0 for an empty key
+
+    bool operator==(const FlowKey& other) const;
+};
+
+/**
+ * Read the 5-tuple of a raw IPv4/IPv6 frame
+ * @param frame Frame starting at the IP header (LINKTYPE_RAW)
+ * @param length Captured length
+ * @param key Set to the canonical flow key
+ * @param hash Set to flowHash(key)
+ * @return true if the frame is TCP or UDP with complete headers
+ */
+bool extractFlow(const uint8_t* frame, uint32_t length, FlowKey& key, uint32_t& hash);
+
+/**
+ * Symmetric flow hash
+ * Hashes the canonical key, so both directions of a flow hash alike. (The
+ * symmetric Toeplitz key NICs use for this folds the tuple to 16 bits, and
+ * client/server pairs that differ only in address and port often collide.)
+ * @param key Canonical flow key
+ * @return 32-bit hash, well mixed in every bit
+ */
+uint32_t flowHash(const FlowKey& key);
+
+/**
+ * Pick the worker that owns a flow, RSS style
+ * @param hash Flow hash
+ * @param workers Worker count (> 0)
+ * @return Worker index
+ */
+inline unsigned flowWorker(uint32_t hash, unsigned workers) {
+    return static_cast<unsigned>((static_cast<uint64_t>(hash) * workers) >> 32);
+}
+
+/**
+ * Per-flow state kept by a matcher worker
+ */
+struct FlowState {
+    FlowKey key;
+    uint32_t hash = 0;
+    uint64_t packets = 0;
+    uint64_t bytes = 0;          // TCP/UDP payload bytes
+    uint64_t hits = 0;
+    uint32_t firstSeen = 0;      // Capture timestamps (seconds)
+    uint32_t lastSeen = 0;
+};
+
+/**
+ * FlowTable: Open-addressing flow table owned by a single thread
+ * - No locks or atomics: a flow-affine dispatcher guarantees that only the
+ *   worker that owns a flow ever touches its entry
+ * - Linear probing on the precomputed hash; grows at 50% load
+ * - Entries are allocated by the first insert, i.e. on the owning thread,
+ *   so a pinned worker gets node-local memory
+ *
+ * References returned by find() stay valid until the next insert.
+ */
+class FlowTable {
+public:
+    explicit FlowTable(size_t initialCapacity = 1024);
+
+    /**
+     * Find a flow, creating it if it is new
+     * @param key Canonical flow key
+     * @param hash The flow's hash (from extractFlow)
+     * @param timestamp Capture time of the packet, stamps new flows
+     * @return The flow's state
+     */
+    FlowState& findOrInsert(const FlowKey& key, uint32_t hash, uint32_t timestamp);
+
+    /**
+     * Find a flow
+     * @return The flow's state, or nullptr if it has not been seen
+     */
+    FlowState* find(const FlowKey& key, uint32_t hash);
+
+    size_t size() const { return count; }
+
+    size_t memoryUsage() const { return slots.size() * sizeof(FlowState); }
+
+    /**
+     * Visit every flow (in table order)
+     */
+    template <typename Callback>
+    void forEach(Callback&& callback) const {
+        for (const FlowState& slot : slots) {
+            if (slot.key.version != 0) {
+                callback(slot);
+            }
+        }
+    }
+
+private:
+    void grow();
+
+    std::vector<FlowState> slots;
+    size_t mask = 0;
+    size_t count = 0;
+};
+
+#endif // FLOW_TABLE_HPP
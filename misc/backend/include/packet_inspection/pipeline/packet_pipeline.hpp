@@ -0,0 +1,228 @@
+#ifndef PACKET_PIPELINE_HPP
+#define PACKET_PIPELINE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "packet_inspection/engine/matcher.hpp"
+#include "packet_inspection/pcap/packet_reader.hpp"
+#include "packet_inspection/pipeline/flow_table.hpp"
+#include "packet_inspection/pipeline/spsc_ring.hpp"
+#include "packet_inspection/sched/cancel_token.hpp"
+#include "packet_inspection/sched/victim_picker.hpp"
+#include "packet_inspection/sched/work_stealing_deque.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * Packet descriptor passed between pipeline stages
+ * Descriptors live in a fixed pool; the rings carry pool indices only.
+ */
+struct PipelinePacket {
+    uint64_t sequence = 0;             // Capture order, for callers that need to restore it
+    uint32_t packetId = 0;
+    uint32_t timestamp = 0;
+    const uint8_t* frame = nullptr;    // Captured frame, points into the reader's file buffer
+    uint32_t frameLength = 0;
+    const uint8_t* payload = nullptr;  // TCP payload inside frame, null if there is none
+    uint32_t payloadLength = 0;
+    FlowKey flow;                      // Set by the decoder when hasFlow
+    uint32_t flowHash = 0;             // Symmetric 5-tuple hash (flowHash)
+    bool hasFlow = false;
+    std::vector<PatternHit> hits;      // Filled by the matcher stage (capacity reused)
+};
+
+/**
+ * Pipeline shape
+ */
+struct PipelineConfig {
+    /**
+     * How the decoder spreads packets over the workers
+     */
+    enum class Dispatch {
+        Batch,  // Whole batches round-robin; a flow's packets may land on any worker
+        Flow,   // By 5-tuple hash; every packet of a flow (both directions) goes to one worker
+        Steal   // Batches round-robin, and idle workers steal queued packets from busy ones
+    };
+
+    unsigned workers = defaultWorkers();  // Matcher stage threads
+    size_t ringCapacity = 1024; // Per ring, and the number of descriptors in flight
+    size_t batchSize = 32;      // Descriptors moved per ring operation
+    std::vector<int> cpus;      // Pinning: reader, decoder, workers..., sink (-1 or missing = unpinned)
+    int numaNode = -1;          // Workers left unpinned by cpus are spread over this node's CPUs
+    Dispatch dispatch = Dispatch::Steal;
+
+    /**
+     * Defaults overridden by PKTINSPECT_PIPELINE_WORKERS, PKTINSPECT_PIPELINE_RING,
+     * PKTINSPECT_PIPELINE_BATCH, PKTINSPECT_PIPELINE_CPUS (comma-separated),
+     * PKTINSPECT_PIPELINE_NUMA and PKTINSPECT_PIPELINE_DISPATCH ("steal", "flow" or "batch")
+     */
+    static PipelineConfig fromEnvironment();
+
+    /**
+     * Hardware threads left after the reader, decoder and sink threads (at least 1)
+     */
+    static unsigned defaultWorkers();
+
+    static const char* dispatchName(Dispatch dispatch);
+};
+
+/**
+ * PacketPipeline: Staged capture scanner
+ *
+ *   reader -> decoder -> matcher workers -> sink
+ *     ^                                      |
+ *     +------------- free descriptors -------+
+ *
+ * - reader: walks the capture's frames (PacketReader::nextFrame)
+ * - decoder: locates TCP payloads and flows, and spreads packets over the workers
+ * - workers: run the Matcher on each payload and keep per-flow state
+ * - sink: hands finished descriptors to the caller's callback, then recycles them
+ *
+ * Every arrow is an SpscRing of descriptor indices, so no stage takes a lock.
+ * Each stage runs on its own thread, optionally pinned to a core, and moves
+ * descriptors in batches. Per-stage counters and ring depths can be read
+ * while the pipeline runs (statsJson), which shows the bottleneck stage:
+ * its input ring runs full while the rings after it stay empty.
+ *
+ * With Dispatch::Steal (the default) each worker moves its input into a
+ * WorkStealingDeque, and a worker that runs dry steals packets from a random
+ * busy one, so a run of jumbo payloads on one worker does not leave the
+ * others idle. With Dispatch::Flow the decoder instead steers packets by a
+ * symmetric 5-tuple hash (RSS style), so each worker owns its flows
+ * outright: its FlowTable needs no locks, and the packets of one flow are
+ * matched in capture order.
+ *
+ * A CancelToken passed to run() is polled once per batch by every stage.
+ * Once it fires, the reader stops reading and the descriptors still in
+ * flight pass through without being decoded, matched or handed to the sink,
+ * so the run returns within a few batches.
+ *
+ * The sink sees packets out of capture order when there are several workers
+ * (use PipelinePacket::sequence). An instance runs one capture.
+ */
+class PacketPipeline {
+public:
+    using Sink = std::function<void(const PipelinePacket&)>;
+
+    /**
+     * @param matcher Engine for the worker stage (shared, immutable)
+     * @param config Pipeline shape
+     */
+    PacketPipeline(std::shared_ptr<const Matcher> matcher, PipelineConfig config = PipelineConfig());
+
+    PacketPipeline(const PacketPipeline&) = delete;
+    PacketPipeline& operator=(const PacketPipeline&) = delete;
+
+    /**
+     * Scan a capture through the pipeline and wait until it drains
+     * @param pcapPath Capture file
+     * @param sink Called on the sink thread for every packet with a TCP payload
+     * @param cancel Optional stop signal; must outlive run(). After a stop the
+     *               sink has seen only part of the capture (check cancel->reason())
+     * @return Bytes read from the file, or -1 if it could not be read (or run() was already used)
+     */
+    int64_t run(const std::string& pcapPath, const Sink& sink, const CancelToken* cancel = nullptr);
+
+    /**
+     * Per-stage counters and ring depths (safe to call during run())
+     * @return {"workers", "ringCapacity", "batchSize", "stages": [...]}
+     */
+    json statsJson() const;
+
+    /**
+     * Flows seen by the workers (Dispatch::Flow only; call after run() returns)
+     * @param top Keep only the N flows with the most payload bytes (0 = all)
+     * @return {"flows", "perWorker": [...], "top": [...]}
+     */
+    json flowsJson(size_t top) const;
+
+    const PipelineConfig& getConfig() const { return config; }
+
+    /**
+     * Check if run() has returned (flowsJson() is safe from then on)
+     */
+    bool isFinished() const { return finished.load(std::memory_order_acquire); }
+
+private:
+    /**
+     * Counters of one stage; written only by that stage's thread
+     */
+    struct alignas(64) StageCounters {
+        std::atomic<uint64_t> processed{0};   // Descriptors handled
+        std::atomic<uint64_t> batches{0};     // Non-empty batches handled
+        std::atomic<uint64_t> idlePolls{0};   // Input ring found empty (waiting on upstream)
+        std::atomic<uint64_t> stalls{0};      // Output ring found full (waiting on downstream)
+        std::atomic<uint64_t> maxInputDepth{0};
+        std::atomic<uint64_t> dropped{0};     // Descriptors passed on unprocessed after a stop
+        std::atomic<uint64_t> flows{0};       // Workers only: flows owned
+        std::atomic<uint64_t> steals{0};      // Workers only: packets taken from other workers
+        std::atomic<uint64_t> busyNs{0};      // Workers only: time spent matching
+    };
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    static void raise(std::atomic<uint64_t>& counter, uint64_t value) {
+        if (value > counter.load(std::memory_order_relaxed)) {
+            counter.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Push a whole batch, waiting while the ring is full
+     */
+    static void pushAll(SpscRing<uint32_t>& ring, const uint32_t* items, size_t count, StageCounters& counters);
+
+    void pinStage(size_t stageIndex) const;
+
+    /**
+     * Push each descriptor of a batch to the worker that owns its flow
+     */
+    void dispatchByFlow(const uint32_t* batch, size_t count, StageCounters& stage);
+
+    void readerStage(const std::string& pcapPath, int64_t& bytesRead);
+    void decoderStage();
+    void workerStage(unsigned worker);
+
+    /**
+     * Take one queued packet from a random other worker (Dispatch::Steal)
+     */
+    bool stealPacket(unsigned thief, VictimPicker& victims, uint32_t& slot);
+
+    /**
+     * Check if every worker's input is drained and its deque empty
+     */
+    bool workersDrained() const;
+    void sinkStage(const Sink& sink);
+
+    std::shared_ptr<const Matcher> matcher;
+    PipelineConfig config;
+    std::vector<PipelinePacket> packets;  // Descriptor pool
+    PacketReader reader;                  // Owns the file buffer the frames point into until run() returns
+
+    SpscRing<uint32_t> freeRing;     // sink -> reader
+    SpscRing<uint32_t> decodeRing;   // reader -> decoder
+    std::vector<std::unique_ptr<SpscRing<uint32_t>>> workRings;    // decoder -> worker i
+    std::vector<std::unique_ptr<SpscRing<uint32_t>>> resultRings;  // worker i -> sink
+    std::vector<std::unique_ptr<FlowTable>> flowTables;            // Owned by worker i while it runs
+    std::vector<std::unique_ptr<WorkStealingDeque<uint32_t>>> stealDeques;  // Worker i's stealable queue
+    std::vector<std::vector<uint32_t>> flowBuckets;                // Decoder scratch, one per worker
+    std::vector<int> numaCpus;                                     // CPUs of config.numaNode
+    const CancelToken* cancel = nullptr;                           // Stages only, for the duration of run()
+
+    // reader, decoder, workers..., sink
+    std::vector<std::unique_ptr<StageCounters>> counters;
+    std::atomic<bool> started{false};
+    std::atomic<bool> finished{false};
+    std::atomic<uint64_t> startNs{0};
+    std::atomic<uint64_t> endNs{0};
+    std::atomic<uint8_t> stopReason{0};  // CancelToken::Reason the run ended with, set when it returns
+};
+
+#endif // PACKET_PIPELINE_HPP
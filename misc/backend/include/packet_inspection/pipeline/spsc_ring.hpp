@@ -0,0 +1,156 @@
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/**
+ * Pause briefly inside a spin-wait (PAUSE on x86, a yield elsewhere)
+ */
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+/**
+ * Spin-then-yield wait used by pipeline stages
+ * Spins for a short while, then yields so that oversubscribed stages
+ * (more stages than cores) still make progress
+ */
+class Backoff {
+public:
+    void pause() {
+        if (spins < SPIN_LIMIT) {
+            ++spins;
+            cpuRelax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    void reset() { spins = 0; }
+
+private:
+    static const unsigned SPIN_LIMIT = 64;
+    unsigned spins = 0;
+};
+
+/**
+ * SpscRing: Bounded lock-free single-producer/single-consumer queue
+ * - Capacity is rounded up to a power of two
+ * - Producer and consumer indices sit on their own cache lines, and each
+ *   side caches the other's index so that a push or pop only touches the
+ *   shared line when the cached view says the ring looks full or empty
+ * - Batch push/pop publish many items with one release store
+ * - close() marks the end of the stream; the consumer drains what is left
+ *
+ * Exactly one thread may push and exactly one thread may pop.
+ */
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity) {
+        size_t rounded = 2;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        slots.resize(rounded);
+        mask = rounded - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * Append up to count items (producer only)
+     * @return Number of items pushed, 0 if the ring is full
+     */
+    size_t pushBatch(const T* items, size_t count) {
+        size_t tail = producer.tail.load(std::memory_order_relaxed);
+        size_t free = slots.size() - (tail - producer.cachedHead);
+        if (free < count) {
+            producer.cachedHead = consumer.head.load(std::memory_order_acquire);
+            free = slots.size() - (tail - producer.cachedHead);
+        }
+        size_t n = count < free ? count : free;
+        for (size_t i = 0; i < n; ++i) {
+            slots[(tail + i) & mask] = items[i];
+        }
+        if (n > 0) {
+            producer.tail.store(tail + n, std::memory_order_release);
+        }
+        return n;
+    }
+
+    bool tryPush(const T& item) { return pushBatch(&item, 1) == 1; }
+
+    /**
+     * Take up to max items (consumer only)
+     * @return Number of items written to out, 0 if the ring is empty
+     */
+    size_t popBatch(T* out, size_t max) {
+        size_t head = consumer.head.load(std::memory_order_relaxed);
+        size_t available = consumer.cachedTail - head;
+        if (available == 0) {
+            consumer.cachedTail = producer.tail.load(std::memory_order_acquire);
+            available = consumer.cachedTail - head;
+        }
+        size_t n = max < available ? max : available;
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = slots[(head + i) & mask];
+        }
+        if (n > 0) {
+            consumer.head.store(head + n, std::memory_order_release);
+        }
+        return n;
+    }
+
+    bool tryPop(T& out) { return popBatch(&out, 1) == 1; }
+
+    /**
+     * Items currently queued (exact only when both sides are idle)
+     */
+    size_t size() const {
+        size_t tail = producer.tail.load(std::memory_order_acquire);
+        size_t head = consumer.head.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    size_t capacity() const { return slots.size(); }
+
+    /**
+     * Mark the end of the stream (producer only, after its last push)
+     */
+    void close() { closed.store(true, std::memory_order_release); }
+
+    /**
+     * Check if the producer is done and every item has been popped
+     */
+    bool isDrained() const {
+        return closed.load(std::memory_order_acquire) && size() == 0;
+    }
+
+private:
+    struct alignas(64) ProducerSide {
+        std::atomic<size_t> tail{0};
+        size_t cachedHead = 0;
+    };
+
+    struct alignas(64) ConsumerSide {
+        std::atomic<size_t> head{0};
+        size_t cachedTail = 0;
+    };
+
+    ProducerSide producer;
+    ConsumerSide consumer;
+    alignas(64) std::atomic<bool> closed{false};
+    std::vector<T> slots;
+    size_t mask = 0;
+};
+
+#endif // SPSC_RING_HPP
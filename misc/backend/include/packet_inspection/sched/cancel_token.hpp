@@ -0,0 +1,99 @@
+#ifndef CANCEL_TOKEN_HPP
+#define CANCEL_TOKEN_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "packet_inspection/trace/tracer.hpp"
+
+/**
+ * CancelToken: Cooperative stop signal with an optional deadline
+ * - Long loops poll stopRequested() at batch granularity and wind down on
+ *   their own; nothing is interrupted
+ * - cancel() may be called from any thread (a cancel endpoint, a watchdog)
+ * - A deadline turns into a stop the first time a poll finds it passed, so
+ *   no timer thread is needed
+ *
+ * Polling costs one relaxed load, plus a steady_clock read while a deadline
+ * is set. Share one token by pointer between everything working on a request.
+ */
+class CancelToken {
+public:
+    enum class Reason : uint8_t {
+        None,              // Still running
+        Cancelled,         // cancel() was called
+        DeadlineExceeded   // Polled after the deadline
+    };
+
+    CancelToken() = default;
+
+    /**
+     * @param timeout Deadline relative to now
+     */
+    explicit CancelToken(std::chrono::nanoseconds timeout) { setTimeout(timeout); }
+
+    CancelToken(const CancelToken&) = delete;
+    CancelToken& operator=(const CancelToken&) = delete;
+
+    /**
+     * Ask every loop polling this token to stop
+     */
+    void cancel() { stop(Reason::Cancelled); }
+
+    /**
+     * Set or move the deadline (a later poll past it stops the work)
+     * @param timeout Time from now; zero or negative stops at the next poll
+     */
+    void setTimeout(std::chrono::nanoseconds timeout) {
+        deadlineNs.store(std::max<int64_t>(1, nowNs() + timeout.count()), std::memory_order_relaxed);
+    }
+
+    /**
+     * Check if the work should stop (cancelled, or the deadline has passed)
+     */
+    bool stopRequested() const {
+        if (state.load(std::memory_order_relaxed) != static_cast<uint8_t>(Reason::None)) {
+            return true;
+        }
+        int64_t deadline = deadlineNs.load(std::memory_order_relaxed);
+        if (deadline != 0 && nowNs() >= deadline) {
+            stop(Reason::DeadlineExceeded);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Why the work was stopped (the first reason wins)
+     */
+    Reason reason() const { return static_cast<Reason>(state.load(std::memory_order_relaxed)); }
+
+    static const char* reasonName(Reason reason) {
+        switch (reason) {
+            case Reason::None: return "none";
+            case Reason::Cancelled: return "cancelled";
+            case Reason::DeadlineExceeded: return "deadline exceeded";
+        }
+        return "unknown";
+    }
+
+    /**
+     * Poll a possibly absent token
+     */
+    static bool stopRequested(const CancelToken* token) { return token && token->stopRequested(); }
+
+private:
+    // Signed, so a negative timeout compares as already past
+    static int64_t nowNs() { return static_cast<int64_t>(Tracer::nowNs()); }
+
+    void stop(Reason reason) const {
+        uint8_t expected = static_cast<uint8_t>(Reason::None);
+        state.compare_exchange_strong(expected, static_cast<uint8_t>(reason), std::memory_order_relaxed);
+    }
+
+    mutable std::atomic<uint8_t> state{static_cast<uint8_t>(Reason::None)};
+    std::atomic<int64_t> deadlineNs{0};  // steady_clock nanoseconds, 0 = no deadline
+};
+
+#endif // CANCEL_TOKEN_HPP
@@ -0,0 +1,104 @@
+#ifndef TASK_SCHEDULER_HPP
+#define TASK_SCHEDULER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "packet_inspection/sched/victim_picker.hpp"
+#include "packet_inspection/sched/work_stealing_deque.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * TaskScheduler: Work-stealing task pool
+ * - Every worker owns a WorkStealingDeque; tasks it spawns go to its own
+ *   deque and are run newest-first
+ * - A worker whose deque is empty steals the oldest task of a randomly
+ *   chosen victim, so a worker stuck on one heavy task (a jumbo payload)
+ *   sheds the rest of its queue to idle workers
+ * - run() hands the root tasks out round-robin, which is the static split;
+ *   stealing corrects it when task costs turn out uneven
+ *
+ * Counters (tasks, steals, busy time) accumulate over runs and are read
+ * with statsJson(). run() must not be called concurrently on one instance.
+ */
+class TaskScheduler {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @param workers Worker threads per run (0 = hardware concurrency)
+     * @param dequeCapacity Tasks each worker can queue before spawn() runs tasks inline
+     */
+    explicit TaskScheduler(unsigned workers = 0, size_t dequeCapacity = 4096);
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /**
+     * Run tasks to completion on the worker threads
+     * Returns when the roots and everything they spawned have finished.
+     * @param roots Initial tasks
+     */
+    void run(std::vector<Task> roots);
+
+    /**
+     * Queue a task on the calling worker's deque
+     * Called from inside a task; outside a run, or with a full deque, the
+     * task runs immediately on the calling thread.
+     */
+    void spawn(Task task);
+
+    /**
+     * Index of the calling worker thread
+     * @return 0..workerCount()-1 inside a task of any scheduler, -1 elsewhere
+     */
+    static int currentWorker();
+
+    unsigned workerCount() const { return workers; }
+
+    /**
+     * Counters accumulated over all runs
+     * @return {"workers", "runs", "tasks", "steals", "failedSteals", "utilization", "perWorker": [...]}
+     */
+    json statsJson() const;
+
+private:
+    /**
+     * Counters of one worker; written only by that worker's thread
+     */
+    struct alignas(64) WorkerStats {
+        std::atomic<uint64_t> tasks{0};         // Tasks executed
+        std::atomic<uint64_t> spawned{0};       // Tasks queued from inside tasks
+        std::atomic<uint64_t> steals{0};        // Tasks taken from another worker
+        std::atomic<uint64_t> failedSteals{0};  // Steal attempts that found nothing
+        std::atomic<uint64_t> inlineRuns{0};    // Spawns run at once because the deque was full
+        std::atomic<uint64_t> busyNs{0};        // Time inside tasks
+    };
+
+    struct Worker {
+        std::unique_ptr<WorkStealingDeque<Task*>> deque;  // Empty between runs; replaced if too small for the roots
+        WorkerStats stats;
+        VictimPicker victims;
+    };
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    void workerLoop(unsigned index);
+    bool trySteal(unsigned thief, Task*& task);
+    void execute(unsigned index, Task* task);
+
+    unsigned workers;
+    size_t dequeCapacity;
+    std::vector<std::unique_ptr<Worker>> pool;
+    std::atomic<size_t> pending{0};              // Queued or running tasks of the current run
+    std::atomic<uint64_t> runs{0};
+    std::atomic<uint64_t> wallNs{0};             // Summed duration of all runs
+};
+
+#endif // TASK_SCHEDULER_HPP
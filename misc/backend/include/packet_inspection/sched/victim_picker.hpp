@@ -0,0 +1,44 @@
+#ifndef VICTIM_PICKER_HPP
+#define VICTIM_PICKER_HPP
+
+#include <cstdint>
+
+/**
+ * VictimPicker: Random steal victims for one thief
+ * - xorshift64 state of its own per thief, so picking touches no shared data
+ * - Seeded from the thief index, so runs are repeatable
+ * - Never picks the thief itself; needs at least two workers
+ */
+class VictimPicker {
+public:
+    VictimPicker() = default;
+
+    /**
+     * @param thief Index of the stealing worker
+     * @param workers Number of workers (2 or more)
+     */
+    VictimPicker(unsigned thief, unsigned workers)
+        : state(0x9e3779b97f4a7c15ull * (thief + 1)), thief(thief), workers(workers) {}
+
+    /**
+     * Pick the next victim
+     * @return Worker index other than the thief
+     */
+    unsigned next() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        unsigned victim = static_cast<unsigned>(state % (workers - 1));
+        if (victim >= thief) {
+            ++victim;
+        }
+        return victim;
+    }
+
+private:
+    uint64_t state = 0x9e3779b97f4a7c15ull;
+    unsigned thief = 0;
+    unsigned workers = 2;
+};
+
+#endif // VICTIM_PICKER_HPP
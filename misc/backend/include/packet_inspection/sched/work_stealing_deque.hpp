@@ -0,0 +1,117 @@
+#ifndef WORK_STEALING_DEQUE_HPP
+#define WORK_STEALING_DEQUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+/**
+ * WorkStealingDeque: Bounded Chase-Lev deque
+ * - The owning thread pushes and pops at the bottom (LIFO, stays cache-warm)
+ * - Any other thread steals from the top (FIFO, takes the oldest and
+ *   usually largest piece of work)
+ * - Only the owner/thief race on the last item goes through a CAS; plain
+ *   pushes and pops are a few loads and stores
+ * - Capacity is rounded up to a power of two and does not grow: push()
+ *   reports a full deque and the caller runs the work itself
+ *
+ * Memory orderings follow Le, Pop, Cohen, Zappa Nardelli, "Correct and
+ * Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+ * T must be trivially copyable (indices or pointers).
+ */
+template <typename T>
+class WorkStealingDeque {
+    static_assert(std::is_trivially_copyable<T>::value, "WorkStealingDeque holds trivially copyable items");
+
+public:
+    explicit WorkStealingDeque(size_t capacity) {
+        size_t rounded = 2;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        slots = std::make_unique<std::atomic<T>[]>(rounded);
+        mask = rounded - 1;
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    /**
+     * Add an item at the bottom (owner only)
+     * @return false if the deque is full
+     */
+    bool push(T item) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        if (b - t > static_cast<int64_t>(mask)) {
+            return false;
+        }
+        slots[b & mask].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Take the newest item (owner only)
+     * @return false if the deque is empty or a thief took the last item
+     */
+    bool pop(T& out) {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        out = slots[b & mask].load(std::memory_order_relaxed);
+        if (t < b) {
+            return true;
+        }
+        // Last item: race the thieves for it
+        bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+
+    /**
+     * Take the oldest item (any thread)
+     * @return false if the deque is empty or another thread got there first
+     */
+    bool steal(T& out) {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return false;
+        }
+        T item = slots[t & mask].load(std::memory_order_relaxed);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return false;
+        }
+        out = item;
+        return true;
+    }
+
+    /**
+     * Items currently queued (approximate while other threads work on it)
+     */
+    size_t size() const {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    alignas(64) std::atomic<int64_t> top{0};
+    alignas(64) std::atomic<int64_t> bottom{0};
+    alignas(64) std::unique_ptr<std::atomic<T>[]> slots;
+    size_t mask = 0;
+};
+
+#endif // WORK_STEALING_DEQUE_HPP
@@ -0,0 +1,95 @@
+#ifndef SHARED_AUTOMATON_HPP
+#define SHARED_AUTOMATON_HPP
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include "packet_inspection/engine/ac_table_matcher.hpp"
+
+/**
+ * SharedAutomaton: Compiled ac-table image in POSIX shared memory
+ * - One loader process publishes; any number of server processes map the
+ *   same physical pages read-only instead of building their own copy
+ * - Segments: "/pktinspect.<name>" is a small control block holding the
+ *   current generation; "/pktinspect.<name>.<generation>" holds one
+ *   immutable image plus the pattern table it was built from
+ * - Publishing writes a new generation segment, then bumps the control
+ *   generation (release store) and unlinks the previous segment; processes
+ *   that still map it keep using it until they switch, so handover never
+ *   blocks a scan
+ * - A single publisher per name is assumed
+ */
+class SharedAutomaton {
+public:
+    /**
+     * Publish a compiled automaton as the next generation
+     * @param name Segment name (letters, digits, '-', '_', '.')
+     * @param matcher Compiled automaton
+     * @return New generation, or 0 on failure
+     */
+    static uint64_t publish(const std::string& name, const AcTableMatcher& matcher);
+
+    /**
+     * Map the current generation read-only
+     * @param name Segment name
+     * @param generation Output: generation that was mapped
+     * @return Matcher over the mapped image, or nullptr if none is published or it is invalid
+     */
+    static std::shared_ptr<const AcTableMatcher> attach(const std::string& name, uint64_t* generation = nullptr);
+
+    /**
+     * Read the current generation
+     * @param name Segment name
+     * @return Generation, 0 if nothing is published
+     */
+    static uint64_t currentGeneration(const std::string& name);
+
+    /**
+     * Unlink the control block and the current generation
+     * @param name Segment name
+     * @return true if anything was removed
+     */
+    static bool remove(const std::string& name);
+};
+
+/**
+ * SharedAutomatonClient: Worker-side handle that follows the publisher
+ * - Keeps the control block mapped, so checking for a new generation is one
+ *   atomic load
+ * - current() re-attaches when the generation changed; callers hold the
+ *   returned shared_ptr for the duration of a scan
+ */
+class SharedAutomatonClient {
+public:
+    explicit SharedAutomatonClient(std::string name);
+    ~SharedAutomatonClient();
+
+    SharedAutomatonClient(const SharedAutomatonClient&) = delete;
+    SharedAutomatonClient& operator=(const SharedAutomatonClient&) = delete;
+
+    /**
+     * Get the newest published matcher
+     * @return Matcher, or nullptr if nothing was published yet
+     */
+    std::shared_ptr<const AcTableMatcher> current();
+
+    /**
+     * Get the generation of the matcher returned by current()
+     * @return Generation, 0 if none
+     */
+    uint64_t attachedGeneration() const;
+
+    const std::string& getName() const { return name; }
+
+private:
+    bool mapControl();
+
+    std::string name;
+    void* control = nullptr;
+    mutable std::mutex mutex;
+    std::shared_ptr<const AcTableMatcher> matcher;
+    uint64_t generation = 0;
+};
+
+#endif // SHARED_AUTOMATON_HPP
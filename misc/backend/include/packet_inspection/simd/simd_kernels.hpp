@@ -0,0 +1,107 @@
+#ifndef SIMD_KERNELS_HPP
+#define SIMD_KERNELS_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Set of byte values for the skip-scan kernel
+ * Holds a plain bitmap for scalar code and the two nibble tables used by the
+ * SIMD "truffle" lookup, which tests membership of any 256-value set with two
+ * byte shuffles per vector.
+ */
+struct ByteSet {
+    uint64_t bits[4] = {0, 0, 0, 0};
+    alignas(16) uint8_t nibbleMaskLo[16] = {};  // Bytes 0x00-0x7f, by low nibble
+    alignas(16) uint8_t nibbleMaskHi[16] = {};  // Bytes 0x80-0xff, by low nibble
+
+    /**
+     * Add a byte value to the set
+     * @param byte Value to add
+     */
+    void add(uint8_t byte);
+
+    /**
+     * Check if a byte value is in the set
+     * @param byte Value to test
+     * @return true if present
+     */
+    bool contains(uint8_t byte) const { return (bits[byte >> 6] >> (byte & 63)) & 1; }
+
+    /**
+     * Check if the set is empty
+     * @return true if no byte was added
+     */
+    bool empty() const { return (bits[0] | bits[1] | bits[2] | bits[3]) == 0; }
+};
+
+/**
+ * ISA levels the hot kernels are compiled for
+ */
+enum class SimdVariant {
+    Scalar,
+    SSE42,
+    AVX2,
+    AVX512
+};
+
+/**
+ * Table of hot kernels for one ISA level
+ */
+struct SimdKernels {
+    SimdVariant variant;
+    const char* name;
+
+    /**
+     * Scan/prefilter kernel: position of the first byte that is in the set
+     * Returns length if no byte matches
+     */
+    size_t (*findFirstOf)(const uint8_t* data, size_t length, const ByteSet& set);
+
+    /**
+     * ASCII case folding (A-Z -> a-z), in and out may alias
+     */
+    void (*foldCase)(const uint8_t* in, uint8_t* out, size_t length);
+
+    /**
+     * Lowercase hex encoding, writes exactly 2 * length chars to out
+     */
+    void (*hexEncode)(const uint8_t* in, size_t length, char* out);
+};
+
+/**
+ * CpuDispatch: Picks the kernel variant once per process
+ * - Detects the best supported variant with cpuid
+ * - PKTINSPECT_SIMD=scalar|sse42|avx2|avx512 overrides the choice (for testing);
+ *   a variant the CPU cannot run falls back to the best supported one
+ */
+class CpuDispatch {
+public:
+    /**
+     * Get the selected kernels (selected on first call)
+     * @return Kernel table
+     */
+    static const SimdKernels& kernels();
+
+    /**
+     * Get kernels for a specific variant
+     * @param variant ISA level
+     * @return Kernel table, or nullptr if not built in or not supported by this CPU
+     */
+    static const SimdKernels* kernelsFor(SimdVariant variant);
+
+    /**
+     * Detect the best variant supported by this CPU and build
+     * @return ISA level
+     */
+    static SimdVariant bestSupported();
+
+    /**
+     * Get the printable name of a variant
+     * @param variant ISA level
+     * @return Name as accepted by PKTINSPECT_SIMD
+     */
+    static const char* variantName(SimdVariant variant);
+};
+
+#endif // SIMD_KERNELS_HPP
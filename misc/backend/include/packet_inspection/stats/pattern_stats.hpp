@@ -0,0 +1,156 @@
+#ifndef PATTERN_STATS_HPP
+#define PATTERN_STATS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "packet_inspection/engine/pattern_hit.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * PatternStats: Per-pattern hit counters for one pattern list
+ * - Every scanning thread owns a shard of cache-line aligned counters and is
+ *   its only writer, so record() is plain loads and stores (no lock prefix)
+ * - Readers sum the shards; totals may lag a concurrent record() by one scan
+ * - When a thread exits its shard is folded into the retired counts and
+ *   freed, so short-lived threads do not leave shards behind. Do not
+ *   record() from a thread_local destructor
+ * - sample() keeps a short history of totals so rates over sliding windows
+ *   can be reported without touching the hot path
+ *
+ * Counters belong to the instance: a new pattern list gets a new PatternStats.
+ */
+class PatternStats {
+public:
+    /**
+     * Aggregated counters at one point in time
+     */
+    struct Snapshot {
+        uint64_t timeNs = 0;
+        uint64_t scans = 0;
+        uint64_t bytes = 0;
+        std::vector<uint64_t> hits;  // Indexed by pattern id
+    };
+
+    /**
+     * @param patterns Pattern strings, indexed like the PatternHit ids that will be recorded
+     * @param historyLength Samples kept for rate windows (window span = length x sample interval)
+     */
+    explicit PatternStats(std::vector<std::string> patterns, size_t historyLength = 151);
+
+    PatternStats(const PatternStats&) = delete;
+    PatternStats& operator=(const PatternStats&) = delete;
+
+    /**
+     * Count one scan and its hits on the calling thread's shard
+     * @param hits Hits reported by the scan
+     * @param count Number of hits
+     * @param bytes Bytes scanned
+     */
+    void record(const PatternHit* hits, size_t count, size_t bytes) {
+        Shard& shard = localShard();
+        bump(shard.scans, 1);
+        bump(shard.bytes, bytes);
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t id = hits[i].patternId;
+            bump(shard.lines[id / COUNTERS_PER_LINE].counts[id % COUNTERS_PER_LINE], 1);
+        }
+    }
+
+    void record(const std::vector<PatternHit>& hits, size_t bytes) { record(hits.data(), hits.size(), bytes); }
+
+    /**
+     * Count a batch of scans at once (BatchHits::patternId column)
+     * @param patternIds Pattern id of every hit in the batch
+     * @param count Number of hits
+     * @param scans Packets scanned
+     * @param bytes Bytes scanned
+     */
+    void recordBatch(const uint32_t* patternIds, size_t count, size_t scans, size_t bytes) {
+        Shard& shard = localShard();
+        bump(shard.scans, scans);
+        bump(shard.bytes, bytes);
+        for (size_t i = 0; i < count; ++i) {
+            uint32_t id = patternIds[i];
+            bump(shard.lines[id / COUNTERS_PER_LINE].counts[id % COUNTERS_PER_LINE], 1);
+        }
+    }
+
+    /**
+     * Sum all shards
+     * @return Current totals stamped with the current time
+     */
+    Snapshot totals() const;
+
+    /**
+     * Append the current totals to the rate history (called periodically, e.g. once a second)
+     */
+    void sample();
+
+    /**
+     * Export totals and per-window rates
+     * @param windowsSeconds Window lengths; windows longer than the history use all of it
+     * @param top Keep only the N patterns with the most hits (0 = every pattern, including unhit ones)
+     * @return {"scans", "bytes", "uptimeSeconds", "windows": [...], "patterns": [...]}
+     */
+    json toJson(const std::vector<uint32_t>& windowsSeconds, size_t top) const;
+
+    /**
+     * Get the pattern list the counters are indexed by
+     */
+    const std::vector<std::string>& getPatterns() const { return patterns; }
+
+private:
+    static const size_t COUNTERS_PER_LINE = 8;
+
+    struct alignas(64) CounterLine {
+        std::atomic<uint64_t> counts[COUNTERS_PER_LINE] = {};
+    };
+
+    struct alignas(64) Shard {
+        std::thread::id owner;
+        std::atomic<uint64_t> scans{0};
+        std::atomic<uint64_t> bytes{0};
+        std::vector<CounterLine> lines;
+    };
+
+    // Single writer per shard: a relaxed load/store pair is enough and avoids a locked add
+    static void bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    Shard& localShard() {
+        thread_local uint64_t cachedSerial = 0;
+        thread_local Shard* cachedShard = nullptr;
+        if (cachedSerial != serial) {
+            cachedShard = &registerShard();
+            cachedSerial = serial;
+        }
+        return *cachedShard;
+    }
+
+    Shard& registerShard();
+
+    std::vector<std::string> patterns;
+    const uint64_t serial;     // Unique per instance, so a reused address never hits a stale cache
+    const uint64_t createdNs;
+    const size_t historyLength;
+
+    struct Shards;
+    struct ShardOwner;
+
+    std::shared_ptr<Shards> shards;  // Shared with the ShardOwner of each writing thread
+
+    mutable std::mutex historyMutex;
+    std::vector<Snapshot> history;  // Ring of historyLength samples
+    size_t historyNext = 0;
+};
+
+#endif // PATTERN_STATS_HPP
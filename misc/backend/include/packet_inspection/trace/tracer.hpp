@@ -0,0 +1,108 @@
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+/**
+ * Tracer: Scoped spans recorded into per-thread ring buffers
+ * - Each thread writes only its own ring (no locks on the hot path)
+ * - Rings keep the most recent TRACE_RING_CAPACITY spans per thread
+ * - The ring of an exited thread is freed once its spans are exported with
+ *   clear; at most 64 such rings are kept, the oldest are dropped first
+ * - Exported as Chrome trace JSON, which Perfetto and chrome://tracing open
+ *
+ * Spans are placed with PI_TRACE_SCOPE(name); they compile to nothing unless
+ * the build defines PKTINSPECT_TRACING (CMake option PKTINSPECT_TRACING).
+ * When compiled in, recording is still off until setEnabled(true) or
+ * PKTINSPECT_TRACE=1 in the environment.
+ */
+class Tracer {
+public:
+    static const size_t TRACE_RING_CAPACITY = 16384;
+
+    /**
+     * Check if span recording is on (one relaxed load)
+     * @return true if enabled
+     */
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * Turn span recording on or off
+     * @param on New state
+     */
+    static void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+
+    /**
+     * Check if spans were compiled into this build
+     * @return true if built with PKTINSPECT_TRACING
+     */
+    static bool isCompiledIn();
+
+    /**
+     * Current monotonic time in nanoseconds
+     */
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /**
+     * Record a finished span on the calling thread's ring
+     * @param name Span name (must be a string literal or otherwise outlive the tracer)
+     * @param startNs Start time from nowNs()
+     * @param endNs End time from nowNs()
+     * @param arg Optional numeric argument (bytes, packets, ...)
+     */
+    static void record(const char* name, uint64_t startNs, uint64_t endNs, uint64_t arg);
+
+    /**
+     * Export all rings in Chrome trace event format
+     * @param clear Drop exported spans afterwards
+     * @return {"traceEvents": [...]} JSON
+     */
+    static json exportChromeTrace(bool clear);
+
+private:
+    static std::atomic<bool> enabled;
+};
+
+/**
+ * TraceScope: RAII span, records its lifetime when tracing is enabled
+ */
+class TraceScope {
+public:
+    explicit TraceScope(const char* name, uint64_t arg = 0)
+        : name(name), arg(arg), startNs(Tracer::isEnabled() ? Tracer::nowNs() : 0) {}
+
+    ~TraceScope() {
+        if (startNs != 0) {
+            Tracer::record(name, startNs, Tracer::nowNs(), arg);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t arg;
+    uint64_t startNs;
+};
+
+#define PI_TRACE_CONCAT_INNER(a, b) a##b
+#define PI_TRACE_CONCAT(a, b) PI_TRACE_CONCAT_INNER(a, b)
+
+#ifdef PKTINSPECT_TRACING
+#define PI_TRACE_SCOPE(name) TraceScope PI_TRACE_CONCAT(piTraceScope, __LINE__)(name)
+#define PI_TRACE_SCOPE_ARG(name, arg) TraceScope PI_TRACE_CONCAT(piTraceScope, __LINE__)(name, arg)
+#else
+#define PI_TRACE_SCOPE(name) ((void)0)
+#define PI_TRACE_SCOPE_ARG(name, arg) ((void)0)
+#endif
+
+#endif // TRACER_HPP
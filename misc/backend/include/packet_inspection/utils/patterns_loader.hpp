@@ -18,10 +18,14 @@ public:
 
     /**
      * Load patterns from JSON file
+     * An entry is a pattern string, or {"pattern": "...", "field": "uri"} to
+     * aim it at one part of an HTTP message (see FieldTarget::parse())
      * @param filePath Path to patterns.json
+     * @param fields If given, receives category -> field of each pattern ("" when not set), in pattern order
      * @return Map of category -> vector of patterns
      */
-    static std::map<std::string, std::vector<std::string>> loadPatterns(const std::string& filePath);
+    static std::map<std::string, std::vector<std::string>> loadPatterns(
+        const std::string& filePath, std::map<std::string, std::vector<std::string>>* fields = nullptr);
 
     /**
      * Flatten all patterns into a single vector
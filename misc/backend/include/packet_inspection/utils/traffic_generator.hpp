@@ -0,0 +1,77 @@
+#ifndef TRAFFIC_GENERATOR_HPP
+#define TRAFFIC_GENERATOR_HPP
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <random>
+
+/**
+ * Shape of the synthetic traffic
+ */
+struct TrafficProfile {
+    size_t packetCount = 10000;
+    uint32_t minPayload = 64;
+    uint32_t maxPayload = 1460;
+    double attackRate = 0.05;   // Fraction of packets with an injected pattern
+    uint32_t flowCount = 64;    // Distinct TCP connections packets are spread over
+};
+
+/**
+ * A generated packet: TCP payload plus its connection 5-tuple
+ */
+struct GeneratedPacket {
+    std::string payload;
+    uint32_t srcIp;
+    uint32_t dstIp;
+    uint16_t srcPort;
+    uint16_t dstPort;
+};
+
+/**
+ * TrafficGenerator: Deterministic synthetic HTTP-like traffic for benchmarks
+ * - Mixes HTTP requests, text, form bodies and binary data
+ * - Injects patterns (with random letter case) into a fraction of packets
+ * - Writes raw-IP captures that PacketReader can read back
+ */
+class TrafficGenerator {
+public:
+    explicit TrafficGenerator(uint32_t seed = 42) : rng(seed) {}
+
+    /**
+     * Generate packets
+     * @param profile Traffic shape
+     * @param patterns Patterns to inject
+     * @return Generated packets
+     */
+    std::vector<GeneratedPacket> generate(const TrafficProfile& profile,
+                                          const std::vector<std::string>& patterns);
+
+    /**
+     * Generate a single payload
+     * @param length Payload length
+     * @return Payload bytes
+     */
+    std::string generatePayload(uint32_t length);
+
+    /**
+     * Built-in signature set, used when no patterns.json is given
+     * @return Patterns in the style of patterns.json
+     */
+    static std::vector<std::string> defaultPatterns();
+
+    /**
+     * Write packets to a PCAP file (LINKTYPE_RAW, IPv4/TCP)
+     * @param path Output path
+     * @param packets Packets to write
+     * @return true on success
+     */
+    static bool writePcap(const std::string& path, const std::vector<GeneratedPacket>& packets);
+
+private:
+    std::mt19937 rng;
+
+    void appendText(std::string& out, size_t length);
+};
+
+#endif // TRAFFIC_GENERATOR_HPP
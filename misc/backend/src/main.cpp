@@ -1,10 +1,13 @@
 #include <iostream>
+#include <cstdlib>
 #include <string>
 #include <memory>
 #include <map>
 #include <vector>
 #include <thread>
 #include <mutex>
+#include <algorithm>
+#include <chrono>
 #include <crow_all.hpp>
 #include <nlohmann/json.hpp>
 
@@ -12,18 +15,247 @@
 #include "packet_inspection/ac/aho_corasick.hpp"
 #include "packet_inspection/dfa/dfa_builder.hpp"
 #include "packet_inspection/utils/patterns_loader.hpp"
+#include "packet_inspection/simd/simd_kernels.hpp"
+#include "packet_inspection/perf/perf_counters.hpp"
+#include "packet_inspection/trace/tracer.hpp"
+#include "packet_inspection/engine/matcher_selector.hpp"
+#include "packet_inspection/shm/shared_automaton.hpp"
+#include "packet_inspection/stats/pattern_stats.hpp"
+#include "packet_inspection/pipeline/packet_pipeline.hpp"
+#include "packet_inspection/sched/cancel_token.hpp"
+#include "packet_inspection/engine/scan_arena.hpp"
+#include "packet_inspection/http/http_scanner.hpp"
+#include "packet_inspection/http/field_scoped_matcher.hpp"
 
 using json = nlohmann::json;
 
 // Global instances
 std::map<std::string, std::vector<std::string>> g_patterns;
 AhoCorasick g_acAutomaton;
+std::shared_ptr<const Matcher> g_matcher;  // Engine picked by MatcherSelector for bulk scans
+std::vector<EngineTiming> g_engineTimings;
 DFABuilder g_dfaBuilder;
+bool g_visualAutomataBuilt = false;  // g_acAutomaton / g_dfaBuilder, built on first use when attached
+std::vector<std::string> g_flatPatterns;
+std::shared_ptr<const AcTableMatcher> g_httpTable;  // /scan "normalize" when the bulk engine is another one
 std::mutex g_dataMutex;
 
+// Multi-process mode: PKTINSPECT_SHM_PUBLISH=<name> builds and publishes the bulk
+// automaton, PKTINSPECT_SHM_ATTACH=<name> maps the published one instead of building
+const char* g_shmPublishName = std::getenv("PKTINSPECT_SHM_PUBLISH");
+const char* g_shmAttachName = std::getenv("PKTINSPECT_SHM_ATTACH");
+std::unique_ptr<SharedAutomatonClient> g_shmClient;
+uint64_t g_publishedGeneration = 0;
+
+// Per-pattern hit counters for bulk scans, replaced when the matcher's pattern set changes
+std::shared_ptr<PatternStats> g_patternStats;
+std::shared_ptr<const PatternSet> g_statsPatternSet;
+std::mutex g_statsMutex;
+const std::vector<uint32_t> STATS_WINDOWS_SECONDS = {10, 60, 300};
+const unsigned STATS_SAMPLE_SECONDS = 2;
+
+// Most recent /scan-pcap pipeline, for GET /pipeline (live while it runs)
+std::shared_ptr<PacketPipeline> g_lastPipeline;
+std::mutex g_pipelineMutex;
+
+// Running /scan-pcap requests by scan id, for POST /scan-pcap/cancel
+std::multimap<std::string, std::shared_ptr<CancelToken>> g_activeScans;
+std::mutex g_scansMutex;
+uint64_t g_nextScanId = 1;  // Guarded by g_scansMutex
+
+// Default /scan-pcap deadline in ms (PKTINSPECT_SCAN_DEADLINE_MS, 0 = none)
+const uint64_t g_scanDeadlineMs = std::getenv("PKTINSPECT_SCAN_DEADLINE_MS")
+    ? std::strtoull(std::getenv("PKTINSPECT_SCAN_DEADLINE_MS"), nullptr, 10) : 0;
+
+/**
+ * Registers a request's cancel token for its lifetime
+ */
+class ActiveScan {
+public:
+    explicit ActiveScan(const char* requestedId) : token(std::make_shared<CancelToken>()) {
+        std::lock_guard<std::mutex> lock(g_scansMutex);
+        id = requestedId && *requestedId ? requestedId : "scan-" + std::to_string(g_nextScanId++);
+        entry = g_activeScans.emplace(id, token);
+    }
+
+    ~ActiveScan() {
+        std::lock_guard<std::mutex> lock(g_scansMutex);
+        g_activeScans.erase(entry);
+    }
+
+    ActiveScan(const ActiveScan&) = delete;
+    ActiveScan& operator=(const ActiveScan&) = delete;
+
+    const std::string& getId() const { return id; }
+    CancelToken& getToken() { return *token; }
+
+private:
+    std::string id;
+    std::shared_ptr<CancelToken> token;
+    std::multimap<std::string, std::shared_ptr<CancelToken>>::iterator entry;
+};
+
 const std::string PATTERNS_FILE = "backend/pcap/patterns.json";
+const size_t ARENA_KEEP_BYTES = 64u << 20;  // Result arena a server thread may keep between /scan-pcap requests
 const int SERVER_PORT = 8080;
 
+// Opt-in hardware counters around engine calls (PKTINSPECT_PERF_COUNTERS=1)
+const bool g_perfCountersEnabled = std::getenv("PKTINSPECT_PERF_COUNTERS")
+    && std::atoi(std::getenv("PKTINSPECT_PERF_COUNTERS")) != 0;
+PerfCounts g_scanCounts;
+uint64_t g_scanBytes = 0;
+uint64_t g_scanPackets = 0;
+std::mutex g_perfMutex;
+
+/**
+ * Run an engine call over bytes of input, counting hardware events when enabled
+ */
+template <typename ScanFn>
+auto countedScan(size_t bytes, ScanFn&& scan) -> decltype(scan()) {
+    if (!g_perfCountersEnabled) {
+        return scan();
+    }
+
+    // perf_event_open counts the calling thread, so each server thread has its own group
+    thread_local PerfCounters counters;
+    thread_local bool opened = counters.open();
+
+    PerfCounts counts;
+    decltype(scan()) result;
+    {
+        PerfScope scope(counters, counts);
+        result = scan();
+    }
+
+    if (opened) {
+        std::lock_guard<std::mutex> lock(g_perfMutex);
+        g_scanCounts += counts;
+        g_scanBytes += bytes;
+        g_scanPackets++;
+    }
+    return result;
+}
+
+/**
+ * Matcher decorator for the bulk scan path: counts hardware events and
+ * per-pattern hits on whichever thread runs the scan
+ */
+class InstrumentedMatcher : public Matcher {
+public:
+    InstrumentedMatcher(std::shared_ptr<const Matcher> inner, std::shared_ptr<PatternStats> stats)
+        : Matcher(inner->sharedPatternSet()), inner(std::move(inner)), stats(std::move(stats)) {}
+
+    const char* name() const override { return inner->name(); }
+    size_t memoryUsage() const override { return inner->memoryUsage(); }
+
+    void scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const override {
+        size_t before = hits.size();
+        countedScan(length, [&]() {
+            inner->scan(data, length, hits);
+            return hits.size();
+        });
+        stats->record(hits.data() + before, hits.size() - before, length);
+    }
+
+private:
+    std::shared_ptr<const Matcher> inner;
+    std::shared_ptr<PatternStats> stats;
+};
+
+/**
+ * Get the hit counters for a matcher's pattern set
+ * A matcher built from another pattern list (reload, new shared generation) starts fresh counters
+ */
+std::shared_ptr<PatternStats> patternStatsFor(const Matcher& matcher) {
+    std::lock_guard<std::mutex> lock(g_statsMutex);
+    if (!g_patternStats || g_statsPatternSet.get() != &matcher.patternSet()) {
+        g_statsPatternSet = matcher.sharedPatternSet();
+        g_patternStats = std::make_shared<PatternStats>(g_statsPatternSet->all(),
+                                                        STATS_WINDOWS_SECONDS.back() / STATS_SAMPLE_SECONDS + 1);
+    }
+    return g_patternStats;
+}
+
+/**
+ * Build the trie and DFA behind /ac-trie, /dfa and /scan (caller holds g_dataMutex)
+ */
+void ensureVisualAutomata() {
+    if (g_visualAutomataBuilt) {
+        return;
+    }
+    // Hotspot profiling of the trie from startup: PKTINSPECT_AC_PROFILE=<sample one scan in N>
+    static const char* profileEnv = std::getenv("PKTINSPECT_AC_PROFILE");
+    if (profileEnv && !g_acAutomaton.isProfiling()) {
+        g_acAutomaton.enableProfiling(static_cast<uint32_t>(std::strtoul(profileEnv, nullptr, 10)));
+    }
+    g_acAutomaton.buildFromPatterns(g_flatPatterns);
+    g_dfaBuilder.buildFromPatterns(g_flatPatterns);
+    g_visualAutomataBuilt = true;
+}
+
+/**
+ * Get the matcher for bulk scans
+ * Attached servers follow the published generation; a scan keeps the
+ * returned matcher alive even if a newer one is published meanwhile
+ */
+std::shared_ptr<const Matcher> activeMatcher() {
+    if (g_shmClient) {
+        if (auto shared = g_shmClient->current()) {
+            return shared;
+        }
+    }
+    std::lock_guard<std::mutex> lock(g_dataMutex);
+    return g_matcher;
+}
+
+/**
+ * Get a DFA table for resumable HTTP field scans over the active pattern set
+ * Reuses the bulk matcher when it is ac-table; must not be called with g_dataMutex held
+ */
+std::shared_ptr<const AcTableMatcher> httpMatcher() {
+    std::shared_ptr<const Matcher> matcher = activeMatcher();
+    if (auto table = std::dynamic_pointer_cast<const AcTableMatcher>(matcher)) {
+        return table;
+    }
+    std::lock_guard<std::mutex> lock(g_dataMutex);
+    if (!g_httpTable || &g_httpTable->patternSet() != &matcher->patternSet()) {
+        g_httpTable = std::make_shared<const AcTableMatcher>(matcher->sharedPatternSet());
+    }
+    return g_httpTable;
+}
+
+/**
+ * Flatten the patterns that apply to the whole payload
+ * The server's scans do not split payloads into HTTP fields, so a pattern
+ * scoped to a field would match anywhere; those are left out (pktscan --http
+ * scans them) rather than reported where they do not apply
+ * @param patternMap Map of category -> patterns
+ * @param fields Category -> field of each pattern, as loadPatterns() gives it
+ * @return Payload-wide patterns
+ */
+std::vector<std::string> payloadWidePatterns(const std::map<std::string, std::vector<std::string>>& patternMap,
+                                             const std::map<std::string, std::vector<std::string>>& fields) {
+    std::vector<std::string> flat;
+    size_t skipped = 0;
+    for (const auto& [category, list] : patternMap) {
+        auto categoryFields = fields.find(category);
+        for (size_t i = 0; i < list.size(); ++i) {
+            FieldTarget target;
+            if (categoryFields != fields.end() && i < categoryFields->second.size() &&
+                FieldTarget::parse(categoryFields->second[i], target) && target.scoped()) {
+                skipped++;
+                continue;
+            }
+            flat.push_back(list[i]);
+        }
+    }
+    if (skipped > 0) {
+        fprintf(stderr, "Warning: Skipping %zu patterns scoped to HTTP fields; the server only scans whole payloads\n",
+                skipped);
+    }
+    return flat;
+}
+
 /**
  * Initialize automata from patterns
  */
@@ -31,14 +263,51 @@ void initializeAutomata() {
     std::lock_guard<std::mutex> lock(g_dataMutex);
 
     // Load patterns from JSON
-    g_patterns = PatternsLoader::loadPatterns(PATTERNS_FILE);
-    std::vector<std::string> flatPatterns = PatternsLoader::flattenPatterns(g_patterns);
-
-    // Build automata
-    g_acAutomaton.buildFromPatterns(flatPatterns);
-    g_dfaBuilder.buildFromPatterns(flatPatterns);
-
-    printf("Initialized automata with %zu patterns\n", flatPatterns.size());
+    std::map<std::string, std::vector<std::string>> fields;
+    g_patterns = PatternsLoader::loadPatterns(PATTERNS_FILE, &fields);
+    g_flatPatterns = payloadWidePatterns(g_patterns, fields);
+    auto patternSet = std::make_shared<const PatternSet>(g_flatPatterns);
+
+    // Attached servers map the bulk automaton and build the visual ones lazily
+    g_visualAutomataBuilt = false;
+    if (!g_shmAttachName) {
+        ensureVisualAutomata();
+    }
+
+    g_engineTimings.clear();
+    if (g_shmAttachName) {
+        if (!g_shmClient) {
+            g_shmClient = std::make_unique<SharedAutomatonClient>(g_shmAttachName);
+        }
+        if (!g_shmClient->current()) {
+            fprintf(stderr, "Error: Nothing published as %s yet, building a local automaton\n", g_shmAttachName);
+            g_matcher = std::make_shared<const AcTableMatcher>(patternSet);
+        }
+    } else if (g_shmPublishName) {
+        // Shared images are ac-table layout, so the publisher uses that engine itself
+        auto table = std::make_shared<const AcTableMatcher>(patternSet);
+        g_publishedGeneration = SharedAutomaton::publish(g_shmPublishName, *table);
+        g_matcher = table;
+    } else {
+        g_matcher = MatcherSelector::select(patternSet, MatcherSelector::calibrationSample(*patternSet),
+                                            &g_engineTimings);
+    }
+
+    printf("Initialized automata with %zu patterns\n", g_flatPatterns.size());
+    for (const auto& timing : g_engineTimings) {
+        printf("  engine %-10s %.3f ns/byte, %zu bytes\n", timing.name.c_str(), timing.nsPerByte, timing.memoryBytes);
+    }
+    if (g_shmClient && g_shmClient->current()) {
+        printf("Attached shared automaton %s generation %llu\n", g_shmAttachName,
+               static_cast<unsigned long long>(g_shmClient->attachedGeneration()));
+    } else {
+        printf("Selected matcher engine: %s\n", g_matcher->name());
+    }
+    if (g_publishedGeneration) {
+        printf("Published shared automaton %s generation %llu\n", g_shmPublishName,
+               static_cast<unsigned long long>(g_publishedGeneration));
+    }
+    printf("SIMD kernels: %s\n", CpuDispatch::kernels().name);
 }
 
 int main() {
@@ -47,6 +316,14 @@ int main() {
     // Initialize automata on startup
     initializeAutomata();
 
+    // Rate history for /pattern-stats; sampling stays off the scan path
+    std::thread([]() {
+        for (;;) {
+            std::this_thread::sleep_for(std::chrono::seconds(STATS_SAMPLE_SECONDS));
+            patternStatsFor(*activeMatcher())->sample();
+        }
+    }).detach();
+
     /**
      * GET /patterns
      * Returns the patterns.json content
@@ -65,6 +342,7 @@ int main() {
     CROW_ROUTE(app, "/dfa").methods("GET"_method)
     ([]() {
         std::lock_guard<std::mutex> lock(g_dataMutex);
+        ensureVisualAutomata();
         json response = g_dfaBuilder.exportToJson();
         return crow::response(200, response.dump());
     });
@@ -72,11 +350,27 @@ int main() {
     /**
      * GET /ac-trie
      * Returns the Aho-Corasick trie in JSON format
+     * Query: profile=N profiles one scan in N (0 stops), reset=1 zeroes the
+     * profile, heatmap=1 adds per-node visit and fail-link counters
      */
     CROW_ROUTE(app, "/ac-trie").methods("GET"_method)
-    ([]() {
+    ([](const crow::request& req) {
         std::lock_guard<std::mutex> lock(g_dataMutex);
-        json response = g_acAutomaton.exportToJson();
+        ensureVisualAutomata();
+        if (const char* sampleEvery = req.url_params.get("profile")) {
+            uint32_t every = static_cast<uint32_t>(std::strtoul(sampleEvery, nullptr, 10));
+            if (every == 0) {
+                g_acAutomaton.disableProfiling();
+            } else {
+                g_acAutomaton.enableProfiling(every);
+            }
+        }
+        if (req.url_params.get("reset")) {
+            g_acAutomaton.resetProfile();
+        }
+
+        json response = req.url_params.get("heatmap") ? g_acAutomaton.exportHeatmapJson()
+                                                      : g_acAutomaton.exportToJson();
         return crow::response(200, response.dump());
     });
 
@@ -97,24 +391,21 @@ int main() {
             std::string payloadStr = json_body["payload"].s();
             bool isHex = json_body["isHex"].b();
             uint32_t packetId = json_body["packetId"].i();
+            bool normalize = json_body.has("normalize") && json_body["normalize"].b();
 
-            // Convert hex to string if needed
-            std::string textToScan = payloadStr;
-            std::string payloadHex = payloadStr;
+            // Decode hex payloads; the bytes alone are scanned
+            std::string textToScan;
+            std::string payloadHex;
             std::string payloadAscii;
 
             if (isHex) {
-                // Convert hex string to ASCII for scanning
-                payloadAscii.clear();
-                for (size_t i = 0; i < payloadStr.length(); i += 2) {
-                    if (i + 1 < payloadStr.length()) {
-                        std::string hexByte = payloadStr.substr(i, 2);
-                        char c = (char)std::stoi(hexByte, nullptr, 16);
-                        textToScan += c;
-                        payloadAscii += (std::isprint(c) ? c : '.');
-                    }
+                textToScan = PacketReader::hexToBytes(payloadStr);
+                payloadHex = payloadStr;
+                for (char c : textToScan) {
+                    payloadAscii += (std::isprint(static_cast<unsigned char>(c)) ? c : '.');
                 }
             } else {
+                textToScan = payloadStr;
                 payloadAscii = payloadStr;
                 // Convert ASCII to hex
                 for (char c : payloadStr) {
@@ -124,31 +415,60 @@ int main() {
                 }
             }
 
+            // The payload as one HTTP stream, fields normalized before matching
+            json normalizedMatches = json::array();
+            bool httpValid = false;
+            if (normalize) {
+                std::shared_ptr<const AcTableMatcher> table = httpMatcher();
+                HttpScanner http(table, HttpNormalizerConfig::fromEnvironment());
+                httpValid = http.feed(reinterpret_cast<const uint8_t*>(textToScan.data()), textToScan.size());
+                http.finish();
+                for (const HttpHit& hit : http.getHits()) {
+                    json m;
+                    m["pattern"] = table->patternSet().pattern(hit.patternId);
+                    m["field"] = httpFieldName(hit.field);
+                    m["message"] = hit.message;
+                    m["position"] = hit.position;
+                    normalizedMatches.push_back(m);
+                }
+            }
+
             std::lock_guard<std::mutex> lock(g_dataMutex);
-            ScanResult result = g_acAutomaton.scan(textToScan, packetId, payloadHex, payloadAscii);
+            ensureVisualAutomata();
+            ScanResult result = countedScan(textToScan.size(), [&]() {
+                return g_acAutomaton.scan(textToScan, packetId);
+            });
 
-            // Build response JSON
+            // Build response JSON (pattern ids resolve against the automaton, still locked)
             json response;
             response["packetId"] = result.packetId;
-            response["payloadHex"] = result.payloadHex;
-            response["payloadAscii"] = result.payloadAscii;
+            response["payloadHex"] = payloadHex;
+            response["payloadAscii"] = payloadAscii;
 
             json matches = json::array();
             for (const auto& match : result.matches) {
                 json m;
-                m["pattern"] = match.pattern;
+                m["pattern"] = g_acAutomaton.getPattern(match.patternId);
                 m["position"] = match.position;
                 matches.push_back(m);
             }
             response["matches"] = matches;
+            if (normalize) {
+                response["httpValid"] = httpValid;
+                response["normalizedMatches"] = normalizedMatches;
+            }
 
             json steps = json::array();
             for (const auto& step : result.steps) {
                 json s;
                 s["byte"] = step.byte;
-                s["char"] = std::string(1, step.character);
+                s["char"] = std::string(1, static_cast<char>(step.byte));
                 s["nodeId"] = step.nodeId;
-                s["outputs"] = step.outputs;
+                json outputs = json::array();
+                for (uint32_t patternId : *step.outputs) {
+                    outputs.push_back(g_acAutomaton.getPattern(patternId));
+                }
+                s["outputs"] = outputs;
                 steps.push_back(s);
             }
             response["steps"] = steps;
@@ -165,49 +485,97 @@ int main() {
      * POST /scan-pcap
      * Upload and scan a PCAP file
      * Body: multipart/form-data with file field
+     * ?deadlineMs=N stops the scan after N ms (default PKTINSPECT_SCAN_DEADLINE_MS);
+     * ?scanId=ID names it for POST /scan-pcap/cancel. A stopped scan answers
+     * 504 (deadline) or 503 (cancelled) instead of a partial result.
      */
     CROW_ROUTE(app, "/scan-pcap").methods("POST"_method)
     ([](const crow::request& req) {
+        PI_TRACE_SCOPE_ARG("scan-pcap.request", req.body.size());
+        ActiveScan scan(req.url_params.get("scanId"));
+        CancelToken& cancel = scan.getToken();
+        const char* deadlineParam = req.url_params.get("deadlineMs");
+        uint64_t deadlineMs = deadlineParam ? std::strtoull(deadlineParam, nullptr, 10) : g_scanDeadlineMs;
+        if (deadlineMs > 0) {
+            cancel.setTimeout(std::chrono::milliseconds(deadlineMs));
+        }
+        auto stoppedResponse = [&](size_t packetsScanned) {
+            CancelToken::Reason reason = cancel.reason();
+            json error;
+            error["error"] = std::string("scan ") + CancelToken::reasonName(reason);
+            error["scanId"] = scan.getId();
+            error["packetsScanned"] = packetsScanned;
+            return crow::response(reason == CancelToken::Reason::DeadlineExceeded ? 504 : 503, error.dump());
+        };
+
         try {
             // Simple PCAP file handling
             // In production, use proper multipart parsing
             std::string filename = "uploaded_packet.pcap";
-            std::ofstream out(filename, std::ios::binary);
-            out.write(req.body.c_str(), req.body.size());
-            out.close();
+            {
+                PI_TRACE_SCOPE("scan-pcap.store-upload");
+                std::ofstream out(filename, std::ios::binary);
+                out.write(req.body.c_str(), req.body.size());
+                out.close();
+            }
 
-            // Read PCAP file
-            PacketReader reader;
-            std::vector<Packet> packets = reader.readPcapFile(filename);
+            // One matcher for the whole upload, even if a reload swaps it meanwhile
+            std::shared_ptr<const Matcher> matcher = activeMatcher();
+            auto instrumented = std::make_shared<const InstrumentedMatcher>(matcher, patternStatsFor(*matcher));
+            auto pipeline = std::make_shared<PacketPipeline>(instrumented, PipelineConfig::fromEnvironment());
+            {
+                std::lock_guard<std::mutex> lock(g_pipelineMutex);
+                g_lastPipeline = pipeline;
+            }
 
-            json response = json::array();
-            for (const auto& packet : packets) {
+            // Bulk traffic also drives the trie heatmap while it is being profiled
+            bool profileTrie;
+            {
                 std::lock_guard<std::mutex> lock(g_dataMutex);
-                ScanResult result = g_acAutomaton.scan(
-                    packet.payloadAscii, 
-                    packet.packetId,
-                    packet.payloadHex,
-                    packet.payloadAscii
-                );
-
-                json pktResult;
-                pktResult["packetId"] = result.packetId;
-                pktResult["payloadHex"] = result.payloadHex;
-                pktResult["payloadAscii"] = result.payloadAscii;
-
-                json matches = json::array();
-                for (const auto& match : result.matches) {
-                    json m;
-                    m["pattern"] = match.pattern;
-                    m["position"] = match.position;
-                    matches.push_back(m);
+                profileTrie = g_acAutomaton.isProfiling();
+            }
+
+            // Reader, decoder and matcher stages run on their own threads; this
+            // callback is the sink and only records ids and positions. Payloads
+            // stay in the pipeline's capture buffer until the response is written.
+            thread_local ScanArena threadArena;
+            ScanArena& arena = threadArena;  // The sink thread must fill this thread's arena, not its own
+            arena.reset(matcher->sharedPatternSet());
+            pipeline->run(filename, [&](const PipelinePacket& packet) {
+                if (profileTrie) {
+                    std::lock_guard<std::mutex> lock(g_dataMutex);
+                    g_acAutomaton.profileScan(packet.payload, packet.payloadLength);
                 }
-                pktResult["matches"] = matches;
+                arena.add(packet.sequence, packet.packetId, packet.payload, packet.payloadLength,
+                          packet.hits.data(), packet.hits.size());
+            }, &cancel);
+            if (cancel.reason() != CancelToken::Reason::None) {
+                return stoppedResponse(arena.size());
+            }
 
-                response.push_back(pktResult);
+            // Several workers finish out of order; answer in capture order
+            arena.sortBySequence();
+            std::string body;
+            {
+                PI_TRACE_SCOPE_ARG("scan-pcap.serialize", arena.size());
+                body.reserve(64 + arena.size() * 96 + arena.matchCount() * 48);
+                body += '[';
+                for (size_t i = 0; i < arena.size(); ++i) {
+                    // Writing a large capture's answer takes a while too
+                    if (i % 1024 == 0 && cancel.stopRequested()) {
+                        return stoppedResponse(arena.size());
+                    }
+                    if (i > 0) body += ',';
+                    arena.appendJson(body, arena.packetAt(i));
+                }
+                body += ']';
             }
 
-            return crow::response(200, response.dump());
+            // A huge capture should not pin its buffers to this server thread for good
+            if (arena.memoryUsage() > ARENA_KEEP_BYTES) {
+                threadArena = ScanArena();
+            }
+            return crow::response(200, std::move(body));
         } catch (const std::exception& e) {
             json error;
             error["error"] = std::string(e.what());
@@ -215,6 +583,86 @@ int main() {
         }
     });
 
+    /**
+     * POST /scan-pcap/cancel
+     * Stop running /scan-pcap requests at their next batch
+     * ?scanId=ID stops the scans started with that id, otherwise all of them
+     */
+    CROW_ROUTE(app, "/scan-pcap/cancel").methods("POST"_method)
+    ([](const crow::request& req) {
+        const char* scanId = req.url_params.get("scanId");
+        size_t cancelled = 0;
+        {
+            std::lock_guard<std::mutex> lock(g_scansMutex);
+            for (auto& [id, token] : g_activeScans) {
+                if (!scanId || id == scanId) {
+                    token->cancel();
+                    cancelled++;
+                }
+            }
+        }
+        json response;
+        response["cancelled"] = cancelled;
+        return crow::response(200, response.dump());
+    });
+
+    /**
+     * GET /pipeline
+     * Stage counters and ring depths of the latest /scan-pcap pipeline
+     * A stage whose input ring runs full (high maxInputDepth, upstream stalls)
+     * is the bottleneck
+     * ?flows=N adds the N busiest flows and the flow count per worker once the scan is done
+     */
+    CROW_ROUTE(app, "/pipeline").methods("GET"_method)
+    ([](const crow::request& req) {
+        std::shared_ptr<PacketPipeline> pipeline;
+        {
+            std::lock_guard<std::mutex> lock(g_pipelineMutex);
+            pipeline = g_lastPipeline;
+        }
+        json response = pipeline ? pipeline->statsJson() : json::object();
+        if (!pipeline) {
+            response["workers"] = PipelineConfig::fromEnvironment().workers;
+            response["stages"] = json::array();
+        }
+        if (const char* top = req.url_params.get("flows")) {
+            if (pipeline && pipeline->isFinished()) {
+                response["flows"] = pipeline->flowsJson(std::strtoul(top, nullptr, 10));
+            }
+        }
+        return crow::response(200, response.dump());
+    });
+
+    /**
+     * GET /perf-counters
+     * Hardware counters accumulated around AC scans (PKTINSPECT_PERF_COUNTERS=1)
+     */
+    CROW_ROUTE(app, "/perf-counters").methods("GET"_method)
+    ([]() {
+        std::lock_guard<std::mutex> lock(g_perfMutex);
+        json response = g_scanCounts.toJson(g_scanBytes, g_scanPackets);
+        response["enabled"] = g_perfCountersEnabled;
+        return crow::response(200, response.dump());
+    });
+
+    /**
+     * GET /trace
+     * Recent pipeline spans in Chrome trace JSON (open in Perfetto)
+     * Query: enable=0|1 toggles recording, clear=1 drops exported spans
+     */
+    CROW_ROUTE(app, "/trace").methods("GET"_method)
+    ([](const crow::request& req) {
+        if (const char* enable = req.url_params.get("enable")) {
+            Tracer::setEnabled(std::string(enable) != "0");
+        }
+        bool clear = req.url_params.get("clear") != nullptr;
+
+        json response = Tracer::exportChromeTrace(clear);
+        response["otherData"]["compiledIn"] = Tracer::isCompiledIn();
+        response["otherData"]["enabled"] = Tracer::isEnabled();
+        return crow::response(200, response.dump());
+    });
+
     /**
      * Health check endpoint
      */
@@ -224,6 +672,80 @@ int main() {
         response["status"] = "ok";
         response["service"] = "packet-inspection-api";
         response["version"] = "1.0.0";
+        response["simd"] = CpuDispatch::kernels().name;
+        return crow::response(200, response.dump());
+    });
+
+    /**
+     * GET /engine
+     * Selected matcher engine and the calibration timings behind the choice
+     */
+    CROW_ROUTE(app, "/engine").methods("GET"_method)
+    ([]() {
+        std::shared_ptr<const Matcher> matcher = activeMatcher();
+        std::lock_guard<std::mutex> lock(g_dataMutex);
+        json response;
+        response["selected"] = matcher->name();
+        response["patterns"] = matcher->patternSet().size();
+
+        if (g_shmClient) {
+            json shared;
+            shared["role"] = "attach";
+            shared["name"] = g_shmClient->getName();
+            shared["generation"] = g_shmClient->attachedGeneration();
+            shared["publishedGeneration"] = SharedAutomaton::currentGeneration(g_shmClient->getName());
+            response["shared"] = shared;
+        } else if (g_shmPublishName) {
+            json shared;
+            shared["role"] = "publish";
+            shared["name"] = g_shmPublishName;
+            shared["generation"] = g_publishedGeneration;
+            response["shared"] = shared;
+        }
+
+        json candidates = json::array();
+        for (const auto& timing : g_engineTimings) {
+            json c;
+            c["name"] = timing.name;
+            c["nsPerByte"] = timing.nsPerByte;
+            c["memoryBytes"] = timing.memoryBytes;
+            candidates.push_back(c);
+        }
+        response["candidates"] = candidates;
+        return crow::response(200, response.dump());
+    });
+
+    /**
+     * GET /pattern-stats
+     * Hits per pattern from bulk scans (/scan-pcap), with rates over 10 s, 60 s and 300 s
+     * Query: top=N keeps the N most frequent patterns (default: every pattern)
+     */
+    CROW_ROUTE(app, "/pattern-stats").methods("GET"_method)
+    ([](const crow::request& req) {
+        size_t top = 0;
+        if (const char* topParam = req.url_params.get("top")) {
+            top = static_cast<size_t>(std::strtoul(topParam, nullptr, 10));
+        }
+        json response = patternStatsFor(*activeMatcher())->toJson(STATS_WINDOWS_SECONDS, top);
+        return crow::response(200, response.dump());
+    });
+
+    /**
+     * POST /reload
+     * Re-read patterns.json and rebuild the automata
+     * Publishing servers push a new shared generation; attached servers pick
+     * it up on their next scan without a reload
+     */
+    CROW_ROUTE(app, "/reload").methods("POST"_method)
+    ([]() {
+        initializeAutomata();
+        std::shared_ptr<const Matcher> matcher = activeMatcher();
+        json response;
+        response["patterns"] = matcher->patternSet().size();
+        response["selected"] = matcher->name();
+        if (g_shmPublishName && !g_shmAttachName) {
+            response["generation"] = g_publishedGeneration;
+        }
         return crow::response(200, response.dump());
     });
 
@@ -232,9 +754,16 @@ int main() {
     printf("  GET  /health         - Health check\n");
     printf("  GET  /patterns       - Get patterns.json\n");
     printf("  GET  /dfa            - Get DFA JSON\n");
-    printf("  GET  /ac-trie        - Get AC Trie JSON\n");
+    printf("  GET  /ac-trie        - Get AC Trie JSON (?profile=N, ?heatmap=1 for hotspots)\n");
     printf("  POST /scan           - Scan payload\n");
-    printf("  POST /scan-pcap      - Upload and scan PCAP file\n");
+    printf("  POST /scan-pcap      - Upload and scan PCAP file (?deadlineMs=N, ?scanId=ID)\n");
+    printf("  POST /scan-pcap/cancel - Stop running PCAP scans (?scanId=ID)\n");
+    printf("  GET  /pipeline       - Stage counters and queue depths of the last PCAP scan\n");
+    printf("  GET  /perf-counters  - Hardware counters (PKTINSPECT_PERF_COUNTERS=1)\n");
+    printf("  GET  /trace          - Chrome trace of recent spans (PKTINSPECT_TRACING build)\n");
+    printf("  GET  /engine         - Selected matcher engine and calibration timings\n");
+    printf("  GET  /pattern-stats  - Hits per pattern with 10s/60s/300s rates (?top=N)\n");
+    printf("  POST /reload         - Reload patterns.json (republishes with PKTINSPECT_SHM_PUBLISH)\n");
 
     app.port(SERVER_PORT).multithreaded().run();
 
@@ -1,7 +1,9 @@
 #include "packet_inspection/ac/aho_corasick.hpp"
+#include "packet_inspection/trace/tracer.hpp"
 #include <cctype>
 #include <algorithm>
 #include <set>
+#include <unordered_map>
 
 std::shared_ptr<AhoCorasick::TrieNode> AhoCorasick::createNode() {
     auto node = std::make_shared<TrieNode>();
@@ -13,20 +15,39 @@ std::shared_ptr<AhoCorasick::TrieNode> AhoCorasick::createNode() {
 void AhoCorasick::buildFromPatterns(const std::vector<std::string>& patterns) {
     clear();
     root = createNode();
+    this->patterns = patterns;
 
     // Insert all patterns
-    for (const auto& pattern : patterns) {
-        insertPattern(pattern);
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        insertPattern(patterns[i], static_cast<uint32_t>(i));
     }
 
     // Build fail links
     buildFailLinks();
 
+    // scan() reports a pattern text once, under its lowest id
+    std::unordered_map<std::string, uint32_t> firstId;
+    canonicalIds.resize(patterns.size());
+    for (size_t i = 0; i < patterns.size(); ++i) {
+        canonicalIds[i] = firstId.emplace(patterns[i], static_cast<uint32_t>(i)).first->second;
+    }
+
+    // While at the root, scanHits() jumps straight to the next byte that can start a pattern
+    for (const auto& [c, child] : root->children) {
+        startBytes.add(static_cast<uint8_t>(c));
+        startBytes.add(static_cast<uint8_t>(std::toupper(static_cast<unsigned char>(c))));
+    }
+    rootSkip = root->outputIds.empty() && !startBytes.empty();
+
+    if (profile) {
+        enableProfiling(profile->sampleEvery);
+    }
+
     fprintf(stdout, "Built Aho-Corasick automaton with %zu patterns and %u nodes\n", 
             patterns.size(), nextNodeId);
 }
 
-void AhoCorasick::insertPattern(const std::string& pattern) {
+void AhoCorasick::insertPattern(const std::string& pattern, uint32_t patternId) {
     auto current = root;
 
     for (char c : pattern) {
@@ -40,6 +61,7 @@ void AhoCorasick::insertPattern(const std::string& pattern) {
 
     // Mark this node as the end of a pattern
     current->output.push_back(pattern);
+    current->outputIds.push_back(patternId);
 }
 
 void AhoCorasick::buildFailLinks() {
@@ -79,56 +101,337 @@ void AhoCorasick::buildFailLinks() {
             for (const auto& pattern : child->failLink->output) {
                 child->output.push_back(pattern);
             }
+            for (uint32_t patternId : child->failLink->outputIds) {
+                child->outputIds.push_back(patternId);
+            }
         }
     }
 }
 
-ScanResult AhoCorasick::scan(const std::string& text, uint32_t packetId,
-                             const std::string& payloadHex, const std::string& payloadAscii) {
+ScanResult AhoCorasick::scan(const std::string& text, uint32_t packetId) {
+    ByteSpan span{reinterpret_cast<const uint8_t*>(text.data()), text.length()};
+    return scan(&span, 1, packetId);
+}
+
+ScanResult AhoCorasick::scan(const ByteSpan* spans, size_t spanCount, uint32_t packetId) {
     ScanResult result;
+    scan(spans, spanCount, packetId, result);
+    return result;
+}
+
+void AhoCorasick::scan(const ByteSpan* spans, size_t spanCount, uint32_t packetId, ScanResult& result) {
+    size_t totalLength = 0;
+    for (size_t k = 0; k < spanCount; ++k) {
+        totalLength += spans[k].length;
+    }
+    PI_TRACE_SCOPE_ARG("ac.scan", totalLength);
+    result.clear();
     result.packetId = packetId;
-    result.payloadHex = payloadHex;
-    result.payloadAscii = payloadAscii;
 
     if (!root) {
-        return result;
+        return;
+    }
+    result.steps.reserve(totalLength);
+
+    // To avoid duplicate matches: a pattern was reported in this scan if its
+    // stamp equals this scan's generation, so nothing is cleared between scans
+    thread_local std::vector<uint32_t> seenStamps;
+    thread_local uint32_t generation = 0;
+    if (seenStamps.size() < patterns.size()) {
+        seenStamps.resize(patterns.size(), 0);
+    }
+    if (++generation == 0) {
+        std::fill(seenStamps.begin(), seenStamps.end(), 0);
+        generation = 1;
     }
 
-    auto current = root;
-    std::set<std::string> foundPatterns;  // To avoid duplicate matches
+    const TrieNode* current = root.get();
+    bool profiled = profile && sampleThisScan();
+    if (profiled) {
+        profile->sampledScans.fetch_add(1, std::memory_order_relaxed);
+        profile->sampledBytes.fetch_add(totalLength, std::memory_order_relaxed);
+    }
+
+    // The current node carries over span boundaries; i is the logical offset
+    size_t i = 0;
+    for (size_t k = 0; k < spanCount; ++k) {
+        for (size_t j = 0; j < spans[k].length; ++j, ++i) {
+            char byte = static_cast<char>(spans[k].data[j]);
+            char c = std::tolower(static_cast<unsigned char>(byte));
+
+            // Follow fail links until we find a match or reach root
+            uint32_t chainStart = current->id;
+            uint64_t failSteps = 0;
+            while (current != root.get() && current->children.find(c) == current->children.end()) {
+                current = current->failLink.get();
+                failSteps++;
+            }
+
+            // Move to next node
+            auto next = current->children.find(c);
+            if (next != current->children.end()) {
+                current = next->second.get();
+            }
+
+            if (profiled) {
+                if (failSteps > 0) {
+                    recordFailChain(chainStart, failSteps);
+                }
+                profile->nodes[current->id].visits.fetch_add(1, std::memory_order_relaxed);
+            }
 
-    for (size_t i = 0; i < text.length(); ++i) {
-        char c = std::tolower(static_cast<unsigned char>(text[i]));
+            // Record any patterns matched at this position
+            result.steps.push_back({static_cast<uint8_t>(byte), current->id, &current->outputIds});
 
-        // Follow fail links until we find a match or reach root
-        while (current != root && current->children.find(c) == current->children.end()) {
-            current = current->failLink;
+            // Add matches to result
+            for (uint32_t patternId : current->outputIds) {
+                uint32_t canonical = canonicalIds[patternId];
+                if (seenStamps[canonical] != generation) {
+                    seenStamps[canonical] = generation;
+                    result.matches.push_back({canonical, static_cast<uint32_t>(i)});
+                }
+            }
+        }
+    }
+}
+
+void AhoCorasick::scanHits(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const {
+    PI_TRACE_SCOPE_ARG("ac.scanHits", length);
+    if (!root) {
+        return;
+    }
+
+    // One branch per call when profiling is off; the counting loop is a separate instance
+    const TrieNode* current = root.get();
+    if (profile && sampleThisScan()) {
+        profile->sampledScans.fetch_add(1, std::memory_order_relaxed);
+        profile->sampledBytes.fetch_add(length, std::memory_order_relaxed);
+        scanHitsLoop<true>(data, length, 0, current, hits);
+    } else {
+        scanHitsLoop<false>(data, length, 0, current, hits);
+    }
+}
+
+void AhoCorasick::scanHits(const ByteSpan* spans, size_t count, std::vector<PatternHit>& hits) const {
+    PI_TRACE_SCOPE_ARG("ac.scanHits", count);
+    if (!root) {
+        return;
+    }
+
+    // The trie node reached at the end of one span is where the next one starts
+    const TrieNode* current = root.get();
+    size_t base = 0;
+    bool profiled = profile && sampleThisScan();
+    for (size_t k = 0; k < count; ++k) {
+        if (profiled) {
+            profile->sampledBytes.fetch_add(spans[k].length, std::memory_order_relaxed);
+            scanHitsLoop<true>(spans[k].data, spans[k].length, base, current, hits);
+        } else {
+            scanHitsLoop<false>(spans[k].data, spans[k].length, base, current, hits);
         }
+        base += spans[k].length;
+    }
+    if (profiled) {
+        profile->sampledScans.fetch_add(1, std::memory_order_relaxed);
+    }
+}
 
-        // Move to next node
-        if (current->children.find(c) != current->children.end()) {
-            current = current->children[c];
+void AhoCorasick::scanBatch(const ByteSpan* packets, size_t count, BatchHits& out) const {
+    PI_TRACE_SCOPE_ARG("ac.scanBatch", count);
+    if (!root) {
+        return;
+    }
+
+    thread_local std::vector<PatternHit> local;
+    for (size_t k = 0; k < count; ++k) {
+        const TrieNode* current = root.get();
+        local.clear();
+        if (profile && sampleThisScan()) {
+            profile->sampledScans.fetch_add(1, std::memory_order_relaxed);
+            profile->sampledBytes.fetch_add(packets[k].length, std::memory_order_relaxed);
+            scanHitsLoop<true>(packets[k].data, packets[k].length, 0, current, local);
+        } else {
+            scanHitsLoop<false>(packets[k].data, packets[k].length, 0, current, local);
         }
+        for (const PatternHit& hit : local) {
+            out.push(static_cast<uint32_t>(k), hit.patternId, hit.position);
+        }
+    }
+}
 
-        // Record any patterns matched at this position
-        MatchStep step;
-        step.byte = static_cast<uint8_t>(text[i]);
-        step.character = text[i];
-        step.nodeId = current->id;
-        step.outputs = current->output;
-
-        // Add matches to result
-        for (const auto& pattern : current->output) {
-            if (foundPatterns.find(pattern) == foundPatterns.end()) {
-                result.matches.push_back({pattern, static_cast<uint32_t>(i)});
-                foundPatterns.insert(pattern);
+template <bool Profiled>
+void AhoCorasick::scanHitsLoop(const uint8_t* data, size_t length, size_t base, const TrieNode*& current,
+                               std::vector<PatternHit>& hits) const {
+    // Raw pointers: no refcount traffic in the hot loop
+    const TrieNode* rootNode = root.get();
+    const SimdKernels& kernels = CpuDispatch::kernels();
+
+    for (size_t i = 0; i < length; ++i) {
+        if (current == rootNode && rootSkip) {
+            size_t skipped = kernels.findFirstOf(data + i, length - i, startBytes);
+            if constexpr (Profiled) {
+                // Skipped bytes are root-to-root transitions
+                profile->nodes[rootNode->id].visits.fetch_add(std::min(skipped, length - i),
+                                                              std::memory_order_relaxed);
             }
+            i += skipped;
+            if (i >= length) {
+                break;
+            }
+        }
+
+        char c = static_cast<char>(std::tolower(data[i]));
+
+        auto it = current->children.find(c);
+        if constexpr (Profiled) {
+            uint32_t chainStart = current->id;
+            uint64_t failSteps = 0;
+            while (it == current->children.end() && current != rootNode) {
+                current = current->failLink.get();
+                it = current->children.find(c);
+                failSteps++;
+            }
+            if (failSteps > 0) {
+                recordFailChain(chainStart, failSteps);
+            }
+        } else {
+            while (it == current->children.end() && current != rootNode) {
+                current = current->failLink.get();
+                it = current->children.find(c);
+            }
+        }
+
+        if (it != current->children.end()) {
+            current = it->second.get();
+        }
+
+        if constexpr (Profiled) {
+            profile->nodes[current->id].visits.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        for (uint32_t patternId : current->outputIds) {
+            hits.push_back({patternId, static_cast<uint32_t>(base + i)});
         }
+    }
+}
 
-        result.steps.push_back(step);
+void AhoCorasick::profileScan(const uint8_t* data, size_t length) const {
+    if (!root || !profile || !sampleThisScan()) {
+        return;
     }
+    profile->sampledScans.fetch_add(1, std::memory_order_relaxed);
+    profile->sampledBytes.fetch_add(length, std::memory_order_relaxed);
+    std::vector<PatternHit> hits;
+    const TrieNode* current = root.get();
+    scanHitsLoop<true>(data, length, 0, current, hits);
+}
 
-    return result;
+bool AhoCorasick::sampleThisScan() const {
+    thread_local uint32_t tick = 0;
+    if (++tick < profile->sampleEvery) {
+        return false;
+    }
+    tick = 0;
+    return true;
+}
+
+void AhoCorasick::recordFailChain(uint32_t nodeId, uint64_t steps) const {
+    NodeProfile& node = profile->nodes[nodeId];
+    node.failChains.fetch_add(1, std::memory_order_relaxed);
+    node.failSteps.fetch_add(steps, std::memory_order_relaxed);
+
+    uint64_t longest = node.maxFailChain.load(std::memory_order_relaxed);
+    while (steps > longest && !node.maxFailChain.compare_exchange_weak(longest, steps, std::memory_order_relaxed)) {
+    }
+}
+
+void AhoCorasick::enableProfiling(uint32_t sampleEvery) {
+    profile = std::make_unique<Profile>();
+    profile->sampleEvery = std::max<uint32_t>(sampleEvery, 1);
+    profile->nodes = std::vector<NodeProfile>(nextNodeId);
+}
+
+void AhoCorasick::resetProfile() {
+    if (profile) {
+        enableProfiling(profile->sampleEvery);
+    }
+}
+
+json AhoCorasick::exportHeatmapJson() const {
+    json output = exportToJson();
+    if (!root || !output.contains("nodes")) {
+        return output;
+    }
+
+    // Static fail depth: links from each node down to the root
+    std::vector<uint32_t> failDepth(nextNodeId, 0);
+    std::queue<const TrieNode*> queue;
+    queue.push(root.get());
+    while (!queue.empty()) {
+        const TrieNode* node = queue.front();
+        queue.pop();
+        uint32_t depth = 0;
+        for (const TrieNode* link = node; link != root.get(); link = link->failLink.get()) {
+            depth++;
+        }
+        failDepth[node->id] = depth;
+        for (const auto& [c, child] : node->children) {
+            queue.push(child.get());
+        }
+    }
+
+    // Cost of a node: transitions into it plus fail links followed from it.
+    // The root takes every non-matching byte, so it is left out of the scale
+    uint64_t maxCost = 0;
+    uint64_t totalFailSteps = 0;
+    if (profile) {
+        for (size_t id = 0; id < profile->nodes.size(); ++id) {
+            const NodeProfile& node = profile->nodes[id];
+            uint64_t failSteps = node.failSteps.load(std::memory_order_relaxed);
+            totalFailSteps += failSteps;
+            if (id != root->id) {
+                maxCost = std::max(maxCost, node.visits.load(std::memory_order_relaxed) + failSteps);
+            }
+        }
+    }
+
+    std::vector<std::pair<uint64_t, uint32_t>> costs;
+    for (json& nodeJson : output["nodes"]) {
+        uint32_t id = nodeJson["id"];
+        uint64_t visits = 0, failChains = 0, failSteps = 0, maxFailChain = 0;
+        if (profile && id < profile->nodes.size()) {
+            const NodeProfile& node = profile->nodes[id];
+            visits = node.visits.load(std::memory_order_relaxed);
+            failChains = node.failChains.load(std::memory_order_relaxed);
+            failSteps = node.failSteps.load(std::memory_order_relaxed);
+            maxFailChain = node.maxFailChain.load(std::memory_order_relaxed);
+        }
+        nodeJson["visits"] = visits;
+        nodeJson["failChains"] = failChains;
+        nodeJson["failSteps"] = failSteps;
+        nodeJson["maxFailChain"] = maxFailChain;
+        nodeJson["failDepth"] = id < failDepth.size() ? failDepth[id] : 0;
+        nodeJson["heat"] = maxCost ? std::min(1.0, static_cast<double>(visits + failSteps) / static_cast<double>(maxCost))
+                                   : 0.0;
+        costs.push_back({failSteps, id});
+    }
+
+    // Nodes whose mismatches cost the most fail-link steps
+    std::sort(costs.begin(), costs.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    json hottest = json::array();
+    for (size_t i = 0; i < costs.size() && i < 10 && costs[i].first > 0; ++i) {
+        hottest.push_back(costs[i].second);
+    }
+
+    json summary;
+    summary["enabled"] = profile != nullptr;
+    summary["sampleEvery"] = profile ? profile->sampleEvery : 0;
+    summary["sampledScans"] = profile ? profile->sampledScans.load(std::memory_order_relaxed) : 0;
+    summary["sampledBytes"] = profile ? profile->sampledBytes.load(std::memory_order_relaxed) : 0;
+    summary["failSteps"] = totalFailSteps;
+    summary["hottestFailNodes"] = hottest;
+    output["profile"] = summary;
+    return output;
 }
 
 json AhoCorasick::exportToJson() const {
@@ -191,4 +494,8 @@ json AhoCorasick::exportToJson() const {
 void AhoCorasick::clear() {
     root = nullptr;
     nextNodeId = 0;
+    patterns.clear();
+    canonicalIds.clear();
+    startBytes = ByteSet();
+    rootSkip = false;
 }
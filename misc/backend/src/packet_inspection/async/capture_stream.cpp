@@ -0,0 +1,125 @@
+#include "packet_inspection/async/capture_stream.hpp"
+#include "packet_inspection/trace/tracer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+Generator<PacketView> captureFrames(const PacketReader& reader, CaptureCursor cursor) {
+    PacketView frame;
+    while (reader.nextFrame(cursor, frame)) {
+        co_yield frame;
+    }
+}
+
+Generator<PacketView> capturePayloads(const PacketReader& reader, CaptureCursor cursor) {
+    PacketView frame;
+    while (reader.nextFrame(cursor, frame)) {
+        uint32_t payloadLength = 0;
+        const uint8_t* payload = reader.locateTcpPayload(frame.payload, frame.payloadLength, payloadLength);
+        if (payload) {
+            co_yield PacketView{frame.packetId, frame.timestamp, payload, payloadLength};
+        }
+    }
+}
+
+Generator<ByteSpan> readChunks(int fd, size_t chunkSize) {
+    std::vector<uint8_t> buffer(std::max<size_t>(1, chunkSize));
+    for (;;) {
+        ssize_t received = ::read(fd, buffer.data(), buffer.size());
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Error: read failed on fd %d: %s\n", fd, strerror(errno));
+            co_return;
+        }
+        if (received == 0) {
+            co_return;
+        }
+        co_yield ByteSpan{buffer.data(), static_cast<size_t>(received)};
+    }
+}
+
+Task<void> scanAsync(Executor& executor, const Matcher& matcher, ByteSpan data, std::vector<PatternHit>& hits) {
+    co_await executor.schedule();
+    matcher.scan(data.data, data.length, hits);
+}
+
+Task<void> scanAsync(Executor& executor, const Matcher& matcher, AsyncScanBatch& batch) {
+    co_await executor.schedule();
+    PI_TRACE_SCOPE_ARG("async.scanBatch", batch.packets.size());
+    batch.hits.clear();
+    batch.hitOffsets.clear();
+    batch.hitOffsets.reserve(batch.packets.size() + 1);
+    for (const PacketView& packet : batch.packets) {
+        batch.hitOffsets.push_back(static_cast<uint32_t>(batch.hits.size()));
+        matcher.scan(packet.payload, packet.payloadLength, batch.hits);
+    }
+    batch.hitOffsets.push_back(static_cast<uint32_t>(batch.hits.size()));
+}
+
+namespace {
+
+/**
+ * Scan the first count batches concurrently, then account and hand them out in order
+ */
+Task<void> flushBatches(Executor& executor, const Matcher& matcher, std::vector<AsyncScanBatch>& batches,
+                        size_t count, AsyncScanSummary& summary,
+                        const std::function<void(const AsyncScanBatch&)>& onBatch) {
+    std::vector<Task<void>> scans;
+    scans.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        scans.push_back(scanAsync(executor, matcher, batches[i]));
+    }
+    co_await whenAll(std::move(scans));
+
+    for (size_t i = 0; i < count; ++i) {
+        AsyncScanBatch& batch = batches[i];
+        summary.batches++;
+        summary.packets += batch.packets.size();
+        summary.hits += batch.hits.size();
+        for (const PacketView& packet : batch.packets) {
+            summary.payloadBytes += packet.payloadLength;
+        }
+        if (onBatch) {
+            onBatch(batch);
+        }
+        batch.clear();
+    }
+}
+
+} // namespace
+
+Task<AsyncScanSummary> scanCaptureAsync(Executor& executor, const Matcher& matcher, std::string path,
+                                        size_t batchSize, size_t inFlight,
+                                        std::function<void(const AsyncScanBatch&)> onBatch) {
+    AsyncScanSummary summary;
+    PacketReader reader;
+    CaptureCursor cursor;
+    summary.bytesRead = reader.openCapture(path, cursor);
+    if (summary.bytesRead < 0) {
+        co_return summary;
+    }
+
+    batchSize = std::max<size_t>(1, batchSize);
+    std::vector<AsyncScanBatch> batches(inFlight ? inFlight : executor.threadCount());
+    size_t filled = 0;
+    for (const PacketView& packet : capturePayloads(reader, cursor)) {
+        AsyncScanBatch& batch = batches[filled];
+        batch.packets.push_back(packet);
+        if (batch.packets.size() == batchSize && ++filled == batches.size()) {
+            co_await flushBatches(executor, matcher, batches, filled, summary, onBatch);
+            filled = 0;
+        }
+    }
+    // The partly filled batch counts too
+    if (filled < batches.size() && !batches[filled].packets.empty()) {
+        ++filled;
+    }
+    if (filled) {
+        co_await flushBatches(executor, matcher, batches, filled, summary, onBatch);
+    }
+    co_return summary;
+}
@@ -0,0 +1,82 @@
+#include "packet_inspection/async/executor.hpp"
+#include <algorithm>
+
+Executor::Executor(unsigned threads)
+    : workers(threads ? threads : std::max(1u, std::thread::hardware_concurrency())) {
+    this->threads.reserve(workers);
+    for (unsigned i = 0; i < workers; ++i) {
+        this->threads.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void Executor::post(std::coroutine_handle<> handle) {
+    bool signal;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.push_back(handle);
+        signal = sleeping > 0;
+    }
+    posted.fetch_add(1, std::memory_order_relaxed);
+    if (signal) {
+        wakeups.fetch_add(1, std::memory_order_relaxed);
+        wake.notify_one();
+    }
+}
+
+void Executor::workerLoop() {
+    std::vector<std::coroutine_handle<>> batch;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        while (ready.empty() && !stopping) {
+            ++sleeping;
+            wake.wait(lock);
+            --sleeping;
+        }
+        if (ready.empty()) {
+            return;  // Stopping and drained
+        }
+        // Take a fair share rather than everything, so a burst of posts
+        // (a whenAll fan-out) spreads over the pool instead of running serially
+        size_t take = (ready.size() + workers - 1) / workers;
+        batch.assign(ready.begin(), ready.begin() + take);
+        ready.erase(ready.begin(), ready.begin() + take);
+        bool more = !ready.empty() && sleeping > 0;
+        lock.unlock();
+        if (more) {
+            wake.notify_one();
+        }
+
+        for (auto handle : batch) {
+            handle.resume();
+        }
+        resumed.fetch_add(batch.size(), std::memory_order_relaxed);
+        batches.fetch_add(1, std::memory_order_relaxed);
+        batch.clear();
+
+        lock.lock();
+    }
+}
+
+json Executor::statsJson() const {
+    json response;
+    uint64_t resumedCount = resumed.load(std::memory_order_relaxed);
+    uint64_t batchCount = batches.load(std::memory_order_relaxed);
+    response["threads"] = workers;
+    response["posted"] = posted.load(std::memory_order_relaxed);
+    response["resumed"] = resumedCount;
+    response["batches"] = batchCount;
+    response["avgBatch"] = batchCount ? static_cast<double>(resumedCount) / batchCount : 0.0;
+    response["wakeups"] = wakeups.load(std::memory_order_relaxed);
+    return response;
+}
@@ -0,0 +1,373 @@
+#include "packet_inspection/engine/ac_table_matcher.hpp"
+#include "packet_inspection/trace/tracer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <queue>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * Assign byte classes over the folded alphabet; uppercase shares the lowercase class
+ * @param classMap Receives the class of every byte (0 = not in any pattern)
+ * @return Number of classes, the row stride
+ */
+uint32_t buildClassMap(const PatternSet& set, uint8_t classMap[256]) {
+    std::memset(classMap, 0, 256);
+    uint32_t classCount = 1;
+    for (uint32_t id = 0; id < set.size(); ++id) {
+        for (char c : set.folded(id)) {
+            uint8_t byte = static_cast<uint8_t>(c);
+            if (classMap[byte] == 0) {
+                classMap[byte] = static_cast<uint8_t>(classCount++);
+            }
+        }
+    }
+    for (int byte = 'A'; byte <= 'Z'; ++byte) {
+        classMap[byte] = classMap[byte | 0x20];
+    }
+    return classCount;
+}
+
+} // namespace
+
+AcTableMatcher::AcTableMatcher(std::shared_ptr<const PatternSet> patterns) : Matcher(std::move(patterns)) {
+    std::vector<uint32_t> built = build();
+    PageBacking backing = HugePageBuffer::configuredBacking(built.size() * sizeof(uint32_t));
+    placeImage(std::move(built), backing, false);
+}
+
+AcTableMatcher::AcTableMatcher(std::shared_ptr<const PatternSet> patterns, PageBacking backing)
+    : Matcher(std::move(patterns)) {
+    placeImage(build(), backing, true);
+}
+
+AcTableMatcher::AcTableMatcher(std::shared_ptr<const PatternSet> patterns, std::shared_ptr<const void> owner,
+                               const uint32_t* words, size_t wordCount)
+    : Matcher(std::move(patterns)), externalImage(std::move(owner)), imageWords(words), imageWordCount(wordCount) {
+    bindImage();
+}
+
+bool AcTableMatcher::validateImage(const uint32_t* words, size_t wordCount, size_t patternCount) {
+    if (wordCount < HEADER_WORDS + 64 || words[0] != IMAGE_MAGIC || words[1] != IMAGE_VERSION) {
+        return false;
+    }
+    const uint64_t states = words[2];
+    const uint64_t stride = words[3];
+    const uint64_t outputs = words[5];
+    if (states == 0 || stride == 0 || stride > 256 || words[4] != patternCount ||
+        states * stride >= OUTPUT_FLAG) {
+        return false;
+    }
+    const uint64_t expected = HEADER_WORDS + 64 + states * stride + states + 1 + outputs;
+    if (expected != wordCount) {
+        return false;
+    }
+
+    const uint8_t* classes = reinterpret_cast<const uint8_t*>(words + HEADER_WORDS);
+    for (int byte = 0; byte < 256; ++byte) {
+        if (classes[byte] >= stride) return false;
+    }
+    const uint32_t* transitions = words + HEADER_WORDS + 64;
+    for (uint64_t i = 0; i < states * stride; ++i) {
+        const uint32_t target = transitions[i] & ~OUTPUT_FLAG;
+        if (target % stride != 0 || target / stride >= states) return false;
+    }
+    const uint32_t* outputStart = transitions + states * stride;
+    for (uint64_t s = 0; s < states; ++s) {
+        if (outputStart[s] > outputStart[s + 1]) return false;
+    }
+    if (outputStart[states] != outputs) {
+        return false;
+    }
+    const uint32_t* outputIds = outputStart + states + 1;
+    for (uint64_t i = 0; i < outputs; ++i) {
+        if (outputIds[i] >= patternCount) return false;
+    }
+    return true;
+}
+
+bool AcTableMatcher::supports(const PatternSet& patterns) {
+    // Every pattern byte adds at most one state to the root
+    uint64_t states = 1;
+    for (uint32_t id = 0; id < patterns.size(); ++id) {
+        states += patterns.folded(id).size();
+    }
+    uint8_t classMap[256];
+    return states * buildClassMap(patterns, classMap) < OUTPUT_FLAG;
+}
+
+void AcTableMatcher::placeImage(std::vector<uint32_t>&& built, PageBacking backing, bool forceBuffer) {
+    const size_t bytes = built.size() * sizeof(uint32_t);
+    if ((forceBuffer || backing != PageBacking::Small) &&
+        hugeImage.allocate(bytes, backing, HugePageBuffer::prefaultEnabled())) {
+        std::memcpy(hugeImage.data(), built.data(), bytes);
+        imageWords = static_cast<const uint32_t*>(hugeImage.data());
+    } else {
+        heapImage = std::move(built);
+        imageWords = heapImage.data();
+    }
+    imageWordCount = bytes / sizeof(uint32_t);
+    bindImage();
+}
+
+std::vector<uint32_t> AcTableMatcher::build() {
+    const PatternSet& set = *patterns;
+
+    uint8_t classMap[256];
+    stride = buildClassMap(set, classMap);
+
+    // Goto function over classes (0 = no edge, the root is never a goto target)
+    std::vector<uint32_t> go(stride, 0);
+    std::vector<std::vector<uint32_t>> outputs(1);
+    for (uint32_t id = 0; id < set.size(); ++id) {
+        const std::string& folded = set.folded(id);
+        if (folded.empty()) continue;
+
+        uint32_t state = 0;
+        for (char c : folded) {
+            uint32_t cls = classMap[static_cast<uint8_t>(c)];
+            if (go[state * stride + cls] == 0) {
+                // Premultiplied targets share their word with OUTPUT_FLAG
+                if ((outputs.size() + 1) * stride >= OUTPUT_FLAG) {
+                    throw std::length_error("ac-table: state count * stride reaches the output flag bit");
+                }
+                go[state * stride + cls] = static_cast<uint32_t>(outputs.size());
+                go.resize(go.size() + stride, 0);
+                outputs.emplace_back();
+            }
+            state = go[state * stride + cls];
+        }
+        outputs[state].push_back(id);
+    }
+    stateCount = static_cast<uint32_t>(outputs.size());
+
+    // BFS: fill missing edges from the fail state and merge fail outputs
+    std::vector<uint32_t> fail(stateCount, 0);
+    std::queue<uint32_t> queue;
+    for (uint32_t cls = 0; cls < stride; ++cls) {
+        if (go[cls] != 0) queue.push(go[cls]);
+    }
+    while (!queue.empty()) {
+        uint32_t state = queue.front();
+        queue.pop();
+        const std::vector<uint32_t>& failOutputs = outputs[fail[state]];
+        outputs[state].insert(outputs[state].end(), failOutputs.begin(), failOutputs.end());
+
+        for (uint32_t cls = 0; cls < stride; ++cls) {
+            uint32_t& next = go[state * stride + cls];
+            uint32_t viaFail = go[fail[state] * stride + cls];
+            if (next != 0) {
+                fail[next] = viaFail;
+                queue.push(next);
+            } else {
+                next = viaFail;
+            }
+        }
+    }
+
+    // Serialize
+    size_t outputCount = 0;
+    for (const auto& list : outputs) outputCount += list.size();
+
+    const size_t transitionsAt = HEADER_WORDS + 64;
+    const size_t outputStartAt = transitionsAt + static_cast<size_t>(stateCount) * stride;
+    const size_t outputIdsAt = outputStartAt + stateCount + 1;
+    std::vector<uint32_t> image(outputIdsAt + outputCount, 0);
+
+    image[0] = IMAGE_MAGIC;
+    image[1] = IMAGE_VERSION;
+    image[2] = stateCount;
+    image[3] = stride;
+    image[4] = static_cast<uint32_t>(set.size());
+    image[5] = static_cast<uint32_t>(outputCount);
+    std::memcpy(&image[HEADER_WORDS], classMap, sizeof(classMap));
+
+    for (uint32_t state = 0; state < stateCount; ++state) {
+        for (uint32_t cls = 0; cls < stride; ++cls) {
+            uint32_t target = go[state * stride + cls];
+            uint32_t word = target * stride;
+            if (!outputs[target].empty()) word |= OUTPUT_FLAG;
+            image[transitionsAt + state * stride + cls] = word;
+        }
+    }
+
+    uint32_t offset = 0;
+    for (uint32_t state = 0; state < stateCount; ++state) {
+        image[outputStartAt + state] = offset;
+        for (uint32_t id : outputs[state]) {
+            image[outputIdsAt + offset++] = id;
+        }
+    }
+    image[outputStartAt + stateCount] = offset;
+    return image;
+}
+
+void AcTableMatcher::bindImage() {
+    stateCount = imageWords[2];
+    stride = imageWords[3];
+    classOf = reinterpret_cast<const uint8_t*>(&imageWords[HEADER_WORDS]);
+    transitions = &imageWords[HEADER_WORDS + 64];
+    outputStart = transitions + static_cast<size_t>(stateCount) * stride;
+    outputIds = outputStart + stateCount + 1;
+
+    // Root skip: only bytes with a non-root transition can leave the root
+    startBytes = ByteSet();
+    for (int byte = 0; byte < 256; ++byte) {
+        if (transitions[classOf[byte]] != 0) {
+            startBytes.add(static_cast<uint8_t>(byte));
+        }
+    }
+    rootSkip = !startBytes.empty();
+}
+
+inline uint32_t AcTableMatcher::scanChunk(const uint8_t* data, size_t length, size_t base, uint32_t state,
+                                          std::vector<PatternHit>& hits) const {
+    const auto findFirstOf = CpuDispatch::kernels().findFirstOf;
+    size_t pos = 0;
+
+    while (pos < length) {
+        if (state == 0) {
+            pos += findFirstOf(data + pos, length - pos, startBytes);
+            if (pos >= length) break;
+        }
+
+        uint32_t next = transitions[state + classOf[data[pos]]];
+        state = next & ~OUTPUT_FLAG;
+        if (next & OUTPUT_FLAG) {
+            uint32_t index = state / stride;
+            for (uint32_t i = outputStart[index]; i < outputStart[index + 1]; ++i) {
+                hits.push_back({outputIds[i], static_cast<uint32_t>(base + pos)});
+            }
+        }
+        ++pos;
+    }
+    return state;
+}
+
+void AcTableMatcher::scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const {
+    PI_TRACE_SCOPE_ARG("ac-table.scan", length);
+    if (!rootSkip) return;
+    scanChunk(data, length, 0, 0, hits);
+}
+
+void AcTableMatcher::scanSpans(const ByteSpan* spans, size_t count, std::vector<PatternHit>& hits) const {
+    PI_TRACE_SCOPE_ARG("ac-table.scanSpans", count);
+    if (!rootSkip) return;
+
+    // The DFA state is all the context a boundary needs
+    uint32_t state = 0;
+    size_t base = 0;
+    for (size_t k = 0; k < count; ++k) {
+        state = scanChunk(spans[k].data, spans[k].length, base, state, hits);
+        base += spans[k].length;
+    }
+}
+
+uint32_t AcTableMatcher::scanStream(const uint8_t* data, size_t length, size_t base, uint32_t state,
+                                    std::vector<PatternHit>& hits) const {
+    if (!rootSkip) return 0;
+    return scanChunk(data, length, base, state, hits);
+}
+
+void AcTableMatcher::scanBatch(const ByteSpan* packets, size_t count, BatchHits& out) const {
+    PI_TRACE_SCOPE_ARG("ac-table.scanBatch", count);
+    if (!rootSkip || count == 0) return;
+
+    struct Lane {
+        const uint8_t* data;
+        size_t length;
+        size_t pos;
+        uint32_t state;
+        uint32_t packet;
+    };
+
+    // Rows in completion order, regrouped by packet below
+    thread_local std::vector<uint32_t> rowPacket;
+    thread_local std::vector<PatternHit> rowHit;
+    thread_local std::vector<uint32_t> packetRows;
+    thread_local std::vector<PatternHit> tail;
+    rowPacket.clear();
+    rowHit.clear();
+
+    const auto findFirstOf = CpuDispatch::kernels().findFirstOf;
+    Lane lanes[BATCH_LANES];
+    size_t next = 0;
+    size_t active = 0;
+    while (active < BATCH_LANES && next < count) {
+        lanes[active++] = {packets[next].data, packets[next].length, 0, 0, static_cast<uint32_t>(next)};
+        ++next;
+    }
+
+    // Rounds while every lane has a packet: skip-scan the lanes at the root,
+    // refill finished lanes, then step all lanes in lockstep over as many
+    // bytes as the shortest remainder allows (capped, so the root skip gets
+    // another chance). The lockstep loop has no per-byte bounds or root checks
+    bool full = active == BATCH_LANES;
+    while (full) {
+        for (Lane& lane : lanes) {
+            if (lane.state == 0 && lane.pos < lane.length) {
+                lane.pos += findFirstOf(lane.data + lane.pos, lane.length - lane.pos, startBytes);
+            }
+            while (lane.pos >= lane.length && full) {
+                if (next == count) {
+                    full = false;
+                } else {
+                    lane = {packets[next].data, packets[next].length, 0, 0, static_cast<uint32_t>(next)};
+                    ++next;
+                }
+            }
+        }
+        if (!full) break;
+
+        size_t steps = BATCH_BLOCK;
+        for (const Lane& lane : lanes) {
+            steps = std::min(steps, lane.length - lane.pos);
+        }
+        for (size_t s = 0; s < steps; ++s) {
+            for (Lane& lane : lanes) {
+                uint32_t target = transitions[lane.state + classOf[lane.data[lane.pos]]];
+                lane.state = target & ~OUTPUT_FLAG;
+                if (target & OUTPUT_FLAG) {
+                    uint32_t index = lane.state / stride;
+                    for (uint32_t i = outputStart[index]; i < outputStart[index + 1]; ++i) {
+                        rowPacket.push_back(lane.packet);
+                        rowHit.push_back({outputIds[i], static_cast<uint32_t>(lane.pos)});
+                    }
+                }
+                ++lane.pos;
+            }
+        }
+    }
+
+    // Remaining lanes one at a time
+    for (size_t l = 0; l < active; ++l) {
+        Lane& lane = lanes[l];
+        if (lane.pos >= lane.length) continue;
+        tail.clear();
+        scanChunk(lane.data + lane.pos, lane.length - lane.pos, lane.pos, lane.state, tail);
+        for (const PatternHit& hit : tail) {
+            rowPacket.push_back(lane.packet);
+            rowHit.push_back(hit);
+        }
+    }
+
+    // Counting sort by packet; stable, so each packet keeps its position order
+    packetRows.assign(count + 1, 0);
+    for (uint32_t packet : rowPacket) {
+        ++packetRows[packet + 1];
+    }
+    for (size_t i = 0; i < count; ++i) {
+        packetRows[i + 1] += packetRows[i];
+    }
+    const size_t base = out.size();
+    out.packetIndex.resize(base + rowHit.size());
+    out.patternId.resize(base + rowHit.size());
+    out.offset.resize(base + rowHit.size());
+    for (size_t r = 0; r < rowHit.size(); ++r) {
+        size_t at = base + packetRows[rowPacket[r]]++;
+        out.packetIndex[at] = rowPacket[r];
+        out.patternId[at] = rowHit[r].patternId;
+        out.offset[at] = rowHit[r].position;
+    }
+}
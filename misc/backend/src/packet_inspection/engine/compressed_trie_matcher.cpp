@@ -0,0 +1,278 @@
+#include "packet_inspection/engine/compressed_trie_matcher.hpp"
+#include "packet_inspection/trace/tracer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+
+namespace {
+
+constexpr uint32_t NO_EDGE = UINT32_MAX;
+
+/**
+ * Fold A-Z to a-z in all eight bytes of a word at once
+ */
+inline uint64_t foldWord(uint64_t word) {
+    const uint64_t low7 = word & 0x7f7f7f7f7f7f7f7fULL;
+    const uint64_t atLeastA = low7 + 0x3f3f3f3f3f3f3f3fULL;  // High bit set where byte >= 'A'
+    const uint64_t aboveZ = low7 + 0x2525252525252525ULL;    // High bit set where byte > 'Z'
+    const uint64_t upper = atLeastA & ~aboveZ & ~word & 0x8080808080808080ULL;
+    return word | (upper >> 2);
+}
+
+/**
+ * Length of the common prefix of folded input and a (folded) label
+ */
+inline size_t matchRun(const uint8_t* input, const uint8_t* label, size_t limit) {
+    size_t matched = 0;
+    while (matched + 8 <= limit) {
+        uint64_t a;
+        uint64_t b;
+        std::memcpy(&a, input + matched, 8);
+        std::memcpy(&b, label + matched, 8);
+        const uint64_t diff = foldWord(a) ^ b;
+        if (diff) {
+            return matched + (__builtin_ctzll(diff) >> 3);
+        }
+        matched += 8;
+    }
+    while (matched < limit && PatternSet::fold(input[matched]) == label[matched]) {
+        ++matched;
+    }
+    return matched;
+}
+
+/**
+ * Uncompressed trie used only while building
+ */
+struct BuildNode {
+    std::vector<std::pair<uint8_t, uint32_t>> children;
+    uint32_t fail = 0;
+    std::vector<uint32_t> outputs;  // Own and inherited
+};
+
+uint32_t childOf(const std::vector<BuildNode>& trie, uint32_t node, uint8_t byte) {
+    for (const auto& [c, child] : trie[node].children) {
+        if (c == byte) return child;
+    }
+    return NO_EDGE;
+}
+
+} // namespace
+
+CompressedTrieMatcher::CompressedTrieMatcher(std::shared_ptr<const PatternSet> patterns)
+    : Matcher(std::move(patterns)) {
+    build();
+}
+
+void CompressedTrieMatcher::build() {
+    const PatternSet& set = *patterns;
+
+    // Plain trie over folded patterns
+    std::vector<BuildNode> trie(1);
+    for (uint32_t id = 0; id < set.size(); ++id) {
+        const std::string& folded = set.folded(id);
+        if (folded.empty()) continue;
+
+        uint32_t node = 0;
+        for (char c : folded) {
+            uint32_t next = childOf(trie, node, static_cast<uint8_t>(c));
+            if (next == NO_EDGE) {
+                next = static_cast<uint32_t>(trie.size());
+                trie[node].children.emplace_back(static_cast<uint8_t>(c), next);
+                trie.emplace_back();
+            }
+            node = next;
+        }
+        trie[node].outputs.push_back(id);
+    }
+    uncompressedNodes = trie.size();
+
+    // Fail links and inherited outputs, in BFS order
+    std::deque<uint32_t> queue;
+    for (const auto& [c, child] : trie[0].children) {
+        queue.push_back(child);
+    }
+    while (!queue.empty()) {
+        uint32_t node = queue.front();
+        queue.pop_front();
+        const std::vector<uint32_t> inherited = trie[trie[node].fail].outputs;
+        trie[node].outputs.insert(trie[node].outputs.end(), inherited.begin(), inherited.end());
+
+        for (const auto& [c, child] : trie[node].children) {
+            uint32_t fail = trie[node].fail;
+            while (fail != 0 && childOf(trie, fail, c) == NO_EDGE) {
+                fail = trie[fail].fail;
+            }
+            uint32_t target = childOf(trie, fail, c);
+            trie[child].fail = target != NO_EDGE ? target : 0;
+            queue.push_back(child);
+        }
+    }
+
+    // Collapse runs: walk from each explicit node along single-child, output-free nodes
+    std::vector<uint32_t> location(trie.size(), 0);
+    std::vector<uint32_t> explicitOf(1, 0);  // Explicit node id -> trie node
+    nodes.assign(1, Node{});
+    queue.push_back(0);
+
+    auto isExplicit = [&trie](uint32_t node) {
+        return trie[node].children.size() != 1 || !trie[node].outputs.empty();
+    };
+
+    while (!queue.empty()) {
+        uint32_t node = queue.front();
+        queue.pop_front();
+        uint32_t id = location[node] >> 1;
+
+        auto& children = trie[node].children;
+        std::sort(children.begin(), children.end());
+        nodes[id].edgeBegin = static_cast<uint32_t>(edges.size());
+
+        for (const auto& [c, child] : children) {
+            if (edges.size() >= MAX_EDGES) {
+                throw std::length_error("ac-compressed: edge count exceeds the 23-bit label state");
+            }
+            const uint32_t edge = static_cast<uint32_t>(edges.size());
+            edges.push_back({static_cast<uint32_t>(labels.size()), 0, 0});
+            edgeFirst.push_back(c);
+            labels.push_back(c);
+
+            uint32_t offset = 0;
+            uint32_t current = child;
+            while (!isExplicit(current) && offset < MAX_RUN_OFFSET) {
+                location[current] = labelState(edge, offset);
+                const auto& [nextByte, next] = trie[current].children[0];
+                labels.push_back(nextByte);
+                ++offset;
+                current = next;
+            }
+
+            const uint32_t target = static_cast<uint32_t>(nodes.size());
+            nodes.push_back(Node{});
+            explicitOf.push_back(current);
+            location[current] = explicitState(target);
+            edges[edge].labelLength = offset + 1;
+            edges[edge].target = target;
+            queue.push_back(current);
+        }
+        nodes[id].edgeEnd = static_cast<uint32_t>(edges.size());
+    }
+
+    // Fail targets of label positions and explicit nodes, outputs of explicit nodes
+    failAt.assign(labels.size(), 0);
+    for (uint32_t node = 1; node < trie.size(); ++node) {
+        const uint32_t state = location[node];
+        if (state & 1) {
+            const uint32_t edge = state >> 9;
+            const uint32_t offset = (state >> 1) & 0xff;
+            failAt[edges[edge].labelStart + offset] = location[trie[node].fail];
+        }
+    }
+    for (uint32_t id = 0; id < nodes.size(); ++id) {
+        const BuildNode& source = trie[explicitOf[id]];
+        nodes[id].fail = id == 0 ? explicitState(0) : location[source.fail];
+        nodes[id].outputBegin = static_cast<uint32_t>(outputIds.size());
+        outputIds.insert(outputIds.end(), source.outputs.begin(), source.outputs.end());
+        nodes[id].outputEnd = static_cast<uint32_t>(outputIds.size());
+    }
+
+    labels.resize(labels.size() + 8, 0);  // Padding for 8-byte loads at the end
+
+    std::fill(std::begin(rootEdge), std::end(rootEdge), NO_EDGE);
+    for (uint32_t edge = nodes[0].edgeBegin; edge < nodes[0].edgeEnd; ++edge) {
+        const uint8_t byte = edgeFirst[edge];
+        rootEdge[byte] = edge;
+        startBytes.add(byte);
+        if (byte >= 'a' && byte <= 'z') {
+            rootEdge[byte - 0x20] = edge;
+            startBytes.add(static_cast<uint8_t>(byte - 0x20));
+        }
+    }
+}
+
+size_t CompressedTrieMatcher::memoryUsage() const {
+    return nodes.size() * sizeof(Node) + edges.size() * sizeof(Edge) + edgeFirst.size() + labels.size() +
+           (failAt.size() + outputIds.size()) * sizeof(uint32_t) + sizeof(rootEdge);
+}
+
+bool CompressedTrieMatcher::supports(const PatternSet& patterns) {
+    // Every edge leads to a distinct trie node, and every pattern byte adds at most one
+    uint64_t trieNodes = 0;
+    for (uint32_t id = 0; id < patterns.size(); ++id) {
+        trieNodes += patterns.folded(id).size();
+    }
+    return trieNodes < MAX_EDGES;
+}
+
+uint32_t CompressedTrieMatcher::findEdge(uint32_t node, uint8_t byte) const {
+    const Node& n = nodes[node];
+    if (n.edgeEnd - n.edgeBegin <= 8) {
+        for (uint32_t edge = n.edgeBegin; edge < n.edgeEnd; ++edge) {
+            if (edgeFirst[edge] == byte) return edge;
+        }
+        return NO_EDGE;
+    }
+
+    // Edges of a node are sorted by first byte
+    const uint8_t* first = edgeFirst.data();
+    const uint8_t* it = std::lower_bound(first + n.edgeBegin, first + n.edgeEnd, byte);
+    return it != first + n.edgeEnd && *it == byte ? static_cast<uint32_t>(it - first) : NO_EDGE;
+}
+
+void CompressedTrieMatcher::scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const {
+    PI_TRACE_SCOPE_ARG("ac-compressed.scan", length);
+    if (startBytes.empty()) return;
+
+    const auto findFirstOf = CpuDispatch::kernels().findFirstOf;
+    uint32_t state = explicitState(0);
+    size_t pos = 0;
+
+    while (pos < length) {
+        uint32_t edge;
+        uint32_t offset;
+
+        if (!(state & 1)) {
+            // Explicit node: take a child edge or follow the fail link
+            const uint32_t node = state >> 1;
+            if (node == 0) {
+                pos += findFirstOf(data + pos, length - pos, startBytes);
+                if (pos >= length) break;
+                edge = rootEdge[data[pos]];
+            } else {
+                edge = findEdge(node, PatternSet::fold(data[pos]));
+                if (edge == NO_EDGE) {
+                    state = nodes[node].fail;
+                    continue;
+                }
+            }
+            offset = 0;
+            ++pos;
+        } else {
+            edge = state >> 9;
+            offset = (state >> 1) & 0xff;
+        }
+
+        // Inside a label, having matched labels[start .. start + offset]
+        const Edge& e = edges[edge];
+        const size_t remaining = e.labelLength - 1 - offset;
+        const size_t limit = std::min(remaining, length - pos);
+        const uint8_t* label = &labels[e.labelStart + offset + 1];
+        // Most label visits end on the first byte; skip the word loop for those
+        const size_t matched = limit == 0 || PatternSet::fold(data[pos]) != label[0]
+            ? 0 : 1 + matchRun(data + pos + 1, label + 1, limit - 1);
+        pos += matched;
+
+        if (matched == remaining) {
+            state = explicitState(e.target);
+            const Node& target = nodes[e.target];
+            for (uint32_t i = target.outputBegin; i < target.outputEnd; ++i) {
+                hits.push_back({outputIds[i], static_cast<uint32_t>(pos - 1)});
+            }
+        } else if (pos == length) {
+            state = labelState(edge, offset + static_cast<uint32_t>(matched));
+        } else {
+            state = failAt[e.labelStart + offset + matched];
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#include "packet_inspection/engine/hybrid_matcher.hpp"
+#include "packet_inspection/engine/ac_table_matcher.hpp"
+#include "packet_inspection/engine/rabin_karp_matcher.hpp"
+
+bool HybridMatcher::supports(const PatternSet& patterns) {
+    return patterns.maxLength() >= RabinKarpMatcher::WINDOW && patterns.minLength() < RabinKarpMatcher::WINDOW;
+}
+
+HybridMatcher::HybridMatcher(std::shared_ptr<const PatternSet> patterns) : Matcher(std::move(patterns)) {
+    const PatternSet& set = *this->patterns;
+    std::vector<std::string> shortPatterns;
+    std::vector<std::string> longPatterns;
+
+    for (uint32_t id = 0; id < set.size(); ++id) {
+        const std::string& pattern = set.pattern(id);
+        if (pattern.empty()) continue;
+        if (pattern.size() >= RabinKarpMatcher::WINDOW) {
+            longPatterns.push_back(pattern);
+            longStage.originalId.push_back(id);
+        } else {
+            shortPatterns.push_back(pattern);
+            shortStage.originalId.push_back(id);
+        }
+    }
+
+    if (!shortPatterns.empty()) {
+        shortStage.matcher = std::make_unique<AcTableMatcher>(std::make_shared<const PatternSet>(shortPatterns));
+    }
+    if (!longPatterns.empty()) {
+        longStage.matcher = std::make_unique<RabinKarpMatcher>(std::make_shared<const PatternSet>(longPatterns));
+    }
+}
+
+size_t HybridMatcher::memoryUsage() const {
+    size_t total = (shortStage.originalId.size() + longStage.originalId.size()) * sizeof(uint32_t);
+    if (shortStage.matcher) total += shortStage.matcher->memoryUsage();
+    if (longStage.matcher) total += longStage.matcher->memoryUsage();
+    return total;
+}
+
+void HybridMatcher::scanStage(const Stage& stage, const uint8_t* data, size_t length,
+                              std::vector<PatternHit>& hits) const {
+    if (!stage.matcher) return;
+    const size_t first = hits.size();
+    stage.matcher->scan(data, length, hits);
+    for (size_t i = first; i < hits.size(); ++i) {
+        hits[i].patternId = stage.originalId[hits[i].patternId];
+    }
+}
+
+void HybridMatcher::scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const {
+    scanStage(shortStage, data, length, hits);
+    scanStage(longStage, data, length, hits);
+}
@@ -0,0 +1,77 @@
+#include "packet_inspection/engine/literal_matcher.hpp"
+#include "packet_inspection/trace/tracer.hpp"
+
+namespace {
+
+/**
+ * Rough rank of how often a byte shows up in packet payloads (lower is rarer)
+ */
+int byteFrequencyRank(uint8_t byte) {
+    if (byte == ' ' || byte == 'e' || byte == 't' || byte == 'a' || byte == 'o') return 6;
+    if (byte >= 'a' && byte <= 'z') return 5;
+    if (byte == 0x00 || byte == '\r' || byte == '\n' || byte == '/' || byte == '.') return 4;
+    if (byte >= '0' && byte <= '9') return 3;
+    if (byte >= 0x20 && byte < 0x7f) return 2;
+    return 1;
+}
+
+} // namespace
+
+LiteralMatcher::LiteralMatcher(std::shared_ptr<const PatternSet> patterns) : Matcher(std::move(patterns)) {
+    const PatternSet& set = *this->patterns;
+    for (uint32_t id = 0; id < set.size(); ++id) {
+        const std::string& folded = set.folded(id);
+        if (folded.empty()) continue;
+
+        Literal literal;
+        literal.patternId = id;
+        literal.anchorOffset = 0;
+        for (uint32_t i = 1; i < folded.size(); ++i) {
+            if (byteFrequencyRank(static_cast<uint8_t>(folded[i])) <
+                byteFrequencyRank(static_cast<uint8_t>(folded[literal.anchorOffset]))) {
+                literal.anchorOffset = i;
+            }
+        }
+        uint8_t anchorByte = static_cast<uint8_t>(folded[literal.anchorOffset]);
+        literal.anchor.add(anchorByte);
+        if (anchorByte >= 'a' && anchorByte <= 'z') {
+            literal.anchor.add(static_cast<uint8_t>(anchorByte - 0x20));
+        }
+        literals.push_back(literal);
+    }
+}
+
+bool LiteralMatcher::supports(const PatternSet& patterns) {
+    return patterns.size() >= 1 && patterns.size() <= MAX_PATTERNS;
+}
+
+void LiteralMatcher::scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const {
+    PI_TRACE_SCOPE_ARG("literal.scan", length);
+    const auto findFirstOf = CpuDispatch::kernels().findFirstOf;
+
+    for (const Literal& literal : literals) {
+        const std::string& folded = patterns->folded(literal.patternId);
+        const size_t patternLength = folded.size();
+        if (patternLength > length) continue;
+
+        // Anchor positions that leave room for the whole pattern on both sides
+        size_t pos = literal.anchorOffset;
+        const size_t lastAnchor = length - patternLength + literal.anchorOffset;
+
+        while (pos <= lastAnchor) {
+            pos += findFirstOf(data + pos, lastAnchor + 1 - pos, literal.anchor);
+            if (pos > lastAnchor) break;
+
+            const uint8_t* start = data + pos - literal.anchorOffset;
+            size_t i = 0;
+            while (i < patternLength && PatternSet::fold(start[i]) == static_cast<uint8_t>(folded[i])) {
+                ++i;
+            }
+            if (i == patternLength) {
+                hits.push_back({literal.patternId,
+                                static_cast<uint32_t>(pos - literal.anchorOffset + patternLength - 1)});
+            }
+            ++pos;
+        }
+    }
+}
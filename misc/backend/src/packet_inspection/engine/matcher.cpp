@@ -0,0 +1,92 @@
+#include "packet_inspection/engine/matcher.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+PatternSet::PatternSet(const std::vector<std::string>& patterns) : patterns(patterns) {
+    std::unordered_map<std::string, uint32_t> firstId;
+
+    for (uint32_t id = 0; id < patterns.size(); ++id) {
+        const std::string& pattern = patterns[id];
+        std::string lowered(pattern);
+        for (char& c : lowered) {
+            c = static_cast<char>(fold(static_cast<uint8_t>(c)));
+        }
+        foldedPatterns.push_back(lowered);
+        canonical.push_back(firstId.emplace(pattern, id).first->second);
+
+        if (pattern.empty()) continue;
+        minLen = minLen == 0 ? pattern.size() : std::min(minLen, pattern.size());
+        maxLen = std::max(maxLen, pattern.size());
+        totalLen += pattern.size();
+    }
+}
+
+void Matcher::scanSpans(const ByteSpan* spans, size_t count, std::vector<PatternHit>& hits) const {
+    const size_t reach = patterns->maxLength() > 0 ? patterns->maxLength() - 1 : 0;
+    std::vector<PatternHit> local;
+    std::vector<uint8_t> window;
+
+    // Copy logical bytes [from, to) out of the spans (only used around boundaries)
+    auto gather = [&](size_t from, size_t to) {
+        window.clear();
+        size_t offset = 0;
+        for (size_t k = 0; k < count && offset < to; ++k) {
+            size_t begin = std::max(from, offset);
+            size_t end = std::min(to, offset + spans[k].length);
+            if (begin < end) {
+                window.insert(window.end(), spans[k].data + (begin - offset), spans[k].data + (end - offset));
+            }
+            offset += spans[k].length;
+        }
+    };
+
+    size_t total = 0;
+    for (size_t k = 0; k < count; ++k) {
+        total += spans[k].length;
+    }
+
+    size_t base = 0;
+    size_t previousBoundary = 0;
+    for (size_t k = 0; k < count; ++k) {
+        if (spans[k].length == 0) {
+            continue;
+        }
+
+        // Matches crossing the boundary in front of this span. Each crossing match is
+        // reported at the first boundary it crosses, so the window starts no earlier
+        // than the previous boundary
+        if (base > 0 && reach > 0) {
+            size_t from = std::max(previousBoundary, base - std::min(base, reach));
+            size_t to = std::min(total, base + reach);
+            gather(from, to);
+            local.clear();
+            scan(window.data(), window.size(), local);
+            for (const PatternHit& hit : local) {
+                size_t end = from + hit.position;
+                size_t length = patterns->pattern(hit.patternId).size();
+                if (end >= base && end + 1 - length < base) {
+                    hits.push_back({hit.patternId, static_cast<uint32_t>(end)});
+                }
+            }
+            previousBoundary = base;
+        }
+
+        local.clear();
+        scan(spans[k].data, spans[k].length, local);
+        for (const PatternHit& hit : local) {
+            hits.push_back({hit.patternId, static_cast<uint32_t>(base + hit.position)});
+        }
+        base += spans[k].length;
+    }
+}
+
+void Matcher::scanBatch(const ByteSpan* packets, size_t count, BatchHits& out) const {
+    thread_local std::vector<PatternHit> local;
+    for (size_t i = 0; i < count; ++i) {
+        local.clear();
+        scan(packets[i].data, packets[i].length, local);
+        for (const PatternHit& hit : local) {
+            out.push(static_cast<uint32_t>(i), hit.patternId, hit.position);
+        }
+    }
+}
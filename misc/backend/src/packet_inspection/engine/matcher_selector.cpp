@@ -0,0 +1,129 @@
+#include "packet_inspection/engine/matcher_selector.hpp"
+#include "packet_inspection/engine/literal_matcher.hpp"
+#include "packet_inspection/engine/prefilter_matcher.hpp"
+#include "packet_inspection/engine/shift_or_matcher.hpp"
+#include "packet_inspection/engine/wu_manber_matcher.hpp"
+#include "packet_inspection/engine/rabin_karp_matcher.hpp"
+#include "packet_inspection/engine/hybrid_matcher.hpp"
+#include "packet_inspection/engine/ac_table_matcher.hpp"
+#include "packet_inspection/engine/compressed_trie_matcher.hpp"
+#include "packet_inspection/engine/trie_matcher.hpp"
+#include "packet_inspection/utils/traffic_generator.hpp"
+#include "packet_inspection/trace/tracer.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+namespace {
+
+constexpr int CALIBRATION_PASSES = 3;
+
+template <typename T>
+std::unique_ptr<Matcher> createEngine(std::shared_ptr<const PatternSet> patterns) {
+    return std::make_unique<T>(std::move(patterns));
+}
+
+bool supportsAny(const PatternSet&) {
+    return true;
+}
+
+double timeEngine(const Matcher& matcher, const std::vector<std::string>& sample, size_t sampleBytes) {
+    std::vector<PatternHit> hits;
+    double best = std::numeric_limits<double>::max();
+
+    for (int pass = 0; pass < CALIBRATION_PASSES; ++pass) {
+        auto start = std::chrono::steady_clock::now();
+        for (const std::string& payload : sample) {
+            hits.clear();
+            matcher.scan(reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), hits);
+        }
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+    }
+    return sampleBytes > 0 ? best / static_cast<double>(sampleBytes) : 0.0;
+}
+
+} // namespace
+
+const std::vector<EngineInfo>& MatcherSelector::engines() {
+    static const std::vector<EngineInfo> registry = {
+        {"literal", &LiteralMatcher::supports, &createEngine<LiteralMatcher>},
+        {"prefilter", &PrefilterMatcher::supports, &createEngine<PrefilterMatcher>},
+        {"shift-or", &ShiftOrMatcher::supports, &createEngine<ShiftOrMatcher>},
+        {"wu-manber", &WuManberMatcher::supports, &createEngine<WuManberMatcher>},
+        {"rabin-karp", &RabinKarpMatcher::supports, &createEngine<RabinKarpMatcher>},
+        {"hybrid", &HybridMatcher::supports, &createEngine<HybridMatcher>},
+        {"ac-table", &AcTableMatcher::supports, &createEngine<AcTableMatcher>},
+        {"ac-compressed", &CompressedTrieMatcher::supports, &createEngine<CompressedTrieMatcher>},
+        {"ac-trie", &supportsAny, &createEngine<TrieMatcher>},
+    };
+    return registry;
+}
+
+std::unique_ptr<Matcher> MatcherSelector::create(const std::string& name,
+                                                 std::shared_ptr<const PatternSet> patterns) {
+    for (const EngineInfo& engine : engines()) {
+        if (name == engine.name) {
+            if (!engine.supports(*patterns)) return nullptr;
+            return engine.create(std::move(patterns));
+        }
+    }
+    return nullptr;
+}
+
+std::unique_ptr<Matcher> MatcherSelector::select(std::shared_ptr<const PatternSet> patterns,
+                                                 const std::vector<std::string>& sample,
+                                                 std::vector<EngineTiming>* timings) {
+    PI_TRACE_SCOPE("engine.select");
+
+    if (const char* forced = std::getenv("PKTINSPECT_ENGINE")) {
+        if (auto matcher = create(forced, patterns)) {
+            return matcher;
+        }
+        fprintf(stderr, "Error: PKTINSPECT_ENGINE=%s is unknown or does not support this pattern set\n", forced);
+    }
+
+    size_t sampleBytes = 0;
+    for (const std::string& payload : sample) sampleBytes += payload.size();
+
+    std::unique_ptr<Matcher> best;
+    double bestTime = std::numeric_limits<double>::max();
+
+    for (const EngineInfo& engine : engines()) {
+        if (!engine.supports(*patterns)) continue;
+
+        std::unique_ptr<Matcher> candidate = engine.create(patterns);
+        double nsPerByte = timeEngine(*candidate, sample, sampleBytes);
+        if (timings) {
+            timings->push_back({engine.name, nsPerByte, candidate->memoryUsage()});
+        }
+        if (!best || nsPerByte < bestTime) {
+            bestTime = nsPerByte;
+            best = std::move(candidate);
+        }
+    }
+
+    if (!best) {
+        best = std::make_unique<TrieMatcher>(std::move(patterns));
+    }
+    return best;
+}
+
+std::vector<std::string> MatcherSelector::calibrationSample(const PatternSet& patterns, size_t packetCount) {
+    TrafficProfile profile;
+    profile.packetCount = packetCount;
+
+    std::vector<std::string> attackPatterns;
+    for (const std::string& pattern : patterns.all()) {
+        if (!pattern.empty()) attackPatterns.push_back(pattern);
+    }
+
+    TrafficGenerator generator(1);
+    std::vector<std::string> sample;
+    for (GeneratedPacket& packet : generator.generate(profile, attackPatterns)) {
+        sample.push_back(std::move(packet.payload));
+    }
+    return sample;
+}
@@ -0,0 +1,101 @@
+#include "packet_inspection/engine/prefilter_matcher.hpp"
+#include "packet_inspection/trace/tracer.hpp"
+
+PrefilterMatcher::PrefilterMatcher(std::shared_ptr<const PatternSet> patterns)
+    : Matcher(std::move(patterns)),
+      bigramBits(65536 / 64, 0),
+      bucketStart((1u << BUCKET_BITS) + 1, 0),
+      singleStart(257, 0) {
+    const PatternSet& set = *this->patterns;
+
+    // Count, then fill both CSR tables
+    for (uint32_t id = 0; id < set.size(); ++id) {
+        const std::string& folded = set.folded(id);
+        if (folded.empty()) continue;
+
+        uint8_t first = static_cast<uint8_t>(folded[0]);
+        startBytes.add(first);
+        if (first >= 'a' && first <= 'z') {
+            startBytes.add(static_cast<uint8_t>(first - 0x20));
+        }
+
+        if (folded.size() == 1) {
+            singleStart[first + 1]++;
+        } else {
+            uint32_t bigram = (static_cast<uint32_t>(first) << 8) | static_cast<uint8_t>(folded[1]);
+            bigramBits[bigram >> 6] |= 1ULL << (bigram & 63);
+            bucketStart[bucketOf(bigram) + 1]++;
+        }
+    }
+    for (size_t i = 1; i < bucketStart.size(); ++i) bucketStart[i] += bucketStart[i - 1];
+    for (size_t i = 1; i < singleStart.size(); ++i) singleStart[i] += singleStart[i - 1];
+
+    bucketIds.resize(bucketStart.back());
+    singleIds.resize(singleStart.back());
+    std::vector<uint32_t> bucketFill(bucketStart.begin(), bucketStart.end() - 1);
+    std::vector<uint32_t> singleFill(singleStart.begin(), singleStart.end() - 1);
+
+    for (uint32_t id = 0; id < set.size(); ++id) {
+        const std::string& folded = set.folded(id);
+        if (folded.empty()) continue;
+
+        uint8_t first = static_cast<uint8_t>(folded[0]);
+        if (folded.size() == 1) {
+            singleIds[singleFill[first]++] = id;
+        } else {
+            uint32_t bigram = (static_cast<uint32_t>(first) << 8) | static_cast<uint8_t>(folded[1]);
+            bucketIds[bucketFill[bucketOf(bigram)]++] = id;
+        }
+    }
+}
+
+bool PrefilterMatcher::supports(const PatternSet& patterns) {
+    return patterns.size() >= 1 && patterns.size() <= MAX_PATTERNS;
+}
+
+size_t PrefilterMatcher::memoryUsage() const {
+    return bigramBits.size() * sizeof(uint64_t) +
+           (bucketStart.size() + bucketIds.size() + singleStart.size() + singleIds.size()) * sizeof(uint32_t);
+}
+
+void PrefilterMatcher::scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const {
+    PI_TRACE_SCOPE_ARG("prefilter.scan", length);
+    if (startBytes.empty()) return;
+
+    const auto findFirstOf = CpuDispatch::kernels().findFirstOf;
+    const bool hasSingles = !singleIds.empty();
+    size_t pos = 0;
+
+    while (pos < length) {
+        pos += findFirstOf(data + pos, length - pos, startBytes);
+        if (pos >= length) break;
+
+        const uint8_t first = PatternSet::fold(data[pos]);
+        if (hasSingles) {
+            for (uint32_t i = singleStart[first]; i < singleStart[first + 1]; ++i) {
+                hits.push_back({singleIds[i], static_cast<uint32_t>(pos)});
+            }
+        }
+
+        if (pos + 1 < length) {
+            const uint32_t bigram = (static_cast<uint32_t>(first) << 8) | PatternSet::fold(data[pos + 1]);
+            if ((bigramBits[bigram >> 6] >> (bigram & 63)) & 1) {
+                const uint32_t bucket = bucketOf(bigram);
+                for (uint32_t i = bucketStart[bucket]; i < bucketStart[bucket + 1]; ++i) {
+                    const std::string& folded = patterns->folded(bucketIds[i]);
+                    const size_t patternLength = folded.size();
+                    if (patternLength > length - pos) continue;
+
+                    size_t k = 0;
+                    while (k < patternLength && PatternSet::fold(data[pos + k]) == static_cast<uint8_t>(folded[k])) {
+                        ++k;
+                    }
+                    if (k == patternLength) {
+                        hits.push_back({bucketIds[i], static_cast<uint32_t>(pos + patternLength - 1)});
+                    }
+                }
+            }
+        }
+        ++pos;
+    }
+}
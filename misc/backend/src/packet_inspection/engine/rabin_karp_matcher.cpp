@@ -0,0 +1,135 @@
+#include "packet_inspection/engine/rabin_karp_matcher.hpp"
+#include "packet_inspection/trace/tracer.hpp"
+#include <algorithm>
+#include <array>
+
+namespace {
+
+constexpr uint32_t BASE = 0x01000193u;
+
+struct FoldTable {
+    uint8_t map[256];
+    FoldTable() {
+        for (int i = 0; i < 256; ++i) map[i] = PatternSet::fold(static_cast<uint8_t>(i));
+    }
+};
+
+const FoldTable FOLD;
+
+inline uint64_t mix(uint32_t hash) {
+    return static_cast<uint64_t>(hash) * 0x9E3779B97F4A7C15ULL;
+}
+
+} // namespace
+
+bool RabinKarpMatcher::supports(const PatternSet& patterns) {
+    return patterns.minLength() >= WINDOW;
+}
+
+RabinKarpMatcher::RabinKarpMatcher(std::shared_ptr<const PatternSet> patterns) : Matcher(std::move(patterns)) {
+    const PatternSet& set = *this->patterns;
+
+    for (size_t i = 0; i < WINDOW; ++i) outFactor *= BASE;
+
+    size_t blocks = 1;
+    while (blocks * 512 < set.size() * BLOOM_BITS_PER_PATTERN) blocks *= 2;
+    bloom.assign(blocks, Block{});
+    blockShift = 64;
+    for (size_t b = blocks; b > 1; b >>= 1) --blockShift;
+
+    for (uint32_t id = 0; id < set.size(); ++id) {
+        const std::string& folded = set.folded(id);
+        if (folded.size() < WINDOW) continue;
+
+        uint32_t hash = 0;
+        for (size_t i = 0; i < WINDOW; ++i) {
+            hash = hash * BASE + static_cast<uint8_t>(folded[i]);
+        }
+        keys.emplace_back(hash, id);
+        bloomAdd(hash);
+    }
+    std::sort(keys.begin(), keys.end());
+}
+
+size_t RabinKarpMatcher::memoryUsage() const {
+    return bloom.size() * sizeof(Block) + keys.size() * sizeof(keys[0]);
+}
+
+void RabinKarpMatcher::bloomAdd(uint32_t hash) {
+    const uint64_t x = mix(hash);
+    Block& block = bloom[blockShift == 64 ? 0 : x >> blockShift];
+    for (int k = 0; k < 3; ++k) {
+        const uint32_t bit = (x >> (9 * k)) & 511;
+        block.words[bit >> 6] |= 1ULL << (bit & 63);
+    }
+}
+
+bool RabinKarpMatcher::bloomMayContain(uint32_t hash) const {
+    const uint64_t x = mix(hash);
+    const Block& block = bloom[blockShift == 64 ? 0 : x >> blockShift];
+    bool present = true;
+    for (int k = 0; k < 3; ++k) {
+        const uint32_t bit = (x >> (9 * k)) & 511;
+        present &= (block.words[bit >> 6] >> (bit & 63)) & 1;
+    }
+    return present;
+}
+
+void RabinKarpMatcher::verify(uint32_t hash, const uint8_t* data, size_t length, size_t start,
+                              std::vector<PatternHit>& hits) const {
+    auto it = std::lower_bound(keys.begin(), keys.end(), std::make_pair(hash, 0u));
+    for (; it != keys.end() && it->first == hash; ++it) {
+        const std::string& folded = patterns->folded(it->second);
+        const size_t patternLength = folded.size();
+        if (patternLength > length - start) continue;
+
+        size_t k = 0;
+        while (k < patternLength && FOLD.map[data[start + k]] == static_cast<uint8_t>(folded[k])) {
+            ++k;
+        }
+        if (k == patternLength) {
+            hits.push_back({it->second, static_cast<uint32_t>(start + patternLength - 1)});
+        }
+    }
+}
+
+void RabinKarpMatcher::scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const {
+    PI_TRACE_SCOPE_ARG("rabin-karp.scan", length);
+    if (keys.empty() || length < WINDOW) return;
+
+    // Window start positions 0..count-1, split into LANES equal segments
+    const size_t count = length - WINDOW + 1;
+    const size_t perLane = count / LANES;
+
+    std::array<uint32_t, LANES> hash{};
+    std::array<size_t, LANES> start{};
+    for (size_t lane = 0; lane < LANES; ++lane) {
+        start[lane] = lane * perLane;
+        for (size_t i = 0; i < WINDOW; ++i) {
+            hash[lane] = hash[lane] * BASE + FOLD.map[data[start[lane] + i]];
+        }
+    }
+
+    for (size_t step = 0; step < perLane; ++step) {
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            const size_t pos = start[lane] + step;
+            if (__builtin_expect(bloomMayContain(hash[lane]), 0)) {
+                verify(hash[lane], data, length, pos, hits);
+            }
+            if (pos + WINDOW < length) {
+                hash[lane] = hash[lane] * BASE + FOLD.map[data[pos + WINDOW]] - outFactor * FOLD.map[data[pos]];
+            }
+        }
+    }
+
+    // Remainder windows: the last lane has already rolled up to LANES * perLane
+    uint32_t tail = hash[LANES - 1];
+    for (size_t pos = LANES * perLane; pos < count; ++pos) {
+        if (bloomMayContain(tail)) {
+            verify(tail, data, length, pos, hits);
+        }
+        if (pos + WINDOW < length) {
+            tail = tail * BASE + FOLD.map[data[pos + WINDOW]] - outFactor * FOLD.map[data[pos]];
+        }
+    }
+}
@@ -0,0 +1,137 @@
+#include "packet_inspection/engine/scan_arena.hpp"
+#include "packet_inspection/simd/simd_kernels.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+namespace {
+
+/**
+ * Append a JSON string literal, escaped the way nlohmann::json::dump() does
+ */
+void appendJsonString(std::string& out, const uint8_t* data, size_t length) {
+    out += '"';
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t c = data[i];
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    out += '"';
+}
+
+void appendNumber(std::string& out, uint64_t value) {
+    char buf[24];
+    int n = snprintf(buf, sizeof(buf), "%llu", static_cast<unsigned long long>(value));
+    out.append(buf, static_cast<size_t>(n));
+}
+
+} // namespace
+
+void ScanArena::reset(std::shared_ptr<const PatternSet> patterns) {
+    this->patterns = std::move(patterns);
+    packets.clear();
+    matches.clear();
+    size_t count = this->patterns ? this->patterns->size() : 0;
+    if (seenStamps.size() < count) {
+        seenStamps.resize(count, 0);
+    }
+}
+
+void ScanArena::add(uint64_t sequence, uint32_t packetId, const uint8_t* payload, uint32_t payloadLength,
+                    const PatternHit* hits, size_t hitCount) {
+    PacketMatches packet;
+    packet.sequence = sequence;
+    packet.packetId = packetId;
+    packet.payload = payload;
+    packet.payloadLength = payloadLength;
+    packet.firstMatch = static_cast<uint32_t>(matches.size());
+
+    if (hitCount > 0) {
+        const PatternSet& set = *patterns;
+        auto first = matches.insert(matches.end(), hits, hits + hitCount);
+        // Engines report hits in their own order; restore AC order (position, longest first)
+        std::sort(first, matches.end(), [&set](const PatternHit& a, const PatternHit& b) {
+            if (a.position != b.position) return a.position < b.position;
+            return set.pattern(a.patternId).size() > set.pattern(b.patternId).size();
+        });
+
+        // Keep the first match of each pattern text, compacting in place
+        if (++generation == 0) {
+            std::fill(seenStamps.begin(), seenStamps.end(), 0);
+            generation = 1;
+        }
+        size_t write = packet.firstMatch;
+        for (size_t read = packet.firstMatch; read < matches.size(); ++read) {
+            uint32_t id = set.canonicalId(matches[read].patternId);
+            if (seenStamps[id] != generation) {
+                seenStamps[id] = generation;
+                matches[write++] = {id, matches[read].position};
+            }
+        }
+        matches.resize(write);
+    }
+
+    packet.matchCount = static_cast<uint32_t>(matches.size() - packet.firstMatch);
+    packets.push_back(packet);
+}
+
+void ScanArena::sortBySequence() {
+    std::sort(packets.begin(), packets.end(),
+              [](const PacketMatches& a, const PacketMatches& b) { return a.sequence < b.sequence; });
+}
+
+void ScanArena::appendJson(std::string& out, const PacketMatches& packet) const {
+
+    out += "{\"matches\":[";
+    for (uint32_t i = 0; i < packet.matchCount; ++i) {
+        const PatternHit& match = matches[packet.firstMatch + i];
+        const std::string& pattern = patterns->pattern(match.patternId);
+        if (i > 0) out += ',';
+        out += "{\"pattern\":";
+        appendJsonString(out, reinterpret_cast<const uint8_t*>(pattern.data()), pattern.size());
+        out += ",\"position\":";
+        appendNumber(out, match.position);
+        out += '}';
+    }
+    out += "],\"packetId\":";
+    appendNumber(out, packet.packetId);
+
+    // Same renderings as PacketReader::bytesToAscii() and bytesToHex(), written in place
+    out += ",\"payloadAscii\":\"";
+    for (uint32_t i = 0; i < packet.payloadLength; ++i) {
+        uint8_t c = packet.payload[i];
+        if (!std::isprint(c)) {
+            out += '.';
+        } else if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    out += "\",\"payloadHex\":\"";
+    size_t hexStart = out.size();
+    out.resize(hexStart + 2 * static_cast<size_t>(packet.payloadLength));
+    CpuDispatch::kernels().hexEncode(packet.payload, packet.payloadLength, out.data() + hexStart);
+    out += "\"}";
+}
+
+size_t ScanArena::memoryUsage() const {
+    return packets.capacity() * sizeof(PacketMatches) + matches.capacity() * sizeof(PatternHit) +
+           seenStamps.capacity() * sizeof(uint32_t);
+}
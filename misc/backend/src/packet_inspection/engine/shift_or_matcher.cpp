@@ -0,0 +1,131 @@
+#include "packet_inspection/engine/shift_or_matcher.hpp"
+#include "packet_inspection/trace/tracer.hpp"
+#include <array>
+#include <cstdio>
+
+namespace {
+
+constexpr uint32_t NO_PATTERN = UINT32_MAX;
+
+} // namespace
+
+size_t ShiftOrMatcher::packLanes(const PatternSet& patterns, std::vector<uint32_t>* laneOf,
+                                 std::vector<uint32_t>* bitOf) {
+    std::vector<uint32_t> used;  // Bits used per lane
+
+    if (laneOf) laneOf->assign(patterns.size(), 0);
+    if (bitOf) bitOf->assign(patterns.size(), 0);
+
+    for (uint32_t id = 0; id < patterns.size(); ++id) {
+        const size_t length = patterns.folded(id).size();
+        if (length == 0) continue;
+        if (length > 64) return 0;
+
+        size_t lane = 0;
+        while (lane < used.size() && used[lane] + length > 64) ++lane;
+        if (lane == used.size()) {
+            if (used.size() == MAX_LANES) return 0;
+            used.push_back(0);
+        }
+        if (laneOf) (*laneOf)[id] = static_cast<uint32_t>(lane);
+        if (bitOf) (*bitOf)[id] = used[lane];
+        used[lane] += static_cast<uint32_t>(length);
+    }
+
+    size_t rounded = 1;
+    while (rounded < used.size()) rounded *= 2;
+    return rounded;
+}
+
+bool ShiftOrMatcher::supports(const PatternSet& patterns) {
+    return patterns.maxLength() > 0 && packLanes(patterns, nullptr, nullptr) > 0;
+}
+
+ShiftOrMatcher::ShiftOrMatcher(std::shared_ptr<const PatternSet> patterns) : Matcher(std::move(patterns)) {
+    const PatternSet& set = *this->patterns;
+    std::vector<uint32_t> laneOf;
+    std::vector<uint32_t> bitOf;
+    lanes = packLanes(set, &laneOf, &bitOf);
+    if (lanes == 0) {
+        fprintf(stderr, "Error: Pattern set does not fit the shift-or lanes\n");
+        return;
+    }
+
+    masks.assign(256 * lanes, ~0ULL);
+    startMask.assign(lanes, 0);
+    finalMask.assign(lanes, 0);
+    patternAtBit.assign(lanes * 64, NO_PATTERN);
+
+    for (uint32_t id = 0; id < set.size(); ++id) {
+        const std::string& folded = set.folded(id);
+        if (folded.empty()) continue;
+
+        const size_t lane = laneOf[id];
+        const uint32_t first = bitOf[id];
+        const uint32_t last = first + static_cast<uint32_t>(folded.size()) - 1;
+
+        for (size_t j = 0; j < folded.size(); ++j) {
+            const uint8_t byte = static_cast<uint8_t>(folded[j]);
+            const uint64_t clear = ~(1ULL << (first + j));
+            masks[byte * lanes + lane] &= clear;
+            if (byte >= 'a' && byte <= 'z') {
+                masks[(byte - 0x20) * lanes + lane] &= clear;
+            }
+        }
+        startMask[lane] |= 1ULL << first;
+        finalMask[lane] |= 1ULL << last;
+
+        patternAtBit[lane * 64 + last] = id;
+    }
+}
+
+size_t ShiftOrMatcher::memoryUsage() const {
+    return (masks.size() + startMask.size() + finalMask.size()) * sizeof(uint64_t) +
+           patternAtBit.size() * sizeof(uint32_t);
+}
+
+void ShiftOrMatcher::reportLane(size_t lane, uint64_t matched, size_t pos, std::vector<PatternHit>& hits) const {
+    while (matched) {
+        const int bit = __builtin_ctzll(matched);
+        matched &= matched - 1;
+        hits.push_back({patternAtBit[lane * 64 + bit], static_cast<uint32_t>(pos)});
+    }
+}
+
+template <size_t Lanes>
+void ShiftOrMatcher::scanLanes(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const {
+    std::array<uint64_t, Lanes> state;
+    std::array<uint64_t, Lanes> notStart;
+    std::array<uint64_t, Lanes> finals;
+    state.fill(~0ULL);
+    for (size_t lane = 0; lane < Lanes; ++lane) {
+        notStart[lane] = ~startMask[lane];
+        finals[lane] = finalMask[lane];
+    }
+    const uint64_t* table = masks.data();
+
+    for (size_t pos = 0; pos < length; ++pos) {
+        const uint64_t* row = table + static_cast<size_t>(data[pos]) * Lanes;
+        uint64_t active = 0;
+        for (size_t lane = 0; lane < Lanes; ++lane) {
+            state[lane] = ((state[lane] << 1) & notStart[lane]) | row[lane];
+            active |= ~state[lane] & finals[lane];
+        }
+        if (__builtin_expect(active != 0, 0)) {
+            for (size_t lane = 0; lane < Lanes; ++lane) {
+                reportLane(lane, ~state[lane] & finals[lane], pos, hits);
+            }
+        }
+    }
+}
+
+void ShiftOrMatcher::scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const {
+    PI_TRACE_SCOPE_ARG("shift-or.scan", length);
+    switch (lanes) {
+        case 1: scanLanes<1>(data, length, hits); break;
+        case 2: scanLanes<2>(data, length, hits); break;
+        case 4: scanLanes<4>(data, length, hits); break;
+        case 8: scanLanes<8>(data, length, hits); break;
+        default: break;
+    }
+}
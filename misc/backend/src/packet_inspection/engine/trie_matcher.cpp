@@ -0,0 +1,18 @@
+#include "packet_inspection/engine/trie_matcher.hpp"
+
+TrieMatcher::TrieMatcher(std::shared_ptr<const PatternSet> patterns) : Matcher(std::move(patterns)) {
+    ac.buildFromPatterns(this->patterns->all());
+}
+
+void TrieMatcher::scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const {
+    ac.scanHits(data, length, hits);
+}
+
+void TrieMatcher::scanSpans(const ByteSpan* spans, size_t count, std::vector<PatternHit>& hits) const {
+    ac.scanHits(spans, count, hits);
+}
+
+size_t TrieMatcher::memoryUsage() const {
+    // Rough per-node cost: node, control block, one map entry and output vectors
+    return static_cast<size_t>(ac.getNodeCount()) * 192;
+}
@@ -0,0 +1,120 @@
+#include "packet_inspection/engine/wu_manber_matcher.hpp"
+#include "packet_inspection/trace/tracer.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+/**
+ * Fold A-Z to a-z in all four bytes of a word at once
+ */
+inline uint32_t foldWord(uint32_t word) {
+    const uint32_t low7 = word & 0x7f7f7f7fu;
+    const uint32_t atLeastA = low7 + 0x3f3f3f3fu;  // High bit set where byte >= 'A'
+    const uint32_t aboveZ = low7 + 0x25252525u;    // High bit set where byte > 'Z'
+    const uint32_t upper = atLeastA & ~aboveZ & ~word & 0x80808080u;
+    return word | (upper >> 2);
+}
+
+} // namespace
+
+uint32_t WuManberMatcher::hashAt(const uint8_t* data, size_t pos) {
+    uint32_t word;
+    std::memcpy(&word, data + pos - 3, sizeof(word));
+    // Little endian: the q-gram data[pos-2..pos] is the top three bytes
+    const uint32_t gram = foldWord(word) >> 8;
+    return (gram * 0x9E3779B1u) >> (32 - HASH_BITS);
+}
+
+bool WuManberMatcher::supports(const PatternSet& patterns) {
+    return patterns.minLength() >= MIN_PATTERN_LENGTH;
+}
+
+WuManberMatcher::WuManberMatcher(std::shared_ptr<const PatternSet> patterns)
+    : Matcher(std::move(patterns)),
+      bucketStart((1u << HASH_BITS) + 1, 0) {
+    const PatternSet& set = *this->patterns;
+    window = set.minLength();
+    if (window < MIN_PATTERN_LENGTH) {
+        fprintf(stderr, "Error: Wu-Manber needs patterns of at least %zu bytes\n", MIN_PATTERN_LENGTH);
+        window = 0;
+        return;
+    }
+
+    const uint8_t maxShift = static_cast<uint8_t>(std::min<size_t>(window - BLOCK + 1, 255));
+    shift.assign(1u << HASH_BITS, maxShift);
+
+    // hashAt() reads the byte before the q-gram, so hash from a padded copy
+    std::string padded;
+    for (uint32_t id = 0; id < set.size(); ++id) {
+        const std::string& folded = set.folded(id);
+        if (folded.empty()) continue;
+        padded.assign(1, '\0');
+        padded.append(folded, 0, window);
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(padded.data()) + 1;
+
+        for (size_t end = BLOCK - 1; end < window; ++end) {
+            uint32_t h = hashAt(bytes, end);
+            shift[h] = std::min<uint8_t>(shift[h], static_cast<uint8_t>(std::min<size_t>(window - 1 - end, 255)));
+        }
+        bucketStart[hashAt(bytes, window - 1) + 1]++;
+    }
+
+    for (size_t i = 1; i < bucketStart.size(); ++i) bucketStart[i] += bucketStart[i - 1];
+    bucketIds.resize(bucketStart.back());
+    bucketTags.resize(bucketStart.back());
+    std::vector<uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+
+    for (uint32_t id = 0; id < set.size(); ++id) {
+        const std::string& folded = set.folded(id);
+        if (folded.empty()) continue;
+        padded.assign(1, '\0');
+        padded.append(folded, 0, window);
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(padded.data()) + 1;
+
+        uint32_t slot = fill[hashAt(bytes, window - 1)]++;
+        bucketIds[slot] = id;
+        bucketTags[slot] = prefixTag(bytes);
+    }
+}
+
+size_t WuManberMatcher::memoryUsage() const {
+    return shift.size() + (bucketStart.size() + bucketIds.size()) * sizeof(uint32_t) +
+           bucketTags.size() * sizeof(uint16_t);
+}
+
+void WuManberMatcher::scan(const uint8_t* data, size_t length, std::vector<PatternHit>& hits) const {
+    PI_TRACE_SCOPE_ARG("wu-manber.scan", length);
+    if (window == 0 || length < window) return;
+
+    const uint8_t* shiftTable = shift.data();
+    size_t pos = window - 1;  // Last byte of the current window
+
+    while (pos < length) {
+        const uint32_t h = hashAt(data, pos);
+        const uint8_t skip = shiftTable[h];
+        if (skip != 0) {
+            pos += skip;
+            continue;
+        }
+
+        const size_t start = pos + 1 - window;
+        const uint16_t tag = prefixTag(data + start);
+        for (uint32_t i = bucketStart[h]; i < bucketStart[h + 1]; ++i) {
+            if (bucketTags[i] != tag) continue;
+
+            const std::string& folded = patterns->folded(bucketIds[i]);
+            const size_t patternLength = folded.size();
+            if (patternLength > length - start) continue;
+
+            size_t k = 0;
+            while (k < patternLength && PatternSet::fold(data[start + k]) == static_cast<uint8_t>(folded[k])) {
+                ++k;
+            }
+            if (k == patternLength) {
+                hits.push_back({bucketIds[i], static_cast<uint32_t>(start + patternLength - 1)});
+            }
+        }
+        ++pos;
+    }
+}
@@ -0,0 +1,152 @@
+#include "packet_inspection/http/field_scoped_matcher.hpp"
+#include <cstring>
+
+namespace {
+
+/**
+ * Build a scope's automaton from its patterns' texts
+ */
+std::shared_ptr<const AcTableMatcher> buildTable(const PatternSet& all, const std::vector<uint32_t>& ids) {
+    if (ids.empty()) {
+        return nullptr;
+    }
+    std::vector<std::string> texts;
+    texts.reserve(ids.size());
+    for (uint32_t id : ids) {
+        texts.push_back(all.pattern(id));
+    }
+    return std::make_shared<const AcTableMatcher>(std::make_shared<const PatternSet>(texts));
+}
+
+}  // namespace
+
+bool FieldTarget::parse(const std::string& text, FieldTarget& target) {
+    target = FieldTarget();
+    if (text.empty() || text == "payload") {
+        return true;
+    }
+    if (text == "header") {
+        target.kind = Kind::Field;
+        target.field = HttpField::HeaderValue;
+        return true;
+    }
+    if (text.compare(0, 7, "header:") == 0 && text.size() > 7) {
+        target.kind = Kind::Header;
+        for (size_t i = 7; i < text.size(); ++i) {
+            target.header += static_cast<char>(PatternSet::fold(static_cast<uint8_t>(text[i])));
+        }
+        return true;
+    }
+    for (size_t k = 0; k < HTTP_FIELD_COUNT; ++k) {
+        HttpField field = static_cast<HttpField>(k);
+        if (text == httpFieldName(field)) {
+            target.kind = Kind::Field;
+            target.field = field;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FieldTarget::admits(HttpField candidate) const {
+    switch (kind) {
+        case Kind::Payload: return true;
+        case Kind::Field: return candidate == field;
+        case Kind::Header: return candidate == HttpField::HeaderValue;
+    }
+    return false;
+}
+
+FieldScopedMatcher::FieldScopedMatcher(std::shared_ptr<const PatternSet> patterns,
+                                       const std::vector<FieldTarget>& targets)
+    : patterns(std::move(patterns)) {
+    std::vector<uint32_t> fieldIds[HTTP_FIELD_COUNT];
+    std::vector<std::vector<uint32_t>> headerIds;
+    for (uint32_t id = 0; id < targets.size() && id < this->patterns->size(); ++id) {
+        const FieldTarget& target = targets[id];
+        if (target.kind == FieldTarget::Kind::Field) {
+            fieldIds[static_cast<size_t>(target.field)].push_back(id);
+        } else if (target.kind == FieldTarget::Kind::Header) {
+            size_t index = 0;
+            while (index < headerNames.size() && headerNames[index] != target.header) ++index;
+            if (index == headerNames.size()) {
+                headerNames.push_back(target.header);
+                headerIds.emplace_back();
+            }
+            headerIds[index].push_back(id);
+        } else {
+            continue;
+        }
+        ++scoped;
+    }
+
+    for (size_t k = 0; k < HTTP_FIELD_COUNT; ++k) {
+        fieldScopes[k].table = buildTable(*this->patterns, fieldIds[k]);
+        fieldScopes[k].ids = std::move(fieldIds[k]);
+    }
+    for (auto& ids : headerIds) {
+        Scope scope;
+        scope.table = buildTable(*this->patterns, ids);
+        scope.ids = std::move(ids);
+        headerScopes.push_back(std::move(scope));
+    }
+}
+
+bool FieldScopedMatcher::scan(const uint8_t* data, size_t length, std::vector<FieldHit>& hits) const {
+    thread_local HttpSpanCollector collector;
+    if (!collector.collect(data, length)) {
+        return false;
+    }
+    const std::vector<HttpSpan>& spans = collector.getSpans();
+    scanSpans(data, spans.data(), spans.size(), hits);
+    return true;
+}
+
+void FieldScopedMatcher::scanSpans(const uint8_t* data, const HttpSpan* spans, size_t count,
+                                   std::vector<FieldHit>& hits) const {
+    size_t first = 0;
+    while (first < count) {
+        size_t end = first + 1;
+        while (end < count && spans[end].instance == spans[first].instance) ++end;
+
+        const HttpSpan& span = spans[first];
+        const Scope& scope = fieldScopes[static_cast<size_t>(span.field)];
+        if (scope.table) {
+            scanField(scope, data, spans, first, end, hits);
+        }
+        if (span.field == HttpField::HeaderValue && span.name != HttpSpan::NO_NAME && !headerScopes.empty()) {
+            const HttpSpan& name = spans[span.name];
+            if (const Scope* named = headerScope(data + name.offset, name.length)) {
+                scanField(*named, data, spans, first, end, hits);
+            }
+        }
+        first = end;
+    }
+}
+
+void FieldScopedMatcher::scanField(const Scope& scope, const uint8_t* data, const HttpSpan* spans, size_t first,
+                                   size_t end, std::vector<FieldHit>& hits) const {
+    thread_local std::vector<PatternHit> scratch;
+    scratch.clear();
+    // Hit positions come out as buffer offsets: each span is scanned at its own base
+    uint32_t state = 0;
+    for (size_t k = first; k < end; ++k) {
+        state = scope.table->scanStream(data + spans[k].offset, spans[k].length, spans[k].offset, state, scratch);
+    }
+    for (const PatternHit& hit : scratch) {
+        hits.push_back({spans[first].field, scope.ids[hit.patternId], hit.position});
+    }
+}
+
+const FieldScopedMatcher::Scope* FieldScopedMatcher::headerScope(const uint8_t* name, size_t length) const {
+    for (size_t k = 0; k < headerNames.size(); ++k) {
+        const std::string& candidate = headerNames[k];
+        if (candidate.size() != length) continue;
+        size_t i = 0;
+        while (i < length && PatternSet::fold(name[i]) == static_cast<uint8_t>(candidate[i])) ++i;
+        if (i == length) {
+            return &headerScopes[k];
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,475 @@
+#include "packet_inspection/http/http_normalizer.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#ifdef PKTINSPECT_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+int hexValue(uint8_t byte) {
+    if (byte >= '0' && byte <= '9') return byte - '0';
+    if (byte >= 'a' && byte <= 'f') return byte - 'a' + 10;
+    if (byte >= 'A' && byte <= 'F') return byte - 'A' + 10;
+    return -1;
+}
+
+const int8_t BASE64_SKIP = -2;     // Whitespace
+const int8_t BASE64_PADDING = -3;  // '='
+
+/**
+ * Byte -> sextet for the standard and URL-safe alphabets, or a marker (< 0)
+ */
+struct Base64Table {
+    int8_t values[256];
+
+    Base64Table() {
+        std::memset(values, -1, sizeof(values));
+        for (int k = 0; k < 26; ++k) {
+            values['A' + k] = static_cast<int8_t>(k);
+            values['a' + k] = static_cast<int8_t>(26 + k);
+        }
+        for (int k = 0; k < 10; ++k) {
+            values['0' + k] = static_cast<int8_t>(52 + k);
+        }
+        values['+'] = values['-'] = 62;
+        values['/'] = values['_'] = 63;
+        values[' '] = values['\t'] = values['\r'] = values['\n'] = BASE64_SKIP;
+        values['='] = BASE64_PADDING;
+    }
+};
+
+const Base64Table BASE64;
+
+}  // namespace
+
+/**
+ * Streaming zlib inflater with a fixed output buffer
+ * deflate bodies are sent both zlib-wrapped (as RFC 9110 says) and raw;
+ * the first byte decides (a zlib header has CM = 8 and CINFO <= 7).
+ */
+class HttpNormalizer::Inflater {
+public:
+    static constexpr size_t BUFFER_SIZE = 8192;
+
+#ifdef PKTINSPECT_ZLIB
+    ~Inflater() {
+        if (ready) {
+            inflateEnd(&stream);
+        }
+    }
+
+    void begin(bool gzipCoding) {
+        gzip = gzipCoding;
+        started = false;
+        finished = false;
+    }
+
+    template <typename Out>
+    bool feed(const uint8_t* data, size_t length, Out&& out) {
+        if (finished || length == 0) {
+            return true;  // Bytes after the end of the stream are ignored
+        }
+        if (!started) {
+            int windowBits = gzip ? 15 + 16 : ((data[0] & 0x0f) == 8 && (data[0] >> 4) <= 7) ? 15 : -15;
+            if (!ready) {
+                std::memset(&stream, 0, sizeof(stream));
+                if (inflateInit2(&stream, windowBits) != Z_OK) {
+                    return false;
+                }
+                ready = true;
+            } else if (inflateReset2(&stream, windowBits) != Z_OK) {
+                return false;
+            }
+            started = true;
+        }
+
+        stream.next_in = const_cast<Bytef*>(data);
+        stream.avail_in = static_cast<uInt>(length);
+        while (true) {
+            stream.next_out = buffer;
+            stream.avail_out = BUFFER_SIZE;
+            int status = inflate(&stream, Z_NO_FLUSH);
+            size_t produced = BUFFER_SIZE - stream.avail_out;
+            if (produced > 0) {
+                out(buffer, produced);
+            }
+            if (status == Z_STREAM_END) {
+                if (!gzip) {
+                    finished = true;
+                    return true;
+                }
+                inflateReset(&stream);  // A gzip member may follow
+                if (stream.avail_in == 0) {
+                    return true;
+                }
+                continue;
+            }
+            if (status != Z_OK && status != Z_BUF_ERROR) {
+                return false;
+            }
+            if (stream.avail_in == 0 && stream.avail_out != 0) {
+                return true;
+            }
+            if (status == Z_BUF_ERROR) {
+                return true;  // No progress possible until more input arrives
+            }
+        }
+    }
+
+private:
+    z_stream stream;
+    bool ready = false;
+    bool gzip = false;
+    bool started = false;
+    bool finished = false;
+    uint8_t buffer[BUFFER_SIZE];
+#else
+    void begin(bool) {}
+
+    template <typename Out>
+    bool feed(const uint8_t*, size_t, Out&&) {
+        return false;
+    }
+#endif
+};
+
+HttpNormalizerConfig HttpNormalizerConfig::fromEnvironment() {
+    HttpNormalizerConfig config;
+    if (const char* value = std::getenv("PKTINSPECT_HTTP_PERCENT")) {
+        config.percentDecode = std::atoi(value) != 0;
+    }
+    if (const char* value = std::getenv("PKTINSPECT_HTTP_INFLATE")) {
+        config.inflate = std::atoi(value) != 0;
+    }
+    if (const char* value = std::getenv("PKTINSPECT_HTTP_BASE64")) {
+        std::string name(value);
+        if (name == "off") {
+            config.base64 = Base64::Off;
+        } else if (name == "declared") {
+            config.base64 = Base64::Declared;
+        } else if (name == "all") {
+            config.base64 = Base64::All;
+        } else {
+            fprintf(stderr, "Warning: Unknown PKTINSPECT_HTTP_BASE64 '%s', using declared\n", value);
+        }
+    }
+    if (const char* value = std::getenv("PKTINSPECT_HTTP_MAX_DECODED")) {
+        config.maxDecodedBytes = std::strtoull(value, nullptr, 10);
+    }
+    return config;
+}
+
+bool HttpNormalizerConfig::inflateSupported() {
+#ifdef PKTINSPECT_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+HttpNormalizer::HttpNormalizer(Sink& sink, HttpNormalizerConfig config)
+    : sink(sink), config(config), parser(*this) {
+    uriState.detectQuery = true;
+}
+
+HttpNormalizer::~HttpNormalizer() = default;
+
+void HttpNormalizer::reset() {
+    parser.reset();
+    uriState = PercentState();
+    uriState.detectQuery = true;
+    stages.clear();
+    rawBody = false;
+    speculativeBase64 = false;
+    bodyCut = false;
+    bodyBytes = 0;
+}
+
+template <typename Out>
+void HttpNormalizer::percentDecode(PercentState& state, const uint8_t* data, size_t length, Out&& out) {
+    uint8_t buffer[256];
+    size_t used = 0;
+    auto put = [&](uint8_t byte) {
+        buffer[used++] = byte;
+        if (used == sizeof(buffer)) {
+            out(buffer, used);
+            used = 0;
+        }
+    };
+
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t byte = data[i];
+        if (state.pending == 0) {
+            if (byte == '%') {
+                state.pending = 1;
+                continue;
+            }
+            if (byte == '?' && state.detectQuery) {
+                state.plusIsSpace = true;
+            } else if (byte == '+' && state.plusIsSpace) {
+                byte = ' ';
+            }
+            put(byte);
+            continue;
+        }
+
+        int digit = hexValue(byte);
+        if (digit < 0) {
+            // Not an escape: what was held goes out literally, then this byte again
+            put('%');
+            if (state.pending == 2) {
+                put(state.high);
+            }
+            state.pending = 0;
+            --i;
+            continue;
+        }
+        if (state.pending == 1) {
+            state.high = byte;
+            state.pending = 2;
+            continue;
+        }
+        put(static_cast<uint8_t>(hexValue(state.high) << 4 | digit));
+        state.pending = 0;
+        ++stats.percentDecoded;
+    }
+    if (used > 0) {
+        out(buffer, used);
+    }
+}
+
+template <typename Out>
+void HttpNormalizer::percentFlush(PercentState& state, Out&& out) {
+    uint8_t held[2] = {'%', state.high};
+    if (state.pending > 0) {
+        out(held, state.pending);
+    }
+    state.pending = 0;
+}
+
+template <typename Out>
+bool HttpNormalizer::base64Decode(Base64State& state, const uint8_t* data, size_t length, Out&& out) {
+    uint8_t buffer[192];
+    size_t used = 0;
+    auto flushPartial = [&]() {
+        // 2 sextets hold one byte, 3 hold two
+        if (state.sextets >= 2) {
+            uint32_t bits = state.bits << (6 * (4 - state.sextets));
+            buffer[used++] = static_cast<uint8_t>(bits >> 16);
+            if (state.sextets == 3) {
+                buffer[used++] = static_cast<uint8_t>(bits >> 8);
+            }
+        }
+        state.bits = 0;
+        state.sextets = 0;
+    };
+
+    bool valid = true;
+    for (size_t i = 0; i < length; ++i) {
+        int8_t value = BASE64.values[data[i]];
+        if (value >= 0) {
+            state.bits = state.bits << 6 | static_cast<uint32_t>(value);
+            if (++state.sextets == 4) {
+                buffer[used++] = static_cast<uint8_t>(state.bits >> 16);
+                buffer[used++] = static_cast<uint8_t>(state.bits >> 8);
+                buffer[used++] = static_cast<uint8_t>(state.bits);
+                state.bits = 0;
+                state.sextets = 0;
+            }
+        } else if (value == BASE64_PADDING) {
+            flushPartial();
+        } else if (value != BASE64_SKIP) {
+            valid = false;
+            break;
+        }
+        if (used + 3 > sizeof(buffer)) {
+            stats.base64Bytes += used;
+            out(buffer, used);
+            used = 0;
+        }
+    }
+    if (length == 0) {
+        flushPartial();  // End of the body
+    }
+    if (used > 0) {
+        stats.base64Bytes += used;
+        out(buffer, used);
+    }
+    return valid;
+}
+
+void HttpNormalizer::onField(HttpField field, const uint8_t* data, size_t length) {
+    if (field == HttpField::Uri && config.percentDecode) {
+        percentDecode(uriState, data, length, [this](const uint8_t* run, size_t count) {
+            sink.onNormalized(HttpField::Uri, run, count);
+        });
+        return;
+    }
+    if (field != HttpField::Body || rawBody || stages.empty()) {
+        sink.onNormalized(field, data, length);
+        return;
+    }
+    if (bodyCut) {
+        return;
+    }
+    if (!runStages(0, data, length)) {
+        // Scan the rest of the body as it is rather than lose it
+        if (!speculativeBase64) {
+            ++stats.decodeErrors;
+        }
+        rawBody = true;
+        sink.onNormalized(HttpField::Body, data, length);
+    }
+}
+
+void HttpNormalizer::onFieldEnd(HttpField field) {
+    if (field == HttpField::Uri && config.percentDecode) {
+        percentFlush(uriState, [this](const uint8_t* run, size_t count) {
+            sink.onNormalized(HttpField::Uri, run, count);
+        });
+        uriState = PercentState();
+        uriState.detectQuery = true;
+    } else if (field == HttpField::Body && !rawBody && !bodyCut) {
+        flushStages(0);
+    }
+    sink.onFieldEnd(field);
+}
+
+void HttpNormalizer::onHeadersComplete(const HttpMessageInfo& info) {
+    stages.clear();
+    rawBody = info.tooManyCodings;
+    speculativeBase64 = false;
+    bodyCut = false;
+    bodyBytes = 0;
+
+    // Unwind the coding stack: the last coding applied is decoded first
+    size_t inflaterCount = 0;
+    bool base64Stage = false;
+    for (size_t k = info.codingCount; k-- > 0 && !rawBody;) {
+        Stage stage;
+        switch (info.codings[k]) {
+            case HttpCoding::Gzip:
+            case HttpCoding::Deflate:
+                if (!config.inflate || !HttpNormalizerConfig::inflateSupported()) {
+                    rawBody = true;
+                    break;
+                }
+                if (inflaters.size() == inflaterCount) {
+                    inflaters.push_back(std::make_unique<Inflater>());
+                }
+                stage.kind = StageKind::Inflate;
+                stage.inflater = inflaters[inflaterCount++].get();
+                stage.inflater->begin(info.codings[k] == HttpCoding::Gzip);
+                stages.push_back(stage);
+                break;
+            case HttpCoding::Base64:
+                if (config.base64 == HttpNormalizerConfig::Base64::Off) {
+                    rawBody = true;
+                    break;
+                }
+                stage.kind = StageKind::Base64;
+                stages.push_back(stage);
+                base64Stage = true;
+                break;
+            case HttpCoding::Unknown:
+                rawBody = true;
+                break;
+        }
+    }
+    if (rawBody) {
+        stages.clear();
+        ++stats.undecodableBodies;
+        return;
+    }
+
+    if (config.base64 == HttpNormalizerConfig::Base64::All && !base64Stage) {
+        Stage stage;
+        stage.kind = StageKind::Base64;
+        stages.push_back(stage);
+        speculativeBase64 = true;
+    }
+    if (info.formEncoded && config.percentDecode) {
+        Stage stage;
+        stage.kind = StageKind::Percent;
+        stage.percent.plusIsSpace = true;
+        stages.push_back(stage);
+    }
+}
+
+void HttpNormalizer::onMessageEnd() {
+    ++stats.messages;
+    stages.clear();
+    rawBody = false;
+    speculativeBase64 = false;
+    bodyCut = false;
+    bodyBytes = 0;
+    sink.onMessageEnd();
+}
+
+bool HttpNormalizer::runStages(size_t index, const uint8_t* data, size_t length) {
+    if (index == stages.size()) {
+        emitBody(data, length);
+        return true;
+    }
+
+    Stage& stage = stages[index];
+    bool downstream = true;
+    auto next = [&](const uint8_t* run, size_t count) {
+        downstream = runStages(index + 1, run, count) && downstream;
+    };
+    switch (stage.kind) {
+        case StageKind::Inflate: {
+            auto counted = [&](const uint8_t* run, size_t count) {
+                stats.inflatedBytes += count;
+                next(run, count);
+            };
+            bool ok = stage.inflater->feed(data, length, counted);
+            return ok && downstream;
+        }
+        case StageKind::Base64: {
+            if (length == 0) {
+                return true;  // base64Decode() treats an empty run as the end
+            }
+            bool ok = base64Decode(stage.base64, data, length, next);
+            return ok && downstream;
+        }
+        case StageKind::Percent:
+            percentDecode(stage.percent, data, length, next);
+            return downstream;
+    }
+    return downstream;
+}
+
+void HttpNormalizer::flushStages(size_t index) {
+    if (index >= stages.size()) {
+        return;
+    }
+    Stage& stage = stages[index];
+    auto next = [&](const uint8_t* run, size_t count) {
+        runStages(index + 1, run, count);
+    };
+    if (stage.kind == StageKind::Base64) {
+        base64Decode(stage.base64, nullptr, 0, next);
+    } else if (stage.kind == StageKind::Percent) {
+        percentFlush(stage.percent, next);
+    }
+    flushStages(index + 1);
+}
+
+void HttpNormalizer::emitBody(const uint8_t* data, size_t length) {
+    if (bodyCut) {
+        return;
+    }
+    if (bodyBytes + length > config.maxDecodedBytes) {
+        length = static_cast<size_t>(config.maxDecodedBytes - bodyBytes);
+        bodyCut = true;
+        ++stats.truncatedBodies;
+    }
+    bodyBytes += length;
+    if (length > 0) {
+        sink.onNormalized(HttpField::Body, data, length);
+    }
+}
@@ -0,0 +1,25 @@
+#include "packet_inspection/http/http_scanner.hpp"
+
+HttpScanner::HttpScanner(std::shared_ptr<const AcTableMatcher> matcher, HttpNormalizerConfig config)
+    : matcher(std::move(matcher)), normalizer(*this, config) {}
+
+void HttpScanner::reset() {
+    normalizer.reset();
+    state = 0;
+    offset = 0;
+    message = 0;
+}
+
+void HttpScanner::onNormalized(HttpField field, const uint8_t* data, size_t length) {
+    scratch.clear();
+    state = matcher->scanStream(data, length, offset, state, scratch);
+    offset += length;
+    for (const PatternHit& hit : scratch) {
+        hits.push_back({field, hit.patternId, hit.position, message});
+    }
+}
+
+void HttpScanner::onFieldEnd(HttpField) {
+    state = 0;
+    offset = 0;
+}
@@ -0,0 +1,44 @@
+#include "packet_inspection/http/http_spans.hpp"
+
+bool HttpSpanCollector::collect(const uint8_t* data, size_t length) {
+    parser.reset();
+    spans.clear();
+    base = data;
+    baseLength = length;
+    instance = 0;
+    open = false;
+    lastName = HttpSpan::NO_NAME;
+
+    bool valid = parser.feed(data, length);
+    if (valid) {
+        parser.finish();
+    } else {
+        spans.clear();
+    }
+    base = nullptr;
+    return valid;
+}
+
+void HttpSpanCollector::onField(HttpField field, const uint8_t* data, size_t length) {
+    // Runs from the parser's own copy (a token split across feeds) are not in the buffer
+    if (data < base || data + length > base + baseLength) {
+        return;
+    }
+    bool first = !open;
+    if (first) {
+        ++instance;
+        open = true;
+    }
+    uint32_t name = field == HttpField::HeaderValue ? lastName : HttpSpan::NO_NAME;
+    if (field == HttpField::HeaderName && first) {
+        lastName = static_cast<uint32_t>(spans.size());
+    }
+    spans.push_back({field, static_cast<uint32_t>(data - base), static_cast<uint32_t>(length), instance, name});
+}
+
+void HttpSpanCollector::onFieldEnd(HttpField field) {
+    open = false;
+    if (field == HttpField::HeaderValue) {
+        lastName = HttpSpan::NO_NAME;
+    }
+}
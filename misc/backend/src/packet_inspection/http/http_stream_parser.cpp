@@ -0,0 +1,530 @@
+#include "packet_inspection/http/http_stream_parser.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+bool isLineBreak(uint8_t byte) {
+    return byte == '\r' || byte == '\n';
+}
+
+bool isVisible(uint8_t byte) {
+    return byte > 0x20 && byte < 0x7f;
+}
+
+char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c | 0x20) : c;
+}
+
+bool equals(const char* text, size_t length, const char* literal) {
+    return length == std::strlen(literal) && std::memcmp(text, literal, length) == 0;
+}
+
+/**
+ * Call a function for each comma-separated token, trimmed
+ */
+template <typename Callback>
+void forEachToken(const char* text, size_t length, Callback&& callback) {
+    size_t begin = 0;
+    while (begin <= length) {
+        size_t end = begin;
+        while (end < length && text[end] != ',') ++end;
+        size_t first = begin, last = end;
+        while (first < last && (text[first] == ' ' || text[first] == '\t')) ++first;
+        while (last > first && (text[last - 1] == ' ' || text[last - 1] == '\t')) --last;
+        if (last > first) {
+            callback(text + first, last - first);
+        }
+        begin = end + 1;
+    }
+}
+
+HttpCoding codingOf(const char* token, size_t length) {
+    if (equals(token, length, "gzip") || equals(token, length, "x-gzip")) return HttpCoding::Gzip;
+    if (equals(token, length, "deflate")) return HttpCoding::Deflate;
+    if (equals(token, length, "base64")) return HttpCoding::Base64;
+    return HttpCoding::Unknown;
+}
+
+}  // namespace
+
+const char* httpFieldName(HttpField field) {
+    switch (field) {
+        case HttpField::Method: return "method";
+        case HttpField::Uri: return "uri";
+        case HttpField::Version: return "version";
+        case HttpField::Status: return "status";
+        case HttpField::Reason: return "reason";
+        case HttpField::HeaderName: return "headerName";
+        case HttpField::HeaderValue: return "headerValue";
+        case HttpField::Body: return "body";
+    }
+    return "unknown";
+}
+
+void HttpStreamParser::reset() {
+    state = State::FirstToken;
+    inTrailers = false;
+    valueOpen = false;
+    hadBody = false;
+    tokenLength = 0;
+    nameLength = 0;
+    valueLength = 0;
+    remaining = 0;
+    chunkDigits = 0;
+    transferCount = 0;
+    base64Transfer = false;
+    statusCode = 0;
+    info = HttpMessageInfo();
+    messageCount = 0;
+}
+
+bool HttpStreamParser::feed(const uint8_t* data, size_t length) {
+    size_t i = 0;
+    size_t tokenStart = 0;  // Where the first token began in this chunk
+
+    while (i < length && state != State::Failed) {
+        const uint8_t byte = data[i];
+
+        switch (state) {
+            case State::FirstToken: {
+                // Empty lines before a message are allowed
+                if (tokenLength == 0 && isLineBreak(byte)) {
+                    ++i;
+                    break;
+                }
+                if (tokenLength == 0) {
+                    tokenStart = i;
+                }
+                if (byte != ' ') {
+                    if (!isVisible(byte) || tokenLength == TOKEN_MAX) {
+                        fail();
+                        break;
+                    }
+                    token[tokenLength++] = static_cast<char>(byte);
+                    ++i;
+                    break;
+                }
+
+                // The token is complete: a status line starts with the version
+                info.response = tokenLength > 5 && std::memcmp(token, "HTTP/", 5) == 0;
+                HttpField field = info.response ? HttpField::Version : HttpField::Method;
+                if (info.response && !(tokenLength == 8 && std::memcmp(token, "HTTP/1.", 7) == 0)) {
+                    fail();
+                    break;
+                }
+                // Report it from the chunk when it lies inside it, else from the copy
+                const uint8_t* run = tokenStart + tokenLength == i && i >= tokenLength
+                                         ? data + tokenStart
+                                         : reinterpret_cast<const uint8_t*>(token);
+                listener.onField(field, run, tokenLength);
+                listener.onFieldEnd(field);
+                tokenLength = 0;
+                state = info.response ? State::Status : State::Uri;
+                ++i;
+                break;
+            }
+
+            case State::Uri: {
+                size_t end = i;
+                while (end < length && data[end] != ' ' && !isLineBreak(data[end])) ++end;
+                if (end > i) {
+                    listener.onField(HttpField::Uri, data + i, end - i);
+                }
+                i = end;
+                if (i == length) break;
+                if (data[i] != ' ') {
+                    fail();  // HTTP/0.9 request lines are not supported
+                    break;
+                }
+                listener.onFieldEnd(HttpField::Uri);
+                state = State::Version;
+                ++i;
+                break;
+            }
+
+            case State::Version: {
+                size_t end = i;
+                while (end < length && !isLineBreak(data[end])) {
+                    if (tokenLength == TOKEN_MAX) {
+                        fail();
+                        break;
+                    }
+                    token[tokenLength++] = static_cast<char>(data[end++]);
+                }
+                if (state == State::Failed) break;
+                if (end > i) {
+                    listener.onField(HttpField::Version, data + i, end - i);
+                }
+                i = end;
+                if (i == length) break;
+                if (!(tokenLength == 8 && std::memcmp(token, "HTTP/1.", 7) == 0)) {
+                    fail();
+                    break;
+                }
+                listener.onFieldEnd(HttpField::Version);
+                tokenLength = 0;
+                startLineEnd(LineKind::StartLine, data[i]);
+                ++i;
+                break;
+            }
+
+            case State::Status: {
+                if (byte >= '0' && byte <= '9' && tokenLength < 3) {
+                    token[tokenLength++] = static_cast<char>(byte);
+                    listener.onField(HttpField::Status, data + i, 1);
+                    ++i;
+                    break;
+                }
+                if (tokenLength != 3 || (byte != ' ' && !isLineBreak(byte))) {
+                    fail();
+                    break;
+                }
+                statusCode = static_cast<uint16_t>((token[0] - '0') * 100 + (token[1] - '0') * 10 + (token[2] - '0'));
+                tokenLength = 0;
+                listener.onFieldEnd(HttpField::Status);
+                if (byte == ' ') {
+                    state = State::Reason;
+                } else {
+                    startLineEnd(LineKind::StartLine, byte);
+                }
+                ++i;
+                break;
+            }
+
+            case State::Reason: {
+                size_t end = i;
+                while (end < length && !isLineBreak(data[end])) ++end;
+                if (end > i) {
+                    listener.onField(HttpField::Reason, data + i, end - i);
+                }
+                i = end;
+                if (i == length) break;
+                listener.onFieldEnd(HttpField::Reason);
+                startLineEnd(LineKind::StartLine, data[i]);
+                ++i;
+                break;
+            }
+
+            case State::LineEnd: {
+                if (byte != '\n') {
+                    fail();
+                    break;
+                }
+                ++i;
+                lineDone();
+                break;
+            }
+
+            case State::HeaderLineStart: {
+                // A line starting with whitespace continues the previous value (obs-fold)
+                if ((byte == ' ' || byte == '\t') && valueOpen) {
+                    if (valueLength < CAPTURE_MAX) {
+                        value[valueLength++] = ' ';
+                    }
+                    state = State::HeaderValueStart;
+                    ++i;
+                    break;
+                }
+                headerDone();
+                if (isLineBreak(byte)) {
+                    startLineEnd(LineKind::Blank, byte);
+                    ++i;
+                    break;
+                }
+                nameLength = 0;
+                state = State::HeaderName;
+                break;
+            }
+
+            case State::HeaderName: {
+                size_t end = i;
+                while (end < length && data[end] != ':' && isVisible(data[end])) {
+                    if (nameLength < CAPTURE_MAX) {
+                        name[nameLength] = lower(static_cast<char>(data[end]));
+                    }
+                    ++nameLength;
+                    ++end;
+                }
+                if (end > i) {
+                    listener.onField(HttpField::HeaderName, data + i, end - i);
+                }
+                i = end;
+                if (i == length) break;
+                if (data[i] != ':' || nameLength == 0) {
+                    fail();
+                    break;
+                }
+                listener.onFieldEnd(HttpField::HeaderName);
+                valueLength = 0;
+                valueOpen = true;
+                state = State::HeaderValueStart;
+                ++i;
+                break;
+            }
+
+            case State::HeaderValueStart: {
+                if (byte == ' ' || byte == '\t') {
+                    ++i;
+                    break;
+                }
+                state = State::HeaderValue;
+                break;
+            }
+
+            case State::HeaderValue: {
+                size_t end = i;
+                while (end < length && !isLineBreak(data[end])) {
+                    if (valueLength < CAPTURE_MAX) {
+                        value[valueLength] = lower(static_cast<char>(data[end]));
+                    }
+                    ++valueLength;
+                    ++end;
+                }
+                if (end > i) {
+                    listener.onField(HttpField::HeaderValue, data + i, end - i);
+                }
+                i = end;
+                if (i == length) break;
+                startLineEnd(LineKind::Header, data[i]);
+                ++i;
+                break;
+            }
+
+            case State::ChunkSize: {
+                int digit = byte >= '0' && byte <= '9' ? byte - '0'
+                          : byte >= 'a' && byte <= 'f' ? byte - 'a' + 10
+                          : byte >= 'A' && byte <= 'F' ? byte - 'A' + 10 : -1;
+                if (digit >= 0) {
+                    if (++chunkDigits > 15) {
+                        fail();
+                        break;
+                    }
+                    remaining = remaining * 16 + static_cast<uint64_t>(digit);
+                    ++i;
+                    break;
+                }
+                if (chunkDigits == 0) {
+                    fail();
+                    break;
+                }
+                if (isLineBreak(byte)) {
+                    startLineEnd(LineKind::ChunkSize, byte);
+                } else if (byte == ';' || byte == ' ' || byte == '\t') {
+                    state = State::ChunkExtension;
+                } else {
+                    fail();
+                    break;
+                }
+                ++i;
+                break;
+            }
+
+            case State::ChunkExtension: {
+                if (isLineBreak(byte)) {
+                    startLineEnd(LineKind::ChunkSize, byte);
+                }
+                ++i;
+                break;
+            }
+
+            case State::ChunkData:
+            case State::Body: {
+                size_t take = static_cast<size_t>(std::min<uint64_t>(remaining, length - i));
+                listener.onField(HttpField::Body, data + i, take);
+                remaining -= take;
+                i += take;
+                if (remaining == 0) {
+                    if (state == State::Body) {
+                        messageDone();
+                    } else {
+                        state = State::ChunkDataEnd;
+                    }
+                }
+                break;
+            }
+
+            case State::ChunkDataEnd: {
+                if (!isLineBreak(byte)) {
+                    fail();
+                    break;
+                }
+                startLineEnd(LineKind::ChunkDataEnd, byte);
+                ++i;
+                break;
+            }
+
+            case State::BodyUntilClose: {
+                listener.onField(HttpField::Body, data + i, length - i);
+                i = length;
+                break;
+            }
+
+            case State::Failed:
+                break;
+        }
+    }
+    return state != State::Failed;
+}
+
+void HttpStreamParser::startLineEnd(LineKind kind, uint8_t byte) {
+    lineKind = kind;
+    if (byte == '\r') {
+        state = State::LineEnd;
+    } else {
+        lineDone();
+    }
+}
+
+void HttpStreamParser::lineDone() {
+    switch (lineKind) {
+        case LineKind::StartLine:
+            state = State::HeaderLineStart;
+            break;
+        case LineKind::Header:
+            state = State::HeaderLineStart;
+            break;
+        case LineKind::Blank:
+            if (inTrailers) {
+                messageDone();
+            } else {
+                headersDone();
+            }
+            break;
+        case LineKind::ChunkSize:
+            if (remaining == 0) {
+                // Last chunk: the body ends here, before any trailer fields and the blank line
+                if (hadBody) {
+                    hadBody = false;
+                    listener.onFieldEnd(HttpField::Body);
+                }
+                inTrailers = true;
+                state = State::HeaderLineStart;
+            } else {
+                state = State::ChunkData;
+            }
+            break;
+        case LineKind::ChunkDataEnd:
+            chunkDigits = 0;
+            state = State::ChunkSize;
+            break;
+    }
+}
+
+void HttpStreamParser::headerDone() {
+    if (!valueOpen) {
+        return;
+    }
+    valueOpen = false;
+    listener.onFieldEnd(HttpField::HeaderValue);
+    if (inTrailers || nameLength > CAPTURE_MAX) {
+        return;
+    }
+
+    const bool complete = valueLength <= CAPTURE_MAX;
+    const size_t captured = complete ? valueLength : CAPTURE_MAX;
+    if (equals(name, nameLength, "content-length")) {
+        // Trailing whitespace is allowed; anything else makes the framing ambiguous
+        size_t end = captured;
+        while (end > 0 && (value[end - 1] == ' ' || value[end - 1] == '\t')) --end;
+        uint64_t parsed = 0;
+        bool valid = complete && end > 0 && end <= 15;
+        for (size_t k = 0; valid && k < end; ++k) {
+            valid = value[k] >= '0' && value[k] <= '9';
+            parsed = parsed * 10 + static_cast<uint64_t>(value[k] - '0');
+        }
+        if (!valid || (info.hasContentLength && info.contentLength != parsed)) {
+            fail();
+            return;
+        }
+        info.hasContentLength = true;
+        info.contentLength = parsed;
+    } else if (equals(name, nameLength, "transfer-encoding")) {
+        forEachToken(value, captured, [&](const char* token, size_t length) {
+            if (equals(token, length, "chunked")) {
+                info.chunked = true;
+            } else if (!equals(token, length, "identity")) {
+                pushCoding(transferCodings, transferCount, complete ? codingOf(token, length) : HttpCoding::Unknown);
+            }
+        });
+    } else if (equals(name, nameLength, "content-encoding")) {
+        forEachToken(value, captured, [&](const char* token, size_t length) {
+            if (!equals(token, length, "identity")) {
+                pushCoding(info.codings, info.codingCount, complete ? codingOf(token, length) : HttpCoding::Unknown);
+            }
+        });
+    } else if (equals(name, nameLength, "content-transfer-encoding")) {
+        base64Transfer = captured >= 6 && std::memcmp(value, "base64", 6) == 0;
+    } else if (equals(name, nameLength, "content-type")) {
+        static const char FORM[] = "application/x-www-form-urlencoded";
+        info.formEncoded = captured >= sizeof(FORM) - 1 && std::memcmp(value, FORM, sizeof(FORM) - 1) == 0;
+    }
+}
+
+void HttpStreamParser::pushCoding(HttpCoding* stack, uint8_t& count, HttpCoding coding) {
+    if (count == HttpMessageInfo::MAX_CODINGS) {
+        info.tooManyCodings = true;
+        return;
+    }
+    stack[count++] = coding;
+}
+
+void HttpStreamParser::headersDone() {
+    // Content codings were applied first, then transfer codings, then base64
+    for (uint8_t k = 0; k < transferCount; ++k) {
+        pushCoding(info.codings, info.codingCount, transferCodings[k]);
+    }
+    if (base64Transfer) {
+        pushCoding(info.codings, info.codingCount, HttpCoding::Base64);
+    }
+    listener.onHeadersComplete(info);
+
+    remaining = 0;
+    chunkDigits = 0;
+    if (info.chunked) {
+        hadBody = true;
+        state = State::ChunkSize;
+    } else if (info.hasContentLength) {
+        if (info.contentLength == 0) {
+            messageDone();
+        } else {
+            hadBody = true;
+            remaining = info.contentLength;
+            state = State::Body;
+        }
+    } else if (info.response && statusCode >= 200 && statusCode != 204 && statusCode != 304) {
+        hadBody = true;
+        state = State::BodyUntilClose;
+    } else {
+        messageDone();  // A request without framing headers has no body
+    }
+}
+
+void HttpStreamParser::messageDone() {
+    if (hadBody) {
+        listener.onFieldEnd(HttpField::Body);
+    }
+    listener.onMessageEnd();
+    ++messageCount;
+
+    state = State::FirstToken;
+    inTrailers = false;
+    valueOpen = false;
+    hadBody = false;
+    tokenLength = 0;
+    statusCode = 0;
+    transferCount = 0;
+    base64Transfer = false;
+    info = HttpMessageInfo();
+}
+
+void HttpStreamParser::finish() {
+    if (state == State::BodyUntilClose) {
+        messageDone();
+    } else if (state == State::Body || state == State::ChunkData || state == State::ChunkDataEnd ||
+               state == State::ChunkSize || state == State::ChunkExtension) {
+        // Truncated body: end the field so decoders flush what they hold
+        hadBody = false;
+        listener.onFieldEnd(HttpField::Body);
+    }
+}
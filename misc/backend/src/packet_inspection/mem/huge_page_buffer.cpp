@@ -0,0 +1,183 @@
+#include "packet_inspection/mem/huge_page_buffer.hpp"
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+size_t roundUp(size_t value, size_t to) {
+    return (value + to - 1) / to * to;
+}
+
+} // namespace
+
+HugePageBuffer::~HugePageBuffer() {
+    release();
+}
+
+HugePageBuffer::HugePageBuffer(HugePageBuffer&& other) noexcept {
+    *this = std::move(other);
+}
+
+HugePageBuffer& HugePageBuffer::operator=(HugePageBuffer&& other) noexcept {
+    if (this != &other) {
+        release();
+        std::swap(mapping, other.mapping);
+        std::swap(mappingLength, other.mappingLength);
+        std::swap(start, other.start);
+        std::swap(length, other.length);
+        std::swap(obtained, other.obtained);
+    }
+    return *this;
+}
+
+const char* HugePageBuffer::backingName(PageBacking backing) {
+    switch (backing) {
+        case PageBacking::Small: return "off";
+        case PageBacking::Transparent: return "thp";
+        case PageBacking::Explicit: return "hugetlb";
+        default: return "unknown";
+    }
+}
+
+PageBacking HugePageBuffer::configuredBacking(size_t bytes) {
+    if (const char* env = std::getenv("PKTINSPECT_HUGEPAGES")) {
+        std::string value(env);
+        if (value == "off" || value == "0") return PageBacking::Small;
+        if (value == "thp") return PageBacking::Transparent;
+        if (value == "hugetlb") return PageBacking::Explicit;
+        fprintf(stderr, "Error: Unknown PKTINSPECT_HUGEPAGES value: %s\n", env);
+    }
+    return bytes >= HUGE_PAGE_SIZE ? PageBacking::Transparent : PageBacking::Small;
+}
+
+bool HugePageBuffer::prefaultEnabled() {
+    const char* env = std::getenv("PKTINSPECT_PREFAULT");
+    return !env || std::string(env) != "0";
+}
+
+#ifdef __linux__
+
+bool HugePageBuffer::allocate(size_t bytes, PageBacking backing, bool prefault) {
+    release();
+    if (bytes == 0) return false;
+
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+
+    if (backing == PageBacking::Explicit) {
+        const size_t mapped = roundUp(bytes, HUGE_PAGE_SIZE);
+        void* p = mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (prefault ? MAP_POPULATE : 0), -1, 0);
+        if (p != MAP_FAILED) {
+            mapping = start = p;
+            mappingLength = mapped;
+            length = bytes;
+            obtained = PageBacking::Explicit;
+            return true;
+        }
+        fprintf(stderr, "Warning: MAP_HUGETLB failed (is vm.nr_hugepages set?), using transparent huge pages\n");
+        backing = PageBacking::Transparent;
+    }
+
+    // Over-allocate so the buffer can start on a huge page boundary
+    const bool huge = backing == PageBacking::Transparent;
+    const size_t bufferLength = roundUp(bytes, huge ? HUGE_PAGE_SIZE : pageSize);
+    const size_t mapped = bufferLength + (huge ? HUGE_PAGE_SIZE : 0);
+    void* p = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        fprintf(stderr, "Error: mmap of %zu bytes failed: %s\n", mapped, strerror(errno));
+        return false;
+    }
+    mapping = p;
+    mappingLength = mapped;
+    start = huge ? reinterpret_cast<void*>(roundUp(reinterpret_cast<uintptr_t>(p), HUGE_PAGE_SIZE)) : p;
+    length = bytes;
+    obtained = PageBacking::Small;
+
+#ifdef MADV_HUGEPAGE
+    if (huge && madvise(start, bufferLength, MADV_HUGEPAGE) == 0) {
+        obtained = PageBacking::Transparent;
+    }
+#endif
+#ifdef MADV_NOHUGEPAGE
+    if (!huge) {
+        madvise(start, bufferLength, MADV_NOHUGEPAGE);
+    }
+#endif
+
+    if (prefault) {
+        volatile uint8_t* bytesOut = static_cast<volatile uint8_t*>(start);
+        for (size_t offset = 0; offset < bufferLength; offset += pageSize) {
+            bytesOut[offset] = 0;
+        }
+    }
+    return true;
+}
+
+void HugePageBuffer::release() {
+    if (mapping) {
+        munmap(mapping, mappingLength);
+    }
+    mapping = start = nullptr;
+    mappingLength = length = 0;
+    obtained = PageBacking::Small;
+}
+
+size_t HugePageBuffer::hugePageBytes() const {
+    if (!start) return 0;
+    if (obtained == PageBacking::Explicit) return roundUp(length, HUGE_PAGE_SIZE);
+
+    FILE* smaps = fopen("/proc/self/smaps", "r");
+    if (!smaps) return 0;
+
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(start);
+    const uintptr_t end = begin + length;
+    size_t total = 0;
+    bool inRange = false;
+    char line[256];
+    while (fgets(line, sizeof(line), smaps)) {
+        unsigned long low;
+        unsigned long high;
+        if (sscanf(line, "%lx-%lx ", &low, &high) == 2) {
+            inRange = low < end && high > begin;
+            continue;
+        }
+        size_t kb;
+        if (inRange && sscanf(line, "AnonHugePages: %zu kB", &kb) == 1) {
+            total += kb * 1024;
+        }
+    }
+    fclose(smaps);
+    return total;
+}
+
+#else
+
+bool HugePageBuffer::allocate(size_t bytes, PageBacking, bool) {
+    release();
+    if (bytes == 0) return false;
+    start = mapping = std::calloc(1, bytes);
+    length = mappingLength = bytes;
+    obtained = PageBacking::Small;
+    return start != nullptr;
+}
+
+void HugePageBuffer::release() {
+    std::free(mapping);
+    mapping = start = nullptr;
+    mappingLength = length = 0;
+}
+
+size_t HugePageBuffer::hugePageBytes() const {
+    return 0;
+}
+
+#endif
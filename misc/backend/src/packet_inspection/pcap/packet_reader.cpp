@@ -1,10 +1,11 @@
 #include "packet_inspection/pcap/packet_reader.hpp"
+#include "packet_inspection/simd/simd_kernels.hpp"
+#include "packet_inspection/trace/tracer.hpp"
 #include <cstdio>
 #include <cstring>
 #include <algorithm>
 #include <cctype>
-#include <sstream>
-#include <iomanip>
+#include <stdexcept>
 
 /**
  * PCAP File Structure:
@@ -19,6 +20,7 @@
 #define PCAP_MAGIC_SWAPPED 0xd4c3b2a1
 
 std::vector<Packet> PacketReader::readPcapFile(const std::string& pcapFilePath) {
+    PI_TRACE_SCOPE("pcap.read");
     std::vector<Packet> packets;
     FILE* file = fopen(pcapFilePath.c_str(), "rb");
     
@@ -67,6 +69,124 @@ std::vector<Packet> PacketReader::readPcapFile(const std::string& pcapFilePath)
     return packets;
 }
 
+int64_t PacketReader::forEachPayload(const std::string& pcapFilePath,
+                                     const std::function<void(const PacketView&)>& callback) {
+    PI_TRACE_SCOPE("pcap.forEachPayload");
+    return forEachFrame(pcapFilePath, [&](const PacketView& frame) {
+        uint32_t payloadLength = 0;
+        const uint8_t* payload = locateTcpPayload(frame.payload, frame.payloadLength, payloadLength);
+        if (payload) {
+            callback(PacketView{frame.packetId, frame.timestamp, payload, payloadLength});
+        }
+    });
+}
+
+int64_t PacketReader::forEachFrame(const std::string& pcapFilePath,
+                                   const std::function<void(const PacketView&)>& callback) {
+    CaptureCursor cursor;
+    int64_t bytesRead = openCapture(pcapFilePath, cursor);
+    if (bytesRead < 0) {
+        return -1;
+    }
+
+    PacketView frame;
+    while (nextFrame(cursor, frame)) {
+        callback(frame);
+    }
+    return bytesRead;
+}
+
+int64_t PacketReader::openCapture(const std::string& pcapFilePath, CaptureCursor& cursor) {
+    cursor = CaptureCursor();
+    FILE* file = fopen(pcapFilePath.c_str(), "rb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not open PCAP file: %s\n", pcapFilePath.c_str());
+        return -1;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    const uint32_t GLOBAL_HEADER_SIZE = 24;
+
+    if (fileSize < static_cast<long>(GLOBAL_HEADER_SIZE)) {
+        fprintf(stderr, "Error: Invalid PCAP file header\n");
+        fclose(file);
+        return -1;
+    }
+
+    size_t bytesRead;
+    {
+        PI_TRACE_SCOPE_ARG("pcap.load", static_cast<uint64_t>(fileSize));
+        fileBuffer.resize(static_cast<size_t>(fileSize));
+        bytesRead = fread(fileBuffer.data(), 1, fileBuffer.size(), file);
+        fclose(file);
+    }
+
+    uint32_t magic;
+    memcpy(&magic, fileBuffer.data(), sizeof(magic));
+    if (magic != PCAP_MAGIC && magic != PCAP_MAGIC_SWAPPED) {
+        fprintf(stderr, "Error: Invalid PCAP file header\n");
+        return -1;
+    }
+
+    cursor.offset = GLOBAL_HEADER_SIZE;
+    cursor.end = bytesRead;
+    cursor.swapped = (magic == PCAP_MAGIC_SWAPPED);
+    return static_cast<int64_t>(bytesRead);
+}
+
+bool PacketReader::nextFrame(CaptureCursor& cursor, PacketView& frame) const {
+    const uint32_t PACKET_HEADER_SIZE = 16;
+    const uint32_t MAX_PACKET_SIZE = 65535;
+    const uint8_t* data = fileBuffer.data();
+
+    auto readField = [&](size_t offset) {
+        uint32_t value;
+        memcpy(&value, data + offset, sizeof(value));
+        return cursor.swapped ? __builtin_bswap32(value) : value;
+    };
+
+    while (cursor.offset + PACKET_HEADER_SIZE <= cursor.end) {
+        uint32_t timestamp = readField(cursor.offset);
+        uint32_t inclLen = readField(cursor.offset + 8);
+        cursor.offset += PACKET_HEADER_SIZE;
+
+        if (inclLen == 0 || inclLen > MAX_PACKET_SIZE) {
+            fprintf(stderr, "Warning: Skipping packet with invalid length: %u\n", inclLen);
+            continue;
+        }
+        if (cursor.offset + inclLen > cursor.end) {
+            fprintf(stderr, "Error: Could not read packet data\n");
+            cursor.offset = cursor.end;
+            return false;
+        }
+
+        frame = PacketView{cursor.packetId, timestamp, data + cursor.offset, inclLen};
+        cursor.offset += inclLen;
+        cursor.packetId++;
+        return true;
+    }
+    return false;
+}
+
+const uint8_t* PacketReader::locateTcpPayload(const uint8_t* packetData, uint32_t packetLength,
+                                              uint32_t& payloadLength) const {
+    payloadLength = 0;
+    if (!isValidTcpPacket(packetData, packetLength)) {
+        return nullptr;
+    }
+
+    uint32_t payloadStart = findTcpPayloadStart(packetData, packetLength);
+    if (payloadStart >= packetLength) {
+        return nullptr;
+    }
+
+    payloadLength = packetLength - payloadStart;
+    return packetData + payloadStart;
+}
+
 bool PacketReader::parsePcapHeader(FILE* file) {
     uint32_t magic;
     if (fread(&magic, sizeof(uint32_t), 1, file) != 1) {
@@ -89,6 +209,7 @@ bool PacketReader::parsePcapHeader(FILE* file) {
 
 Packet PacketReader::extractTcpPayload(const uint8_t* packetData, uint32_t packetLength, 
                                        uint32_t packetId, uint32_t timestamp) {
+    PI_TRACE_SCOPE("pcap.decode");
     Packet packet;
     packet.packetId = packetId;
     packet.timestamp = timestamp;
@@ -184,16 +305,38 @@ uint32_t PacketReader::findTcpPayloadStart(const uint8_t* packetData, uint32_t p
 }
 
 std::string PacketReader::bytesToHex(const std::vector<uint8_t>& data) {
-    std::stringstream ss;
-    for (uint8_t byte : data) {
-        ss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(byte);
+    return bytesToHex(data.data(), data.size());
+}
+
+std::string PacketReader::bytesToHex(const uint8_t* data, size_t length) {
+    std::string hex(length * 2, '\0');
+    CpuDispatch::kernels().hexEncode(data, length, hex.data());
+    return hex;
+}
+
+std::string PacketReader::hexToBytes(const std::string& hex) {
+    auto digit = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        throw std::invalid_argument(std::string("invalid hex digit '") + c + "'");
+    };
+    std::string bytes;
+    bytes.reserve(hex.size() / 2);
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        bytes += static_cast<char>(digit(hex[i]) << 4 | digit(hex[i + 1]));
     }
-    return ss.str();
+    return bytes;
 }
 
 std::string PacketReader::bytesToAscii(const std::vector<uint8_t>& data) {
+    return bytesToAscii(data.data(), data.size());
+}
+
+std::string PacketReader::bytesToAscii(const uint8_t* data, size_t length) {
     std::string ascii;
-    for (uint8_t byte : data) {
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t byte = data[i];
         if (std::isprint(byte)) {
             ascii += static_cast<char>(byte);
         } else {
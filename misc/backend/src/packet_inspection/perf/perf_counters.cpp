@@ -0,0 +1,178 @@
+#include "packet_inspection/perf/perf_counters.hpp"
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+PerfCounts& PerfCounts::operator+=(const PerfCounts& other) {
+    for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        values[i] += other.values[i];
+    }
+    availableMask |= other.availableMask;
+    return *this;
+}
+
+json PerfCounts::toJson(uint64_t bytes, uint64_t packets) const {
+    json output;
+    for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        PerfEvent event = static_cast<PerfEvent>(i);
+        if (!has(event)) {
+            continue;
+        }
+        json entry;
+        entry["total"] = values[i];
+        entry["perByte"] = bytes ? static_cast<double>(values[i]) / static_cast<double>(bytes) : 0.0;
+        entry["perPacket"] = packets ? static_cast<double>(values[i]) / static_cast<double>(packets) : 0.0;
+        output[PerfCounters::eventName(event)] = entry;
+    }
+    if (has(PerfEvent::Cycles) && has(PerfEvent::Instructions) && get(PerfEvent::Cycles) > 0) {
+        output["ipc"] = static_cast<double>(get(PerfEvent::Instructions)) /
+                        static_cast<double>(get(PerfEvent::Cycles));
+    }
+    output["bytes"] = bytes;
+    output["packets"] = packets;
+    return output;
+}
+
+const char* PerfCounters::eventName(PerfEvent event) {
+    switch (event) {
+        case PerfEvent::Cycles: return "cycles";
+        case PerfEvent::Instructions: return "instructions";
+        case PerfEvent::L1DMisses: return "l1dMisses";
+        case PerfEvent::LLCMisses: return "llcMisses";
+        case PerfEvent::BranchMisses: return "branchMisses";
+        case PerfEvent::DTLBMisses: return "dtlbMisses";
+        default: return "unknown";
+    }
+}
+
+#ifdef __linux__
+
+namespace {
+
+void describeEvent(PerfEvent event, perf_event_attr& attr) {
+    switch (event) {
+        case PerfEvent::Cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfEvent::Instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfEvent::L1DMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D |
+                          (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case PerfEvent::LLCMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case PerfEvent::BranchMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PerfEvent::DTLBMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                          (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        default:
+            break;
+    }
+}
+
+} // namespace
+
+PerfCounters::~PerfCounters() {
+    for (int& fd : fds) {
+        if (fd >= 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+}
+
+bool PerfCounters::open() {
+    if (groupFd >= 0) {
+        return true;
+    }
+
+    for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        describeEvent(static_cast<PerfEvent>(i), attr);
+        attr.disabled = (groupFd < 0) ? 1 : 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                           PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0));
+        if (fd < 0) {
+            continue;  // Event not supported here (common in VMs); skip it
+        }
+        fds[i] = fd;
+        ioctl(fd, PERF_EVENT_IOC_ID, &eventIds[i]);
+        availableMask |= 1u << i;
+        if (groupFd < 0) {
+            groupFd = fd;
+        }
+    }
+
+    return groupFd >= 0;
+}
+
+void PerfCounters::start() {
+    if (groupFd < 0) return;
+    ioctl(groupFd, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(groupFd, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounts PerfCounters::stop() {
+    PerfCounts counts;
+    if (groupFd < 0) return counts;
+    ioctl(groupFd, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    // Layout: nr, time_enabled, time_running, then {value, id} per event
+    uint64_t buffer[3 + 2 * PERF_EVENT_COUNT];
+    ssize_t bytes = read(groupFd, buffer, sizeof(buffer));
+    if (bytes < static_cast<ssize_t>(3 * sizeof(uint64_t))) {
+        return counts;
+    }
+
+    uint64_t nr = buffer[0];
+    uint64_t enabled = buffer[1];
+    uint64_t running = buffer[2];
+    double scale = (running > 0 && running < enabled)
+                       ? static_cast<double>(enabled) / static_cast<double>(running) : 1.0;
+
+    for (uint64_t n = 0; n < nr && n < PERF_EVENT_COUNT; ++n) {
+        uint64_t value = buffer[3 + 2 * n];
+        uint64_t id = buffer[3 + 2 * n + 1];
+        for (size_t i = 0; i < PERF_EVENT_COUNT; ++i) {
+            if (fds[i] >= 0 && eventIds[i] == id) {
+                counts.values[i] = static_cast<uint64_t>(static_cast<double>(value) * scale);
+            }
+        }
+    }
+    counts.availableMask = availableMask;
+    return counts;
+}
+
+#else
+
+PerfCounters::~PerfCounters() = default;
+bool PerfCounters::open() { return false; }
+void PerfCounters::start() {}
+PerfCounts PerfCounters::stop() { return PerfCounts(); }
+
+#endif
@@ -0,0 +1,169 @@
+#include "packet_inspection/pipeline/flow_table.hpp"
+#include <cstring>
+#include <utility>
+
+namespace {
+
+const uint8_t PROTO_TCP = 6;
+const uint8_t PROTO_UDP = 17;
+
+uint64_t load64(const uint8_t* p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+// 64-bit finalizer (MurmurHash3 fmix64)
+uint64_t mix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+} // namespace
+
+bool FlowKey::operator==(const FlowKey& other) const {
+    return version == other.version && protocol == other.protocol &&
+           lowPort == other.lowPort && highPort == other.highPort &&
+           memcmp(lowAddress, other.lowAddress, sizeof(lowAddress)) == 0 &&
+           memcmp(highAddress, other.highAddress, sizeof(highAddress)) == 0;
+}
+
+uint32_t flowHash(const FlowKey& key) {
+    uint64_t h = mix64((static_cast<uint64_t>(key.lowPort) << 32) | (static_cast<uint64_t>(key.highPort) << 16) |
+                       (static_cast<uint64_t>(key.protocol) << 8) | key.version);
+    // IPv4 keys only use the first 4 bytes of each address (the rest is zero)
+    size_t words = key.version == 6 ? 2 : 1;
+    for (size_t i = 0; i < words; ++i) {
+        h = mix64(h ^ load64(key.lowAddress + 8 * i));
+        h = mix64(h ^ load64(key.highAddress + 8 * i));
+    }
+    return static_cast<uint32_t>(h ^ (h >> 32));
+}
+
+bool extractFlow(const uint8_t* frame, uint32_t length, FlowKey& key, uint32_t& hash) {
+    if (length < 1) {
+        return false;
+    }
+
+    uint8_t tuple[32];
+    size_t addressLength;
+    uint32_t transportStart;
+    uint8_t version = frame[0] >> 4;
+
+    if (version == 4) {
+        uint32_t headerLength = (frame[0] & 0x0F) * 4u;
+        if (length < 20 || headerLength < 20) {
+            return false;
+        }
+        key.protocol = frame[9];
+        addressLength = 4;
+        memcpy(tuple, frame + 12, 8);
+        transportStart = headerLength;
+    } else if (version == 6) {
+        if (length < 40) {
+            return false;
+        }
+        key.protocol = frame[6];  // Extension headers are not followed
+        addressLength = 16;
+        memcpy(tuple, frame + 8, 32);
+        transportStart = 40;
+    } else {
+        return false;
+    }
+
+    if ((key.protocol != PROTO_TCP && key.protocol != PROTO_UDP) || transportStart + 4 > length) {
+        return false;
+    }
+
+    const uint8_t* source = tuple;
+    const uint8_t* destination = tuple + addressLength;
+    uint16_t sourcePort = static_cast<uint16_t>((frame[transportStart] << 8) | frame[transportStart + 1]);
+    uint16_t destinationPort = static_cast<uint16_t>((frame[transportStart + 2] << 8) | frame[transportStart + 3]);
+
+    int order = memcmp(source, destination, addressLength);
+    bool swap = order > 0 || (order == 0 && sourcePort > destinationPort);
+    if (swap) {
+        std::swap(source, destination);
+        std::swap(sourcePort, destinationPort);
+    }
+
+    key.version = version;
+    memset(key.lowAddress, 0, sizeof(key.lowAddress));
+    memset(key.highAddress, 0, sizeof(key.highAddress));
+    memcpy(key.lowAddress, source, addressLength);
+    memcpy(key.highAddress, destination, addressLength);
+    key.lowPort = sourcePort;
+    key.highPort = destinationPort;
+    hash = flowHash(key);
+    return true;
+}
+
+FlowTable::FlowTable(size_t initialCapacity) {
+    size_t capacity = 16;
+    while (capacity < initialCapacity) {
+        capacity <<= 1;
+    }
+    // Slots are allocated lazily by the first insert (on the owning thread)
+    mask = capacity - 1;
+}
+
+FlowState* FlowTable::find(const FlowKey& key, uint32_t hash) {
+    if (slots.empty()) {
+        return nullptr;
+    }
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        FlowState& slot = slots[i];
+        if (slot.key.version == 0) {
+            return nullptr;
+        }
+        if (slot.hash == hash && slot.key == key) {
+            return &slot;
+        }
+    }
+}
+
+FlowState& FlowTable::findOrInsert(const FlowKey& key, uint32_t hash, uint32_t timestamp) {
+    if (slots.empty()) {
+        slots.resize(mask + 1);
+    } else if ((count + 1) * 2 > slots.size()) {
+        grow();
+    }
+
+    size_t i = hash & mask;
+    for (;; i = (i + 1) & mask) {
+        FlowState& slot = slots[i];
+        if (slot.key.version == 0) {
+            break;
+        }
+        if (slot.hash == hash && slot.key == key) {
+            return slot;
+        }
+    }
+
+    FlowState& slot = slots[i];
+    slot.key = key;
+    slot.hash = hash;
+    slot.firstSeen = timestamp;
+    slot.lastSeen = timestamp;
+    ++count;
+    return slot;
+}
+
+void FlowTable::grow() {
+    std::vector<FlowState> old;
+    old.swap(slots);
+    slots.resize(old.size() * 2);
+    mask = slots.size() - 1;
+    for (const FlowState& entry : old) {
+        if (entry.key.version == 0) continue;
+        size_t i = entry.hash & mask;
+        while (slots[i].key.version != 0) {
+            i = (i + 1) & mask;
+        }
+        slots[i] = entry;
+    }
+}
@@ -0,0 +1,618 @@
+#include "packet_inspection/pipeline/packet_pipeline.hpp"
+#include "packet_inspection/trace/tracer.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+/**
+ * Read the CPUs of a NUMA node from sysfs ("0-3,8-11" style list)
+ * @return CPU ids, empty if the node does not exist
+ */
+std::vector<int> numaNodeCpus(int node) {
+    std::vector<int> cpus;
+    std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    if (!in.is_open() || !std::getline(in, list)) {
+        return cpus;
+    }
+    size_t start = 0;
+    while (start < list.size()) {
+        size_t comma = list.find(',', start);
+        std::string range = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        size_t dash = range.find('-');
+        int first = std::atoi(range.c_str());
+        int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    return cpus;
+}
+
+} // namespace
+
+const char* PipelineConfig::dispatchName(Dispatch dispatch) {
+    switch (dispatch) {
+        case Dispatch::Batch: return "batch";
+        case Dispatch::Flow: return "flow";
+        case Dispatch::Steal: return "steal";
+    }
+    return "unknown";
+}
+
+unsigned PipelineConfig::defaultWorkers() {
+    unsigned threads = std::thread::hardware_concurrency();
+    return threads > 3 ? threads - 3 : 1;
+}
+
+PipelineConfig PipelineConfig::fromEnvironment() {
+    PipelineConfig config;
+    if (const char* value = std::getenv("PKTINSPECT_PIPELINE_WORKERS")) {
+        config.workers = static_cast<unsigned>(std::max(1ul, std::strtoul(value, nullptr, 10)));
+    }
+    if (const char* value = std::getenv("PKTINSPECT_PIPELINE_RING")) {
+        config.ringCapacity = std::max(2ul, std::strtoul(value, nullptr, 10));
+    }
+    if (const char* value = std::getenv("PKTINSPECT_PIPELINE_BATCH")) {
+        config.batchSize = std::max(1ul, std::strtoul(value, nullptr, 10));
+    }
+    if (const char* value = std::getenv("PKTINSPECT_PIPELINE_NUMA")) {
+        config.numaNode = std::atoi(value);
+    }
+    if (const char* value = std::getenv("PKTINSPECT_PIPELINE_DISPATCH")) {
+        std::string name(value);
+        if (name == "batch") {
+            config.dispatch = Dispatch::Batch;
+        } else if (name == "flow") {
+            config.dispatch = Dispatch::Flow;
+        } else if (name == "steal") {
+            config.dispatch = Dispatch::Steal;
+        } else {
+            fprintf(stderr, "Warning: Unknown PKTINSPECT_PIPELINE_DISPATCH '%s', using %s\n", value,
+                    dispatchName(config.dispatch));
+        }
+    }
+    if (const char* value = std::getenv("PKTINSPECT_PIPELINE_CPUS")) {
+        std::string list(value);
+        size_t start = 0;
+        while (start <= list.size()) {
+            size_t comma = list.find(',', start);
+            std::string item = list.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+            config.cpus.push_back(item.empty() ? -1 : std::atoi(item.c_str()));
+            if (comma == std::string::npos) break;
+            start = comma + 1;
+        }
+    }
+    return config;
+}
+
+PacketPipeline::PacketPipeline(std::shared_ptr<const Matcher> matcher, PipelineConfig config)
+    : matcher(std::move(matcher)),
+      config(config),
+      freeRing(config.ringCapacity),
+      decodeRing(config.ringCapacity) {
+    this->config.workers = std::max(1u, config.workers);
+    this->config.batchSize = std::max<size_t>(1, std::min(config.batchSize, decodeRing.capacity()));
+
+    // One descriptor per ring slot: nothing in flight can overflow any ring
+    packets.resize(decodeRing.capacity());
+    for (unsigned i = 0; i < this->config.workers; ++i) {
+        workRings.push_back(std::make_unique<SpscRing<uint32_t>>(config.ringCapacity));
+        resultRings.push_back(std::make_unique<SpscRing<uint32_t>>(config.ringCapacity));
+        flowTables.emplace_back();
+        stealDeques.push_back(std::make_unique<WorkStealingDeque<uint32_t>>(packets.size()));
+        flowBuckets.emplace_back();
+        flowBuckets.back().reserve(this->config.batchSize);
+    }
+    for (unsigned i = 0; i < this->config.workers + 3; ++i) {
+        counters.push_back(std::make_unique<StageCounters>());
+    }
+    if (config.numaNode >= 0) {
+        numaCpus = numaNodeCpus(config.numaNode);
+        if (numaCpus.empty()) {
+            fprintf(stderr, "Warning: NUMA node %d not found, pipeline workers left unpinned\n", config.numaNode);
+        }
+    }
+}
+
+void PacketPipeline::pushAll(SpscRing<uint32_t>& ring, const uint32_t* items, size_t count,
+                             StageCounters& stage) {
+    Backoff backoff;
+    while (count > 0) {
+        size_t pushed = ring.pushBatch(items, count);
+        if (pushed == 0) {
+            bump(stage.stalls, 1);
+            backoff.pause();
+            continue;
+        }
+        backoff.reset();
+        items += pushed;
+        count -= pushed;
+    }
+}
+
+void PacketPipeline::pinStage(size_t stageIndex) const {
+    int cpu = stageIndex < config.cpus.size() ? config.cpus[stageIndex] : -1;
+    bool isWorker = stageIndex >= 2 && stageIndex < 2 + config.workers;
+    if (cpu < 0 && isWorker && !numaCpus.empty()) {
+        cpu = numaCpus[(stageIndex - 2) % numaCpus.size()];
+    }
+    if (cpu < 0) {
+        return;
+    }
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        fprintf(stderr, "Warning: Could not pin pipeline stage %zu to CPU %d\n", stageIndex, cpu);
+    }
+#endif
+}
+
+void PacketPipeline::dispatchByFlow(const uint32_t* batch, size_t count, StageCounters& stage) {
+    for (size_t i = 0; i < count; ++i) {
+        const PipelinePacket& packet = packets[batch[i]];
+        // Packets without a flow carry no per-flow state, so any fixed worker will do
+        unsigned worker = packet.hasFlow ? flowWorker(packet.flowHash, config.workers) : 0;
+        flowBuckets[worker].push_back(batch[i]);
+    }
+    // A flow cannot move to another worker, so a full ring is waited out
+    for (unsigned worker = 0; worker < config.workers; ++worker) {
+        std::vector<uint32_t>& bucket = flowBuckets[worker];
+        if (!bucket.empty()) {
+            pushAll(*workRings[worker], bucket.data(), bucket.size(), stage);
+            bucket.clear();
+        }
+    }
+}
+
+int64_t PacketPipeline::run(const std::string& pcapPath, const Sink& sink, const CancelToken* cancel) {
+    if (started.exchange(true)) {
+        fprintf(stderr, "Error: PacketPipeline::run() called twice\n");
+        return -1;
+    }
+    PI_TRACE_SCOPE("pipeline.run");
+    this->cancel = cancel;
+
+    // Every descriptor starts out free
+    std::vector<uint32_t> all(packets.size());
+    for (uint32_t i = 0; i < all.size(); ++i) {
+        all[i] = i;
+    }
+    freeRing.pushBatch(all.data(), all.size());
+    startNs.store(Tracer::nowNs(), std::memory_order_relaxed);
+
+    int64_t bytesRead = -1;
+    std::vector<std::thread> threads;
+    threads.emplace_back([this, &pcapPath, &bytesRead]() { readerStage(pcapPath, bytesRead); });
+    threads.emplace_back([this]() { decoderStage(); });
+    for (unsigned i = 0; i < config.workers; ++i) {
+        threads.emplace_back([this, i]() { workerStage(i); });
+    }
+    threads.emplace_back([this, &sink]() { sinkStage(sink); });
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    endNs.store(Tracer::nowNs(), std::memory_order_relaxed);
+    if (cancel) {
+        stopReason.store(static_cast<uint8_t>(cancel->reason()), std::memory_order_relaxed);
+    }
+    this->cancel = nullptr;
+    finished.store(true, std::memory_order_release);
+    return bytesRead;
+}
+
+void PacketPipeline::readerStage(const std::string& pcapPath, int64_t& bytesRead) {
+    pinStage(0);
+    StageCounters& stage = *counters[0];
+    const size_t batch = config.batchSize;
+    std::vector<uint32_t> freeSlots(batch);
+    size_t freeNext = 0, freeCount = 0;
+    std::vector<uint32_t> pending;
+    pending.reserve(batch);
+    uint64_t sequence = 0;
+    Backoff backoff;
+
+    CaptureCursor cursor;
+    bytesRead = reader.openCapture(pcapPath, cursor);
+    PacketView frame;
+    while (bytesRead >= 0 && reader.nextFrame(cursor, frame)) {
+        while (freeNext == freeCount) {
+            freeCount = freeRing.popBatch(freeSlots.data(), batch);
+            freeNext = 0;
+            if (freeCount == 0) {
+                // Every descriptor is downstream: flush what we hold, then wait
+                if (!pending.empty()) {
+                    pushAll(decodeRing, pending.data(), pending.size(), stage);
+                    bump(stage.batches, 1);
+                    pending.clear();
+                }
+                bump(stage.stalls, 1);
+                backoff.pause();
+            }
+        }
+        backoff.reset();
+
+        uint32_t slot = freeSlots[freeNext++];
+        PipelinePacket& packet = packets[slot];
+        packet.sequence = sequence++;
+        packet.packetId = frame.packetId;
+        packet.timestamp = frame.timestamp;
+        packet.frame = frame.payload;
+        packet.frameLength = frame.payloadLength;
+        packet.payload = nullptr;
+        packet.payloadLength = 0;
+        pending.push_back(slot);
+        bump(stage.processed, 1);
+
+        if (pending.size() == batch) {
+            pushAll(decodeRing, pending.data(), pending.size(), stage);
+            bump(stage.batches, 1);
+            pending.clear();
+            // The rest of the capture is never read once the run is stopped
+            if (CancelToken::stopRequested(cancel)) {
+                break;
+            }
+        }
+    }
+
+    if (!pending.empty()) {
+        pushAll(decodeRing, pending.data(), pending.size(), stage);
+        bump(stage.batches, 1);
+    }
+    // Free slots still held here are simply not reused; the run is over
+    decodeRing.close();
+}
+
+void PacketPipeline::decoderStage() {
+    pinStage(1);
+    StageCounters& stage = *counters[1];
+    std::vector<uint32_t> batch(config.batchSize);
+    PacketReader decoder;
+    unsigned nextWorker = 0;
+    const bool flowDispatch = config.dispatch == PipelineConfig::Dispatch::Flow;
+    Backoff backoff;
+
+    for (;;) {
+        size_t count = decodeRing.popBatch(batch.data(), batch.size());
+        if (count == 0) {
+            if (decodeRing.isDrained()) break;
+            bump(stage.idlePolls, 1);
+            backoff.pause();
+            continue;
+        }
+        backoff.reset();
+        raise(stage.maxInputDepth, decodeRing.size() + count);
+
+        if (CancelToken::stopRequested(cancel)) {
+            // No payload: workers and the sink pass the descriptor straight through
+            for (size_t i = 0; i < count; ++i) {
+                packets[batch[i]].payload = nullptr;
+                packets[batch[i]].hasFlow = false;
+            }
+            bump(stage.dropped, count);
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                PipelinePacket& packet = packets[batch[i]];
+                packet.payload = decoder.locateTcpPayload(packet.frame, packet.frameLength, packet.payloadLength);
+                packet.hasFlow = flowDispatch && extractFlow(packet.frame, packet.frameLength, packet.flow, packet.flowHash);
+            }
+        }
+
+        if (flowDispatch && config.workers > 1) {
+            dispatchByFlow(batch.data(), count, stage);
+        } else {
+            // Round-robin by batch; a full worker ring passes the rest to the next worker
+            size_t offset = 0;
+            Backoff full;
+            while (offset < count) {
+                size_t pushed = workRings[nextWorker]->pushBatch(batch.data() + offset, count - offset);
+                offset += pushed;
+                if (offset < count) {
+                    bump(stage.stalls, 1);
+                    if (pushed == 0) full.pause();
+                }
+                nextWorker = (nextWorker + 1) % config.workers;
+            }
+        }
+        bump(stage.processed, count);
+        bump(stage.batches, 1);
+    }
+
+    for (auto& ring : workRings) {
+        ring->close();
+    }
+}
+
+bool PacketPipeline::stealPacket(unsigned thief, VictimPicker& victims, uint32_t& slot) {
+    StageCounters& stage = *counters[2 + thief];
+    for (unsigned attempt = 0; attempt < config.workers; ++attempt) {
+        if (stealDeques[victims.next()]->steal(slot)) {
+            bump(stage.steals, 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PacketPipeline::workersDrained() const {
+    for (unsigned i = 0; i < config.workers; ++i) {
+        if (!workRings[i]->isDrained() || stealDeques[i]->size() > 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PacketPipeline::workerStage(unsigned worker) {
+    pinStage(2 + worker);
+    StageCounters& stage = *counters[2 + worker];
+    SpscRing<uint32_t>& input = *workRings[worker];
+    SpscRing<uint32_t>& output = *resultRings[worker];
+    std::vector<uint32_t> batch(config.batchSize);
+    std::vector<uint32_t> done;
+    done.reserve(config.batchSize);
+    Backoff backoff;
+
+    // Allocated after pinning, so its pages come from the worker's node
+    const bool keepFlows = config.dispatch == PipelineConfig::Dispatch::Flow;
+    flowTables[worker] = std::make_unique<FlowTable>();
+    FlowTable& flows = *flowTables[worker];
+
+    const bool stealing = config.dispatch == PipelineConfig::Dispatch::Steal && config.workers > 1;
+    WorkStealingDeque<uint32_t>& local = *stealDeques[worker];
+    VictimPicker victims(worker, config.workers);
+    bool stopped = false;  // Polled once per batch
+
+    auto process = [&](uint32_t slot) {
+        PipelinePacket& packet = packets[slot];
+        packet.hits.clear();
+        if (packet.payload && stopped) {
+            packet.payload = nullptr;
+            bump(stage.dropped, 1);
+        }
+        if (packet.payload) {
+            matcher->scan(packet.payload, packet.payloadLength, packet.hits);
+        }
+        if (keepFlows && packet.hasFlow) {
+            FlowState& flow = flows.findOrInsert(packet.flow, packet.flowHash, packet.timestamp);
+            flow.packets++;
+            flow.bytes += packet.payloadLength;
+            flow.hits += packet.hits.size();
+            flow.lastSeen = packet.timestamp;
+        }
+        done.push_back(slot);
+    };
+
+    auto flush = [&]() {
+        if (done.empty()) return;
+        pushAll(output, done.data(), done.size(), stage);
+        bump(stage.processed, done.size());
+        bump(stage.batches, 1);
+        done.clear();
+    };
+
+    for (;;) {
+        size_t count = input.popBatch(batch.data(), batch.size());
+        if (count > 0) {
+            backoff.reset();
+            raise(stage.maxInputDepth, input.size() + count);
+            stopped = CancelToken::stopRequested(cancel);
+            uint64_t start = Tracer::nowNs();
+            if (stealing) {
+                // Queue the batch where idle workers can take from it, then work
+                // through it newest first; the deque holds the whole pool, so push cannot fail
+                for (size_t i = 0; i < count; ++i) {
+                    local.push(batch[i]);
+                }
+                uint32_t slot;
+                while (local.pop(slot)) {
+                    process(slot);
+                }
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    process(batch[i]);
+                }
+            }
+            flush();
+            if (keepFlows) {
+                raise(stage.flows, flows.size());
+            }
+            bump(stage.busyNs, Tracer::nowNs() - start);
+            continue;
+        }
+
+        uint32_t slot;
+        if (stealing && stealPacket(worker, victims, slot)) {
+            backoff.reset();
+            stopped = CancelToken::stopRequested(cancel);
+            uint64_t start = Tracer::nowNs();
+            process(slot);
+            flush();
+            bump(stage.busyNs, Tracer::nowNs() - start);
+            continue;
+        }
+
+        // Stealing workers stay until no worker has anything left to take
+        if (input.isDrained() && (!stealing || workersDrained())) {
+            break;
+        }
+        bump(stage.idlePolls, 1);
+        backoff.pause();
+    }
+    output.close();
+}
+
+void PacketPipeline::sinkStage(const Sink& sink) {
+    size_t stageIndex = 2 + config.workers;
+    pinStage(stageIndex);
+    StageCounters& stage = *counters[stageIndex];
+    std::vector<uint32_t> batch(config.batchSize);
+    Backoff backoff;
+
+    for (;;) {
+        bool any = false;
+        bool drained = true;
+        for (auto& ring : resultRings) {
+            size_t count = ring->popBatch(batch.data(), batch.size());
+            if (count == 0) {
+                drained = drained && ring->isDrained();
+                continue;
+            }
+            any = true;
+            drained = false;
+            raise(stage.maxInputDepth, ring->size() + count);
+
+            if (CancelToken::stopRequested(cancel)) {
+                bump(stage.dropped, count);
+            } else {
+                for (size_t i = 0; i < count; ++i) {
+                    const PipelinePacket& packet = packets[batch[i]];
+                    if (packet.payload) {
+                        sink(packet);
+                    }
+                }
+            }
+            pushAll(freeRing, batch.data(), count, stage);
+            bump(stage.processed, count);
+            bump(stage.batches, 1);
+        }
+
+        if (any) {
+            backoff.reset();
+        } else if (drained) {
+            break;
+        } else {
+            bump(stage.idlePolls, 1);
+            backoff.pause();
+        }
+    }
+}
+
+json PacketPipeline::statsJson() const {
+    json response;
+    response["workers"] = config.workers;
+    response["ringCapacity"] = decodeRing.capacity();
+    response["batchSize"] = config.batchSize;
+    response["dispatch"] = PipelineConfig::dispatchName(config.dispatch);
+    response["numaNode"] = config.numaNode;
+    uint64_t start = startNs.load(std::memory_order_relaxed);
+    uint64_t end = isFinished() ? endNs.load(std::memory_order_relaxed) : Tracer::nowNs();
+    uint64_t elapsed = start && end > start ? end - start : 0;
+    response["elapsedMs"] = static_cast<double>(elapsed) / 1e6;
+    response["stopReason"] = CancelToken::reasonName(
+        static_cast<CancelToken::Reason>(stopReason.load(std::memory_order_relaxed)));
+
+    auto stageJson = [&](size_t index, const std::string& name) {
+        const StageCounters& stage = *counters[index];
+        json s;
+        s["name"] = name;
+        s["processed"] = stage.processed.load(std::memory_order_relaxed);
+        s["batches"] = stage.batches.load(std::memory_order_relaxed);
+        s["idlePolls"] = stage.idlePolls.load(std::memory_order_relaxed);
+        s["stalls"] = stage.stalls.load(std::memory_order_relaxed);
+        s["maxInputDepth"] = stage.maxInputDepth.load(std::memory_order_relaxed);
+        s["dropped"] = stage.dropped.load(std::memory_order_relaxed);
+        s["cpu"] = index < config.cpus.size() ? config.cpus[index] : -1;
+        return s;
+    };
+
+    json stages = json::array();
+    json reader = stageJson(0, "reader");
+    reader["freeDescriptors"] = freeRing.size();
+    stages.push_back(reader);
+
+    json decoder = stageJson(1, "decoder");
+    decoder["inputDepth"] = decodeRing.size();
+    stages.push_back(decoder);
+
+    size_t resultDepth = 0;
+    for (unsigned i = 0; i < config.workers; ++i) {
+        json worker = stageJson(2 + i, "worker-" + std::to_string(i));
+        worker["inputDepth"] = workRings[i]->size();
+        worker["flows"] = counters[2 + i]->flows.load(std::memory_order_relaxed);
+        worker["steals"] = counters[2 + i]->steals.load(std::memory_order_relaxed);
+        uint64_t busyNs = counters[2 + i]->busyNs.load(std::memory_order_relaxed);
+        worker["busyMs"] = static_cast<double>(busyNs) / 1e6;
+        worker["utilization"] = elapsed ? static_cast<double>(busyNs) / elapsed : 0.0;
+        stages.push_back(worker);
+        resultDepth += resultRings[i]->size();
+    }
+
+    json sink = stageJson(2 + config.workers, "sink");
+    sink["inputDepth"] = resultDepth;
+    stages.push_back(sink);
+
+    response["stages"] = stages;
+    return response;
+}
+
+json PacketPipeline::flowsJson(size_t top) const {
+    json response;
+    json perWorker = json::array();
+    std::vector<const FlowState*> all;
+    for (const auto& table : flowTables) {
+        if (!table) {
+            perWorker.push_back(0);
+            continue;
+        }
+        perWorker.push_back(table->size());
+        table->forEach([&](const FlowState& flow) { all.push_back(&flow); });
+    }
+    std::sort(all.begin(), all.end(), [](const FlowState* a, const FlowState* b) {
+        return a->bytes != b->bytes ? a->bytes > b->bytes : a->hash < b->hash;
+    });
+    if (top > 0 && all.size() > top) {
+        all.resize(top);
+    }
+
+    auto address = [](const uint8_t* bytes, uint8_t version) {
+        char text[64];
+        if (version == 4) {
+            snprintf(text, sizeof(text), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+        } else {
+            int n = 0;
+            for (int i = 0; i < 16; i += 2) {
+                n += snprintf(text + n, sizeof(text) - n, i ? ":%x" : "%x", (bytes[i] << 8) | bytes[i + 1]);
+            }
+        }
+        return std::string(text);
+    };
+
+    json flows = json::array();
+    for (const FlowState* flow : all) {
+        json f;
+        f["endpoints"] = {address(flow->key.lowAddress, flow->key.version) + ":" + std::to_string(flow->key.lowPort),
+                          address(flow->key.highAddress, flow->key.version) + ":" + std::to_string(flow->key.highPort)};
+        f["protocol"] = flow->key.protocol == 6 ? "tcp" : "udp";
+        f["worker"] = flowWorker(flow->hash, config.workers);
+        f["packets"] = flow->packets;
+        f["bytes"] = flow->bytes;
+        f["hits"] = flow->hits;
+        f["firstSeen"] = flow->firstSeen;
+        f["lastSeen"] = flow->lastSeen;
+        flows.push_back(f);
+    }
+
+    uint64_t total = 0;
+    for (const auto& count : perWorker) {
+        total += count.get<uint64_t>();
+    }
+    response["flows"] = total;
+    response["perWorker"] = perWorker;
+    response["top"] = flows;
+    return response;
+}
@@ -0,0 +1,166 @@
+#include "packet_inspection/sched/task_scheduler.hpp"
+#include "packet_inspection/pipeline/spsc_ring.hpp"
+#include "packet_inspection/trace/tracer.hpp"
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+// The scheduler and worker index of the calling thread, set while it runs tasks
+thread_local TaskScheduler* t_scheduler = nullptr;
+thread_local int t_worker = -1;
+
+} // namespace
+
+TaskScheduler::TaskScheduler(unsigned workers, size_t dequeCapacity)
+    : workers(workers ? workers : std::max(1u, std::thread::hardware_concurrency())),
+      dequeCapacity(std::max<size_t>(2, dequeCapacity)) {
+    for (unsigned i = 0; i < this->workers; ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->deque = std::make_unique<WorkStealingDeque<Task*>>(this->dequeCapacity);
+        worker->victims = VictimPicker(i, this->workers);
+        pool.push_back(std::move(worker));
+    }
+}
+
+int TaskScheduler::currentWorker() {
+    return t_worker;
+}
+
+void TaskScheduler::run(std::vector<Task> roots) {
+    if (roots.empty()) {
+        return;
+    }
+    PI_TRACE_SCOPE_ARG("sched.run", roots.size());
+    uint64_t start = Tracer::nowNs();
+
+    // Static split: roots round-robin, each worker starting on its own share
+    size_t share = (roots.size() + workers - 1) / workers;
+    for (auto& worker : pool) {
+        if (worker->deque->capacity() < share) {
+            worker->deque = std::make_unique<WorkStealingDeque<Task*>>(std::max(share, dequeCapacity));
+        }
+    }
+    pending.store(roots.size(), std::memory_order_relaxed);
+    for (size_t i = 0; i < roots.size(); ++i) {
+        pool[i % workers]->deque->push(new Task(std::move(roots[i])));
+    }
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < workers; ++i) {
+        threads.emplace_back([this, i]() { workerLoop(i); });
+    }
+    workerLoop(0);  // The calling thread is worker 0
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    runs.fetch_add(1, std::memory_order_relaxed);
+    wallNs.fetch_add(Tracer::nowNs() - start, std::memory_order_relaxed);
+}
+
+void TaskScheduler::spawn(Task task) {
+    if (t_scheduler != this) {
+        task();
+        return;
+    }
+    Worker& worker = *pool[t_worker];
+    pending.fetch_add(1, std::memory_order_relaxed);
+    Task* queued = new Task(std::move(task));
+    if (worker.deque->push(queued)) {
+        bump(worker.stats.spawned, 1);
+        return;
+    }
+    bump(worker.stats.inlineRuns, 1);
+    pending.fetch_sub(1, std::memory_order_relaxed);
+    (*queued)();
+    delete queued;
+}
+
+void TaskScheduler::workerLoop(unsigned index) {
+    TaskScheduler* outerScheduler = t_scheduler;
+    int outerWorker = t_worker;
+    t_scheduler = this;
+    t_worker = static_cast<int>(index);
+
+    Worker& worker = *pool[index];
+    Backoff backoff;
+    for (;;) {
+        Task* task = nullptr;
+        if (worker.deque->pop(task) || trySteal(index, task)) {
+            backoff.reset();
+            execute(index, task);
+            continue;
+        }
+        // Nothing queued anywhere we looked; done once no task is queued or running
+        if (pending.load(std::memory_order_acquire) == 0) {
+            break;
+        }
+        backoff.pause();
+    }
+
+    t_scheduler = outerScheduler;
+    t_worker = outerWorker;
+}
+
+bool TaskScheduler::trySteal(unsigned thief, Task*& task) {
+    if (workers < 2) {
+        return false;
+    }
+    Worker& self = *pool[thief];
+    for (unsigned attempt = 0; attempt < workers; ++attempt) {
+        if (pool[self.victims.next()]->deque->steal(task)) {
+            bump(self.stats.steals, 1);
+            return true;
+        }
+        bump(self.stats.failedSteals, 1);
+    }
+    return false;
+}
+
+void TaskScheduler::execute(unsigned index, Task* task) {
+    WorkerStats& stats = pool[index]->stats;
+    uint64_t start = Tracer::nowNs();
+    (*task)();
+    delete task;
+    bump(stats.busyNs, Tracer::nowNs() - start);
+    bump(stats.tasks, 1);
+    pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+json TaskScheduler::statsJson() const {
+    json response;
+    uint64_t wall = wallNs.load(std::memory_order_relaxed);
+    uint64_t tasks = 0, steals = 0, failedSteals = 0, busy = 0;
+
+    json perWorker = json::array();
+    for (const auto& worker : pool) {
+        const WorkerStats& stats = worker->stats;
+        json w;
+        w["tasks"] = stats.tasks.load(std::memory_order_relaxed);
+        w["spawned"] = stats.spawned.load(std::memory_order_relaxed);
+        w["steals"] = stats.steals.load(std::memory_order_relaxed);
+        w["failedSteals"] = stats.failedSteals.load(std::memory_order_relaxed);
+        w["inlineRuns"] = stats.inlineRuns.load(std::memory_order_relaxed);
+        uint64_t busyNs = stats.busyNs.load(std::memory_order_relaxed);
+        w["busyMs"] = static_cast<double>(busyNs) / 1e6;
+        w["utilization"] = wall ? static_cast<double>(busyNs) / wall : 0.0;
+        perWorker.push_back(w);
+
+        tasks += w["tasks"].get<uint64_t>();
+        steals += w["steals"].get<uint64_t>();
+        failedSteals += w["failedSteals"].get<uint64_t>();
+        busy += busyNs;
+    }
+
+    response["workers"] = workers;
+    response["runs"] = runs.load(std::memory_order_relaxed);
+    response["wallMs"] = static_cast<double>(wall) / 1e6;
+    response["tasks"] = tasks;
+    response["steals"] = steals;
+    response["failedSteals"] = failedSteals;
+    // Share of worker-time spent inside tasks (1.0 = no worker ever waited)
+    response["utilization"] = wall ? static_cast<double>(busy) / (static_cast<double>(wall) * workers) : 0.0;
+    response["perWorker"] = perWorker;
+    return response;
+}
@@ -0,0 +1,351 @@
+#include "packet_inspection/shm/shared_automaton.hpp"
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint32_t CONTROL_MAGIC = 0x4c525443;  // "CTRL"
+constexpr uint32_t SEGMENT_MAGIC = 0x4d4f5441;  // "ATOM"
+constexpr uint32_t SEGMENT_VERSION = 1;
+
+struct ControlBlock {
+    uint32_t magic;
+    uint32_t version;
+    std::atomic<uint64_t> generation;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "generation must be lock-free across processes");
+
+/**
+ * Start of a generation segment; the pattern table and the image follow
+ */
+struct SegmentHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t generation;
+    uint64_t totalBytes;
+    uint64_t patternCount;
+    uint64_t patternOffset;  // Sequence of {uint32_t length, bytes}
+    uint64_t patternBytes;
+    uint64_t imageOffset;    // 64-byte aligned
+    uint64_t imageWords;
+    uint64_t checksum;       // FNV-1a over patterns and image
+};
+
+uint64_t fnv1a(const uint8_t* data, size_t length, uint64_t hash = 1469598103934665603ULL) {
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool validName(const std::string& name) {
+    if (name.empty() || name.size() > 200) return false;
+    for (char c : name) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_' && c != '.') return false;
+    }
+    return true;
+}
+
+std::string controlName(const std::string& name) {
+    return "/pktinspect." + name;
+}
+
+std::string segmentName(const std::string& name, uint64_t generation) {
+    return "/pktinspect." + name + "." + std::to_string(generation);
+}
+
+#ifdef __linux__
+
+/**
+ * Map the control block: read-write (created if missing) for the publisher,
+ * read-only for everyone else
+ */
+ControlBlock* openControl(const std::string& name, bool create) {
+    int fd = shm_open(controlName(name).c_str(), create ? (O_RDWR | O_CREAT) : O_RDONLY, 0640);
+    if (fd < 0) return nullptr;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (static_cast<size_t>(st.st_size) < sizeof(ControlBlock) &&
+                                (!create || ftruncate(fd, sizeof(ControlBlock)) != 0))) {
+        close(fd);
+        return nullptr;
+    }
+    void* p = mmap(nullptr, sizeof(ControlBlock), create ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return nullptr;
+
+    // A fresh segment is zero-filled: generation 0 means nothing published
+    ControlBlock* block = static_cast<ControlBlock*>(p);
+    if (create && block->magic != CONTROL_MAGIC) {
+        block->version = SEGMENT_VERSION;
+        block->generation.store(0, std::memory_order_relaxed);
+        block->magic = CONTROL_MAGIC;
+    }
+    if (block->magic != CONTROL_MAGIC) {
+        munmap(p, sizeof(ControlBlock));
+        return nullptr;
+    }
+    return block;
+}
+
+void closeControl(ControlBlock* block) {
+    if (block) munmap(block, sizeof(ControlBlock));
+}
+
+/**
+ * Read-only mapping of one generation segment, unmapped with the last matcher using it
+ */
+struct SegmentMapping {
+    void* address = nullptr;
+    size_t length = 0;
+    ~SegmentMapping() {
+        if (address) munmap(address, length);
+    }
+};
+
+#endif
+
+} // namespace
+
+#ifdef __linux__
+
+uint64_t SharedAutomaton::publish(const std::string& name, const AcTableMatcher& matcher) {
+    if (!validName(name)) {
+        fprintf(stderr, "Error: Invalid shared automaton name: %s\n", name.c_str());
+        return 0;
+    }
+    ControlBlock* control = openControl(name, true);
+    if (!control) {
+        fprintf(stderr, "Error: Could not open control segment %s: %s\n", controlName(name).c_str(), strerror(errno));
+        return 0;
+    }
+    const uint64_t previous = control->generation.load(std::memory_order_acquire);
+    const uint64_t next = previous + 1;
+
+    // Layout
+    const PatternSet& patterns = matcher.patternSet();
+    SegmentHeader header{};
+    header.magic = SEGMENT_MAGIC;
+    header.version = SEGMENT_VERSION;
+    header.generation = next;
+    header.patternCount = patterns.size();
+    header.patternOffset = sizeof(SegmentHeader);
+    for (const std::string& pattern : patterns.all()) {
+        header.patternBytes += sizeof(uint32_t) + pattern.size();
+    }
+    header.imageOffset = (header.patternOffset + header.patternBytes + 63) & ~uint64_t(63);
+    header.imageWords = matcher.imageSize();
+    header.totalBytes = header.imageOffset + header.imageWords * sizeof(uint32_t);
+
+    const std::string segment = segmentName(name, next);
+    shm_unlink(segment.c_str());  // Leftover of a publisher that died before bumping the generation
+    int fd = shm_open(segment.c_str(), O_RDWR | O_CREAT | O_EXCL, 0640);
+    if (fd < 0 || ftruncate(fd, static_cast<off_t>(header.totalBytes)) != 0) {
+        fprintf(stderr, "Error: Could not create segment %s: %s\n", segment.c_str(), strerror(errno));
+        if (fd >= 0) close(fd);
+        closeControl(control);
+        return 0;
+    }
+    void* p = mmap(nullptr, header.totalBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        fprintf(stderr, "Error: Could not map segment %s: %s\n", segment.c_str(), strerror(errno));
+        shm_unlink(segment.c_str());
+        closeControl(control);
+        return 0;
+    }
+
+    uint8_t* base = static_cast<uint8_t*>(p);
+    uint8_t* out = base + header.patternOffset;
+    for (const std::string& pattern : patterns.all()) {
+        uint32_t length = static_cast<uint32_t>(pattern.size());
+        std::memcpy(out, &length, sizeof(length));
+        std::memcpy(out + sizeof(length), pattern.data(), pattern.size());
+        out += sizeof(length) + pattern.size();
+    }
+    std::memcpy(base + header.imageOffset, matcher.imageData(), header.imageWords * sizeof(uint32_t));
+    header.checksum = fnv1a(base + header.imageOffset, header.imageWords * sizeof(uint32_t),
+                            fnv1a(base + header.patternOffset, header.patternBytes));
+    std::memcpy(base, &header, sizeof(header));
+    munmap(p, header.totalBytes);
+
+    // Handover: readers that see the new generation find a complete segment
+    control->generation.store(next, std::memory_order_release);
+    if (previous != 0) {
+        shm_unlink(segmentName(name, previous).c_str());
+    }
+    closeControl(control);
+    return next;
+}
+
+std::shared_ptr<const AcTableMatcher> SharedAutomaton::attach(const std::string& name, uint64_t* generation) {
+    if (!validName(name)) return nullptr;
+    ControlBlock* control = openControl(name, false);
+    if (!control) return nullptr;
+
+    // The publisher may unlink a generation between our read and open; retry with the newer one
+    for (int attempt = 0; attempt < 3; ++attempt) {
+        const uint64_t current = control->generation.load(std::memory_order_acquire);
+        if (current == 0) break;
+
+        const std::string segment = segmentName(name, current);
+        int fd = shm_open(segment.c_str(), O_RDONLY, 0);
+        if (fd < 0) continue;
+
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SegmentHeader)) {
+            close(fd);
+            continue;
+        }
+        auto mapping = std::make_shared<SegmentMapping>();
+        mapping->length = static_cast<size_t>(st.st_size);
+        mapping->address = mmap(nullptr, mapping->length, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+        close(fd);
+        if (mapping->address == MAP_FAILED) {
+            mapping->address = nullptr;
+            continue;
+        }
+
+        const uint8_t* base = static_cast<const uint8_t*>(mapping->address);
+        SegmentHeader header;
+        std::memcpy(&header, base, sizeof(header));
+        const bool layoutOk = header.magic == SEGMENT_MAGIC && header.version == SEGMENT_VERSION &&
+                              header.generation == current && header.totalBytes == mapping->length &&
+                              header.patternOffset + header.patternBytes <= header.imageOffset &&
+                              header.imageOffset % 64 == 0 &&
+                              header.imageOffset + header.imageWords * sizeof(uint32_t) == header.totalBytes;
+        if (!layoutOk || fnv1a(base + header.imageOffset, header.imageWords * sizeof(uint32_t),
+                               fnv1a(base + header.patternOffset, header.patternBytes)) != header.checksum) {
+            fprintf(stderr, "Error: Shared automaton segment %s is corrupt\n", segment.c_str());
+            break;
+        }
+
+        std::vector<std::string> patterns;
+        const uint8_t* in = base + header.patternOffset;
+        const uint8_t* end = in + header.patternBytes;
+        while (in + sizeof(uint32_t) <= end && patterns.size() < header.patternCount) {
+            uint32_t length;
+            std::memcpy(&length, in, sizeof(length));
+            in += sizeof(length);
+            if (length > static_cast<size_t>(end - in)) break;
+            patterns.emplace_back(reinterpret_cast<const char*>(in), length);
+            in += length;
+        }
+
+        const uint32_t* words = reinterpret_cast<const uint32_t*>(base + header.imageOffset);
+        if (patterns.size() != header.patternCount ||
+            !AcTableMatcher::validateImage(words, header.imageWords, patterns.size())) {
+            fprintf(stderr, "Error: Shared automaton segment %s is inconsistent\n", segment.c_str());
+            break;
+        }
+
+        closeControl(control);
+        if (generation) *generation = current;
+        return std::make_shared<const AcTableMatcher>(std::make_shared<const PatternSet>(patterns),
+                                                      mapping, words, header.imageWords);
+    }
+
+    closeControl(control);
+    return nullptr;
+}
+
+uint64_t SharedAutomaton::currentGeneration(const std::string& name) {
+    if (!validName(name)) return 0;
+    ControlBlock* control = openControl(name, false);
+    if (!control) return 0;
+    uint64_t generation = control->generation.load(std::memory_order_acquire);
+    closeControl(control);
+    return generation;
+}
+
+bool SharedAutomaton::remove(const std::string& name) {
+    if (!validName(name)) return false;
+    uint64_t generation = currentGeneration(name);
+    bool removed = false;
+    if (generation != 0) {
+        removed |= shm_unlink(segmentName(name, generation).c_str()) == 0;
+    }
+    removed |= shm_unlink(controlName(name).c_str()) == 0;
+    return removed;
+}
+
+SharedAutomatonClient::SharedAutomatonClient(std::string name) : name(std::move(name)) {
+    mapControl();
+}
+
+SharedAutomatonClient::~SharedAutomatonClient() {
+    closeControl(static_cast<ControlBlock*>(control));
+}
+
+bool SharedAutomatonClient::mapControl() {
+    if (!control) {
+        control = openControl(name, false);
+    }
+    return control != nullptr;
+}
+
+std::shared_ptr<const AcTableMatcher> SharedAutomatonClient::current() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!mapControl()) {
+        return matcher;
+    }
+
+    const uint64_t published = static_cast<ControlBlock*>(control)->generation.load(std::memory_order_acquire);
+    if (published != generation) {
+        uint64_t attached = 0;
+        if (auto fresh = SharedAutomaton::attach(name, &attached)) {
+            matcher = std::move(fresh);
+            generation = attached;
+        }
+    }
+    return matcher;
+}
+
+#else
+
+uint64_t SharedAutomaton::publish(const std::string&, const AcTableMatcher&) {
+    fprintf(stderr, "Error: Shared automata need POSIX shared memory\n");
+    return 0;
+}
+
+std::shared_ptr<const AcTableMatcher> SharedAutomaton::attach(const std::string&, uint64_t*) {
+    return nullptr;
+}
+
+uint64_t SharedAutomaton::currentGeneration(const std::string&) {
+    return 0;
+}
+
+bool SharedAutomaton::remove(const std::string&) {
+    return false;
+}
+
+SharedAutomatonClient::SharedAutomatonClient(std::string name) : name(std::move(name)) {}
+SharedAutomatonClient::~SharedAutomatonClient() = default;
+
+bool SharedAutomatonClient::mapControl() {
+    return false;
+}
+
+std::shared_ptr<const AcTableMatcher> SharedAutomatonClient::current() {
+    return nullptr;
+}
+
+#endif
+
+uint64_t SharedAutomatonClient::attachedGeneration() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return generation;
+}
@@ -0,0 +1,111 @@
+#include "packet_inspection/simd/simd_kernels.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+
+extern const SimdKernels kScalarKernels;
+#ifdef PKTINSPECT_X86_KERNELS
+extern const SimdKernels kSse42Kernels;
+extern const SimdKernels kAvx2Kernels;
+extern const SimdKernels kAvx512Kernels;
+#endif
+
+void ByteSet::add(uint8_t byte) {
+    bits[byte >> 6] |= 1ULL << (byte & 63);
+
+    // Truffle tables: row = low nibble, bit = bits 4-6, table = bit 7
+    uint8_t bit = static_cast<uint8_t>(1u << ((byte >> 4) & 7));
+    if (byte & 0x80) {
+        nibbleMaskHi[byte & 0x0f] |= bit;
+    } else {
+        nibbleMaskLo[byte & 0x0f] |= bit;
+    }
+}
+
+namespace {
+
+bool cpuSupports(SimdVariant variant) {
+#ifdef PKTINSPECT_X86_KERNELS
+    __builtin_cpu_init();
+    switch (variant) {
+        case SimdVariant::Scalar: return true;
+        case SimdVariant::SSE42: return __builtin_cpu_supports("sse4.2");
+        case SimdVariant::AVX2: return __builtin_cpu_supports("avx2");
+        case SimdVariant::AVX512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+    }
+    return false;
+#else
+    return variant == SimdVariant::Scalar;
+#endif
+}
+
+const SimdKernels* selectKernels() {
+    SimdVariant variant = CpuDispatch::bestSupported();
+
+    const char* requested = std::getenv("PKTINSPECT_SIMD");
+    if (requested && *requested) {
+        bool known = false;
+        for (SimdVariant candidate : {SimdVariant::Scalar, SimdVariant::SSE42,
+                                      SimdVariant::AVX2, SimdVariant::AVX512}) {
+            if (strcmp(requested, CpuDispatch::variantName(candidate)) != 0) {
+                continue;
+            }
+            known = true;
+            if (CpuDispatch::kernelsFor(candidate)) {
+                variant = candidate;
+            } else {
+                fprintf(stderr, "Warning: PKTINSPECT_SIMD=%s not supported on this CPU, using %s\n",
+                        requested, CpuDispatch::variantName(variant));
+            }
+        }
+        if (!known) {
+            fprintf(stderr, "Warning: Unknown PKTINSPECT_SIMD value: %s\n", requested);
+        }
+    }
+
+    return CpuDispatch::kernelsFor(variant);
+}
+
+} // namespace
+
+const SimdKernels& CpuDispatch::kernels() {
+    static const SimdKernels* selected = selectKernels();
+    return *selected;
+}
+
+const SimdKernels* CpuDispatch::kernelsFor(SimdVariant variant) {
+    if (!cpuSupports(variant)) {
+        return nullptr;
+    }
+
+    switch (variant) {
+        case SimdVariant::Scalar: return &kScalarKernels;
+#ifdef PKTINSPECT_X86_KERNELS
+        case SimdVariant::SSE42: return &kSse42Kernels;
+        case SimdVariant::AVX2: return &kAvx2Kernels;
+        case SimdVariant::AVX512: return &kAvx512Kernels;
+#endif
+        default: return nullptr;
+    }
+}
+
+SimdVariant CpuDispatch::bestSupported() {
+    for (SimdVariant variant : {SimdVariant::AVX512, SimdVariant::AVX2, SimdVariant::SSE42}) {
+        if (kernelsFor(variant)) {
+            return variant;
+        }
+    }
+    return SimdVariant::Scalar;
+}
+
+const char* CpuDispatch::variantName(SimdVariant variant) {
+    switch (variant) {
+        case SimdVariant::Scalar: return "scalar";
+        case SimdVariant::SSE42: return "sse42";
+        case SimdVariant::AVX2: return "avx2";
+        case SimdVariant::AVX512: return "avx512";
+    }
+    return "unknown";
+}
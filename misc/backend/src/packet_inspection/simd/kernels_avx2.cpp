@@ -0,0 +1,88 @@
+// Compiled with -mavx2; only reached after cpuid confirms support.
+// Keep this file free of inline library code so nothing built for this ISA
+// is shared with the generic build through ODR merging.
+#include "packet_inspection/simd/simd_kernels.hpp"
+#include <immintrin.h>
+
+namespace {
+
+size_t findFirstOfAvx2(const uint8_t* data, size_t length, const ByteSet& set) {
+    const __m256i maskLo = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(set.nibbleMaskLo)));
+    const __m256i maskHi = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(set.nibbleMaskHi)));
+    const __m256i bitSelect = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+                                               1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m256i lowNibble = _mm256_set1_epi8(0x0f);
+    const __m256i highBit = _mm256_set1_epi8(static_cast<char>(0x80));
+    const __m256i zero = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i rows = _mm256_or_si256(_mm256_shuffle_epi8(maskLo, chunk),
+                                       _mm256_shuffle_epi8(maskHi, _mm256_xor_si256(chunk, highBit)));
+        __m256i column = _mm256_shuffle_epi8(bitSelect,
+                                             _mm256_and_si256(_mm256_srli_epi16(chunk, 4), lowNibble));
+        __m256i hit = _mm256_cmpeq_epi8(_mm256_and_si256(rows, column), zero);
+        unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(hit));
+        if (mask) {
+            return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+    for (; i < length; ++i) {
+        uint8_t byte = data[i];
+        if ((set.bits[byte >> 6] >> (byte & 63)) & 1) {
+            return i;
+        }
+    }
+    return length;
+}
+
+void foldCaseAvx2(const uint8_t* in, uint8_t* out, size_t length) {
+    const __m256i shift = _mm256_set1_epi8(static_cast<char>(128 - 'A'));
+    const __m256i limit = _mm256_set1_epi8(static_cast<char>(-128 + 26));
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i isUpper = _mm256_cmpgt_epi8(limit, _mm256_add_epi8(chunk, shift));
+        chunk = _mm256_or_si256(chunk, _mm256_and_si256(isUpper, caseBit));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), chunk);
+    }
+    for (; i < length; ++i) {
+        uint8_t byte = in[i];
+        out[i] = static_cast<uint8_t>(byte - 'A') < 26 ? byte | 0x20 : byte;
+    }
+}
+
+void hexEncodeAvx2(const uint8_t* in, size_t length, char* out) {
+    const __m256i digits = _mm256_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                            '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+                                            '0', '1', '2', '3', '4', '5', '6', '7',
+                                            '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m256i lowNibble = _mm256_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(chunk, 4), lowNibble));
+        __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(chunk, lowNibble));
+        // Unpack works per 128-bit lane: a = bytes 0-7 | 16-23, b = bytes 8-15 | 24-31
+        __m256i a = _mm256_unpacklo_epi8(hi, lo);
+        __m256i b = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2 * i + 32), _mm256_permute2x128_si256(a, b, 0x31));
+    }
+    for (; i < length; ++i) {
+        out[2 * i] = "0123456789abcdef"[in[i] >> 4];
+        out[2 * i + 1] = "0123456789abcdef"[in[i] & 0x0f];
+    }
+}
+
+} // namespace
+
+extern const SimdKernels kAvx2Kernels = {
+    SimdVariant::AVX2, "avx2", findFirstOfAvx2, foldCaseAvx2, hexEncodeAvx2
+};
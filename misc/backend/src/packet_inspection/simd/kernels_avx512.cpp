@@ -0,0 +1,89 @@
+// Compiled with -mavx512f -mavx512bw; only reached after cpuid confirms support.
+// Keep this file free of inline library code so nothing built for this ISA
+// is shared with the generic build through ODR merging.
+#include "packet_inspection/simd/simd_kernels.hpp"
+#include <immintrin.h>
+
+namespace {
+
+size_t findFirstOfAvx512(const uint8_t* data, size_t length, const ByteSet& set) {
+    const __m512i maskLo = _mm512_broadcast_i32x4(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(set.nibbleMaskLo)));
+    const __m512i maskHi = _mm512_broadcast_i32x4(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(set.nibbleMaskHi)));
+    const __m512i bitSelect = _mm512_broadcast_i32x4(
+        _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128));
+    const __m512i lowNibble = _mm512_set1_epi8(0x0f);
+    const __m512i highBit = _mm512_set1_epi8(static_cast<char>(0x80));
+
+    size_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        __m512i chunk = _mm512_loadu_si512(data + i);
+        __m512i rows = _mm512_or_si512(_mm512_shuffle_epi8(maskLo, chunk),
+                                       _mm512_shuffle_epi8(maskHi, _mm512_xor_si512(chunk, highBit)));
+        __m512i column = _mm512_shuffle_epi8(bitSelect,
+                                             _mm512_and_si512(_mm512_srli_epi16(chunk, 4), lowNibble));
+        __mmask64 mask = _mm512_test_epi8_mask(rows, column);
+        if (mask) {
+            return i + static_cast<size_t>(__builtin_ctzll(mask));
+        }
+    }
+    for (; i < length; ++i) {
+        uint8_t byte = data[i];
+        if ((set.bits[byte >> 6] >> (byte & 63)) & 1) {
+            return i;
+        }
+    }
+    return length;
+}
+
+void foldCaseAvx512(const uint8_t* in, uint8_t* out, size_t length) {
+    const __m512i upperA = _mm512_set1_epi8('A');
+    const __m512i range = _mm512_set1_epi8(25);
+    const __m512i caseBit = _mm512_set1_epi8(0x20);
+
+    size_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        __m512i chunk = _mm512_loadu_si512(in + i);
+        __mmask64 isUpper = _mm512_cmple_epu8_mask(_mm512_sub_epi8(chunk, upperA), range);
+        chunk = _mm512_or_si512(chunk, _mm512_maskz_mov_epi8(isUpper, caseBit));
+        _mm512_storeu_si512(out + i, chunk);
+    }
+    if (i < length) {
+        __mmask64 tail = (~0ULL) >> (64 - (length - i));
+        __m512i chunk = _mm512_maskz_loadu_epi8(tail, in + i);
+        __mmask64 isUpper = _mm512_cmple_epu8_mask(_mm512_sub_epi8(chunk, upperA), range);
+        chunk = _mm512_or_si512(chunk, _mm512_maskz_mov_epi8(isUpper, caseBit));
+        _mm512_mask_storeu_epi8(out + i, tail, chunk);
+    }
+}
+
+void hexEncodeAvx512(const uint8_t* in, size_t length, char* out) {
+    const __m512i digits = _mm512_broadcast_i32x4(
+        _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f'));
+    const __m512i lowNibble = _mm512_set1_epi8(0x0f);
+    // Unpack works per 128-bit lane; these qword indices restore byte order
+    const __m512i firstHalf = _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11);
+    const __m512i secondHalf = _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15);
+
+    size_t i = 0;
+    for (; i + 64 <= length; i += 64) {
+        __m512i chunk = _mm512_loadu_si512(in + i);
+        __m512i hi = _mm512_shuffle_epi8(digits, _mm512_and_si512(_mm512_srli_epi16(chunk, 4), lowNibble));
+        __m512i lo = _mm512_shuffle_epi8(digits, _mm512_and_si512(chunk, lowNibble));
+        __m512i a = _mm512_unpacklo_epi8(hi, lo);
+        __m512i b = _mm512_unpackhi_epi8(hi, lo);
+        _mm512_storeu_si512(out + 2 * i, _mm512_permutex2var_epi64(a, firstHalf, b));
+        _mm512_storeu_si512(out + 2 * i + 64, _mm512_permutex2var_epi64(a, secondHalf, b));
+    }
+    for (; i < length; ++i) {
+        out[2 * i] = "0123456789abcdef"[in[i] >> 4];
+        out[2 * i + 1] = "0123456789abcdef"[in[i] & 0x0f];
+    }
+}
+
+} // namespace
+
+extern const SimdKernels kAvx512Kernels = {
+    SimdVariant::AVX512, "avx512", findFirstOfAvx512, foldCaseAvx512, hexEncodeAvx512
+};
@@ -0,0 +1,35 @@
+#include "packet_inspection/simd/simd_kernels.hpp"
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+size_t findFirstOfScalar(const uint8_t* data, size_t length, const ByteSet& set) {
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t byte = data[i];
+        if ((set.bits[byte >> 6] >> (byte & 63)) & 1) {
+            return i;
+        }
+    }
+    return length;
+}
+
+void foldCaseScalar(const uint8_t* in, uint8_t* out, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t byte = in[i];
+        out[i] = static_cast<uint8_t>(byte - 'A') < 26 ? byte | 0x20 : byte;
+    }
+}
+
+void hexEncodeScalar(const uint8_t* in, size_t length, char* out) {
+    for (size_t i = 0; i < length; ++i) {
+        out[2 * i] = HEX_DIGITS[in[i] >> 4];
+        out[2 * i + 1] = HEX_DIGITS[in[i] & 0x0f];
+    }
+}
+
+} // namespace
+
+extern const SimdKernels kScalarKernels = {
+    SimdVariant::Scalar, "scalar", findFirstOfScalar, foldCaseScalar, hexEncodeScalar
+};
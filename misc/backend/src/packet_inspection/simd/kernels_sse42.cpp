@@ -0,0 +1,81 @@
+// Compiled with -msse4.2; only reached after cpuid confirms support.
+// Keep this file free of inline library code so nothing built for this ISA
+// is shared with the generic build through ODR merging.
+#include "packet_inspection/simd/simd_kernels.hpp"
+#include <immintrin.h>
+
+namespace {
+
+size_t findFirstOfSse(const uint8_t* data, size_t length, const ByteSet& set) {
+    const __m128i maskLo = _mm_load_si128(reinterpret_cast<const __m128i*>(set.nibbleMaskLo));
+    const __m128i maskHi = _mm_load_si128(reinterpret_cast<const __m128i*>(set.nibbleMaskHi));
+    const __m128i bitSelect = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+    const __m128i lowNibble = _mm_set1_epi8(0x0f);
+    const __m128i highBit = _mm_set1_epi8(static_cast<char>(0x80));
+    const __m128i zero = _mm_setzero_si128();
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // Row: low nibble (shuffle zeroes lanes whose index has bit 7 set)
+        __m128i rows = _mm_or_si128(_mm_shuffle_epi8(maskLo, chunk),
+                                    _mm_shuffle_epi8(maskHi, _mm_xor_si128(chunk, highBit)));
+        // Column: bits 4-6 of the byte
+        __m128i column = _mm_shuffle_epi8(bitSelect, _mm_and_si128(_mm_srli_epi16(chunk, 4), lowNibble));
+        __m128i hit = _mm_cmpeq_epi8(_mm_and_si128(rows, column), zero);
+        unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(hit)) & 0xffff;
+        if (mask) {
+            return i + static_cast<size_t>(__builtin_ctz(mask));
+        }
+    }
+    for (; i < length; ++i) {
+        uint8_t byte = data[i];
+        if ((set.bits[byte >> 6] >> (byte & 63)) & 1) {
+            return i;
+        }
+    }
+    return length;
+}
+
+void foldCaseSse(const uint8_t* in, uint8_t* out, size_t length) {
+    const __m128i shift = _mm_set1_epi8(static_cast<char>(128 - 'A'));
+    const __m128i limit = _mm_set1_epi8(static_cast<char>(-128 + 26));
+    const __m128i caseBit = _mm_set1_epi8(0x20);
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i isUpper = _mm_cmplt_epi8(_mm_add_epi8(chunk, shift), limit);
+        chunk = _mm_or_si128(chunk, _mm_and_si128(isUpper, caseBit));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), chunk);
+    }
+    for (; i < length; ++i) {
+        uint8_t byte = in[i];
+        out[i] = static_cast<uint8_t>(byte - 'A') < 26 ? byte | 0x20 : byte;
+    }
+}
+
+void hexEncodeSse(const uint8_t* in, size_t length, char* out) {
+    const __m128i digits = _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7',
+                                         '8', '9', 'a', 'b', 'c', 'd', 'e', 'f');
+    const __m128i lowNibble = _mm_set1_epi8(0x0f);
+
+    size_t i = 0;
+    for (; i + 16 <= length; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(chunk, 4), lowNibble));
+        __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(chunk, lowNibble));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i), _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    for (; i < length; ++i) {
+        out[2 * i] = "0123456789abcdef"[in[i] >> 4];
+        out[2 * i + 1] = "0123456789abcdef"[in[i] & 0x0f];
+    }
+}
+
+} // namespace
+
+extern const SimdKernels kSse42Kernels = {
+    SimdVariant::SSE42, "sse42", findFirstOfSse, foldCaseSse, hexEncodeSse
+};
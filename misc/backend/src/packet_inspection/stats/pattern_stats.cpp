@@ -0,0 +1,217 @@
+#include "packet_inspection/stats/pattern_stats.hpp"
+#include "packet_inspection/trace/tracer.hpp"
+#include <algorithm>
+
+namespace {
+
+std::atomic<uint64_t> g_nextSerial{1};
+
+/**
+ * Rate of change between two counter values
+ */
+double ratePerSecond(uint64_t now, uint64_t then, double seconds) {
+    if (seconds <= 0.0 || now < then) {
+        return 0.0;
+    }
+    return static_cast<double>(now - then) / seconds;
+}
+
+} // namespace
+
+/**
+ * Live shards of one instance and the counts of the retired ones
+ * Threads hold it weakly, so one exiting after the instance is gone skips it
+ */
+struct PatternStats::Shards {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<Shard>> live;
+    uint64_t retiredScans = 0;
+    uint64_t retiredBytes = 0;
+    std::vector<uint64_t> retiredHits;  // Indexed by pattern id
+};
+
+/**
+ * Shards written by one thread, retired when the thread exits
+ */
+struct PatternStats::ShardOwner {
+    std::vector<std::pair<std::weak_ptr<Shards>, Shard*>> owned;
+
+    ~ShardOwner() {
+        for (const auto& [weak, shard] : owned) {
+            if (auto list = weak.lock()) {
+                retire(*list, shard);
+            }
+        }
+    }
+
+    static void retire(Shards& list, const Shard* shard) {
+        std::lock_guard<std::mutex> lock(list.mutex);
+        auto it = std::find_if(list.live.begin(), list.live.end(),
+                               [shard](const std::shared_ptr<Shard>& live) { return live.get() == shard; });
+        if (it == list.live.end()) {
+            return;
+        }
+        list.retiredScans += shard->scans.load(std::memory_order_relaxed);
+        list.retiredBytes += shard->bytes.load(std::memory_order_relaxed);
+        for (size_t id = 0; id < list.retiredHits.size(); ++id) {
+            list.retiredHits[id] +=
+                shard->lines[id / COUNTERS_PER_LINE].counts[id % COUNTERS_PER_LINE].load(std::memory_order_relaxed);
+        }
+        list.live.erase(it);
+    }
+};
+
+PatternStats::PatternStats(std::vector<std::string> patterns, size_t historyLength)
+    : patterns(std::move(patterns)),
+      serial(g_nextSerial++),
+      createdNs(Tracer::nowNs()),
+      historyLength(std::max<size_t>(historyLength, 2)),
+      shards(std::make_shared<Shards>()) {
+    shards->retiredHits.assign(this->patterns.size(), 0);
+}
+
+PatternStats::Shard& PatternStats::registerShard() {
+    thread_local ShardOwner owner;
+    std::thread::id self = std::this_thread::get_id();
+    std::lock_guard<std::mutex> lock(shards->mutex);
+    for (const auto& shard : shards->live) {
+        if (shard->owner == self) {
+            return *shard;
+        }
+    }
+
+    auto shard = std::make_shared<Shard>();
+    shard->owner = self;
+    shard->lines = std::vector<CounterLine>((patterns.size() + COUNTERS_PER_LINE - 1) / COUNTERS_PER_LINE);
+    shards->live.push_back(shard);
+
+    // Instances gone since (e.g. replaced on reload) need no retiring
+    std::erase_if(owner.owned, [](const auto& entry) { return entry.first.expired(); });
+    owner.owned.emplace_back(shards, shard.get());
+    return *shard;
+}
+
+PatternStats::Snapshot PatternStats::totals() const {
+    Snapshot snapshot;
+    snapshot.timeNs = Tracer::nowNs();
+
+    // Retired counts and live shards are taken together, so a shard retiring
+    // meanwhile is counted once; the summing runs without the lock
+    std::vector<std::shared_ptr<Shard>> live;
+    {
+        std::lock_guard<std::mutex> lock(shards->mutex);
+        snapshot.scans = shards->retiredScans;
+        snapshot.bytes = shards->retiredBytes;
+        snapshot.hits = shards->retiredHits;
+        live = shards->live;
+    }
+
+    const size_t count = patterns.size();
+    for (const auto& shard : live) {
+        snapshot.scans += shard->scans.load(std::memory_order_relaxed);
+        snapshot.bytes += shard->bytes.load(std::memory_order_relaxed);
+        for (size_t line = 0; line < shard->lines.size(); ++line) {
+            const CounterLine& counters = shard->lines[line];
+            size_t base = line * COUNTERS_PER_LINE;
+            for (size_t i = 0; i < COUNTERS_PER_LINE && base + i < count; ++i) {
+                snapshot.hits[base + i] += counters.counts[i].load(std::memory_order_relaxed);
+            }
+        }
+    }
+    return snapshot;
+}
+
+void PatternStats::sample() {
+    Snapshot snapshot = totals();
+    std::lock_guard<std::mutex> lock(historyMutex);
+    if (history.size() < historyLength) {
+        history.push_back(std::move(snapshot));
+    } else {
+        history[historyNext] = std::move(snapshot);
+    }
+    historyNext = (historyNext + 1) % historyLength;
+}
+
+json PatternStats::toJson(const std::vector<uint32_t>& windowsSeconds, size_t top) const {
+    Snapshot now = totals();
+
+    // Baseline per window: newest sample at least that old, else the oldest one kept
+    std::vector<Snapshot> baselines;
+    {
+        std::lock_guard<std::mutex> lock(historyMutex);
+        for (uint32_t window : windowsSeconds) {
+            uint64_t cutoff = now.timeNs - std::min<uint64_t>(now.timeNs, uint64_t(window) * 1000000000ull);
+            const Snapshot* best = nullptr;
+            const Snapshot* oldest = nullptr;
+            for (const Snapshot& sampled : history) {
+                if (!oldest || sampled.timeNs < oldest->timeNs) {
+                    oldest = &sampled;
+                }
+                if (sampled.timeNs <= cutoff && (!best || sampled.timeNs > best->timeNs)) {
+                    best = &sampled;
+                }
+            }
+            if (!best) {
+                best = oldest;
+            }
+            if (best) {
+                baselines.push_back(*best);
+            } else {
+                Snapshot start;
+                start.timeNs = createdNs;
+                start.hits.assign(patterns.size(), 0);
+                baselines.push_back(std::move(start));
+            }
+        }
+    }
+
+    json response;
+    response["patternCount"] = patterns.size();
+    response["scans"] = now.scans;
+    response["bytes"] = now.bytes;
+    response["uptimeSeconds"] = static_cast<double>(now.timeNs - createdNs) / 1e9;
+
+    std::vector<double> spans;
+    json windows = json::array();
+    for (size_t w = 0; w < windowsSeconds.size(); ++w) {
+        double span = static_cast<double>(now.timeNs - baselines[w].timeNs) / 1e9;
+        spans.push_back(span);
+
+        json window;
+        window["seconds"] = windowsSeconds[w];
+        window["spanSeconds"] = span;
+        window["scansPerSecond"] = ratePerSecond(now.scans, baselines[w].scans, span);
+        window["bytesPerSecond"] = ratePerSecond(now.bytes, baselines[w].bytes, span);
+        windows.push_back(window);
+    }
+    response["windows"] = windows;
+
+    std::vector<uint32_t> order;
+    for (uint32_t id = 0; id < patterns.size(); ++id) {
+        if (now.hits[id] != 0 || top == 0) {
+            order.push_back(id);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&now](uint32_t a, uint32_t b) { return now.hits[a] > now.hits[b]; });
+    if (top != 0 && order.size() > top) {
+        order.resize(top);
+    }
+
+    json list = json::array();
+    for (uint32_t id : order) {
+        json entry;
+        entry["id"] = id;
+        entry["pattern"] = patterns[id];
+        entry["hits"] = now.hits[id];
+
+        json rates = json::array();
+        for (size_t w = 0; w < windowsSeconds.size(); ++w) {
+            rates.push_back(ratePerSecond(now.hits[id], baselines[w].hits[id], spans[w]));
+        }
+        entry["ratesPerSecond"] = rates;
+        list.push_back(entry);
+    }
+    response["patterns"] = list;
+    return response;
+}
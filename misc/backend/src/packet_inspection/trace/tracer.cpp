@@ -0,0 +1,188 @@
+#include "packet_inspection/trace/tracer.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unistd.h>
+
+// PKTINSPECT_TRACE=0 or an empty value leaves recording off, like the other switches
+std::atomic<bool> Tracer::enabled{std::getenv("PKTINSPECT_TRACE")
+    && std::atoi(std::getenv("PKTINSPECT_TRACE")) != 0};
+
+namespace {
+
+/**
+ * Ring slot guarded by a sequence number: odd while the owner writes it,
+ * so a concurrent export can detect and skip torn slots
+ */
+struct TraceSlot {
+    std::atomic<uint64_t> sequence{0};
+    std::atomic<const char*> name{nullptr};
+    std::atomic<uint64_t> startNs{0};
+    std::atomic<uint64_t> endNs{0};
+    std::atomic<uint64_t> arg{0};
+};
+
+struct TraceRing {
+    uint32_t threadId;
+    std::atomic<uint64_t> head{0};    // Spans ever written by the owner
+    std::atomic<uint64_t> cleared{0}; // Spans before this index were exported with clear
+    std::atomic<bool> retired{false}; // The owner thread has exited
+    std::vector<TraceSlot> slots;
+
+    explicit TraceRing(uint32_t threadId) : threadId(threadId), slots(Tracer::TRACE_RING_CAPACITY) {}
+
+    bool drained() const {
+        return cleared.load(std::memory_order_relaxed) >= head.load(std::memory_order_acquire);
+    }
+};
+
+// Rings of exited threads kept for export; past this the oldest are dropped
+// (pipelines and scheduler runs start fresh threads for every request)
+const size_t MAX_RETIRED_RINGS = 64;
+
+std::mutex g_ringsMutex;
+std::vector<std::shared_ptr<TraceRing>> g_rings;  // Creation order
+std::atomic<uint32_t> g_nextThreadId{1};
+
+/**
+ * Drop drained retired rings, and the oldest retired ones beyond MAX_RETIRED_RINGS
+ * Caller holds g_ringsMutex
+ */
+void pruneRetiredRings() {
+    size_t retired = 0;
+    for (const auto& ring : g_rings) {
+        retired += ring->retired.load(std::memory_order_acquire) ? 1 : 0;
+    }
+    size_t excess = retired > MAX_RETIRED_RINGS ? retired - MAX_RETIRED_RINGS : 0;
+    g_rings.erase(std::remove_if(g_rings.begin(), g_rings.end(), [&excess](const std::shared_ptr<TraceRing>& ring) {
+        if (!ring->retired.load(std::memory_order_acquire)) {
+            return false;
+        }
+        if (excess > 0) {
+            --excess;
+            return true;
+        }
+        return ring->drained();
+    }), g_rings.end());
+}
+
+/**
+ * Owns the calling thread's ring and retires it when the thread exits
+ * Spans still in the ring stay exportable until the next export with clear.
+ */
+struct RingOwner {
+    std::shared_ptr<TraceRing> ring;
+
+    RingOwner() : ring(std::make_shared<TraceRing>(g_nextThreadId++)) {
+        std::lock_guard<std::mutex> lock(g_ringsMutex);
+        pruneRetiredRings();
+        g_rings.push_back(ring);
+    }
+
+    ~RingOwner() {
+        ring->retired.store(true, std::memory_order_release);
+        std::lock_guard<std::mutex> lock(g_ringsMutex);
+        pruneRetiredRings();
+    }
+};
+
+TraceRing& localRing() {
+    thread_local RingOwner owner;
+    return *owner.ring;
+}
+
+} // namespace
+
+bool Tracer::isCompiledIn() {
+#ifdef PKTINSPECT_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Tracer::record(const char* name, uint64_t startNs, uint64_t endNs, uint64_t arg) {
+    TraceRing& ring = localRing();
+    uint64_t index = ring.head.load(std::memory_order_relaxed);
+    TraceSlot& slot = ring.slots[index % TRACE_RING_CAPACITY];
+
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.endNs.store(endNs, std::memory_order_relaxed);
+    slot.arg.store(arg, std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    ring.head.store(index + 1, std::memory_order_release);
+}
+
+json Tracer::exportChromeTrace(bool clear) {
+    std::vector<std::shared_ptr<TraceRing>> rings;
+    {
+        std::lock_guard<std::mutex> lock(g_ringsMutex);
+        rings = g_rings;
+    }
+
+    json events = json::array();
+    int pid = static_cast<int>(getpid());
+
+    for (const auto& ring : rings) {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t first = head > TRACE_RING_CAPACITY ? head - TRACE_RING_CAPACITY : 0;
+        first = std::max(first, ring->cleared.load(std::memory_order_relaxed));
+        if (first >= head) {
+            continue;
+        }
+
+        json meta;
+        meta["name"] = "thread_name";
+        meta["ph"] = "M";
+        meta["pid"] = pid;
+        meta["tid"] = ring->threadId;
+        meta["args"]["name"] = "thread-" + std::to_string(ring->threadId);
+        events.push_back(meta);
+
+        for (uint64_t index = first; index < head; ++index) {
+            const TraceSlot& slot = ring->slots[index % TRACE_RING_CAPACITY];
+            uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            const char* name = slot.name.load(std::memory_order_relaxed);
+            uint64_t startNs = slot.startNs.load(std::memory_order_relaxed);
+            uint64_t endNs = slot.endNs.load(std::memory_order_relaxed);
+            uint64_t arg = slot.arg.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+            if (before != after || before != 2 * index + 2 || !name) {
+                continue;  // Overwritten or being written while we read it
+            }
+
+            json event;
+            event["name"] = name;
+            event["cat"] = "pktinspect";
+            event["ph"] = "X";
+            event["pid"] = pid;
+            event["tid"] = ring->threadId;
+            event["ts"] = static_cast<double>(startNs) / 1000.0;
+            event["dur"] = static_cast<double>(endNs - startNs) / 1000.0;
+            if (arg != 0) {
+                event["args"]["n"] = arg;
+            }
+            events.push_back(event);
+        }
+
+        if (clear) {
+            ring->cleared.store(head, std::memory_order_relaxed);
+        }
+    }
+
+    if (clear) {
+        std::lock_guard<std::mutex> lock(g_ringsMutex);
+        pruneRetiredRings();
+    }
+
+    json output;
+    output["traceEvents"] = events;
+    output["displayTimeUnit"] = "ns";
+    return output;
+}
@@ -2,7 +2,8 @@
 #include <fstream>
 #include <sstream>
 
-std::map<std::string, std::vector<std::string>> PatternsLoader::loadPatterns(const std::string& filePath) {
+std::map<std::string, std::vector<std::string>> PatternsLoader::loadPatterns(
+    const std::string& filePath, std::map<std::string, std::vector<std::string>>* fields) {
     std::map<std::string, std::vector<std::string>> patterns;
 
     std::ifstream file(filePath);
@@ -15,12 +16,23 @@ std::map<std::string, std::vector<std::string>> PatternsLoader::loadPatterns(con
         json j;
         file >> j;
 
-        // Parse JSON structure: { "category": ["pattern1", "pattern2", ...], ... }
+        // Parse JSON structure: { "category": ["pattern1", {"pattern": "pattern2", "field": "uri"}, ...], ... }
         for (auto& [category, patternList] : j.items()) {
             if (patternList.is_array()) {
                 for (const auto& pattern : patternList) {
+                    std::string field;
                     if (pattern.is_string()) {
                         patterns[category].push_back(pattern.get<std::string>());
+                    } else if (pattern.is_object() && pattern.contains("pattern") && pattern["pattern"].is_string()) {
+                        patterns[category].push_back(pattern["pattern"].get<std::string>());
+                        if (pattern.contains("field") && pattern["field"].is_string()) {
+                            field = pattern["field"].get<std::string>();
+                        }
+                    } else {
+                        continue;
+                    }
+                    if (fields) {
+                        (*fields)[category].push_back(field);
                     }
                 }
             }
@@ -0,0 +1,205 @@
+#include "packet_inspection/utils/traffic_generator.hpp"
+#include <cstdio>
+#include <cctype>
+#include <algorithm>
+
+namespace {
+
+const char* const WORDS[] = {
+    "the", "network", "packet", "server", "client", "request", "response", "session",
+    "content", "value", "index", "user", "account", "update", "status", "message",
+    "data", "cache", "token", "stream", "header", "version", "profile", "image"
+};
+
+const char* const PATHS[] = {
+    "/", "/index.html", "/api/v1/users", "/static/app.js", "/login", "/search",
+    "/images/logo.png", "/cart/checkout", "/news/2024/article", "/favicon.ico"
+};
+
+const char* const AGENTS[] = {
+    "Mozilla/5.0 (X11; Linux x86_64)", "curl/8.4.0", "python-requests/2.31",
+    "Mozilla/5.0 (Windows NT 10.0; Win64; x64)"
+};
+
+void writeLe32(FILE* file, uint32_t value) {
+    uint8_t bytes[4] = {
+        static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8),
+        static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24)
+    };
+    fwrite(bytes, 1, 4, file);
+}
+
+void putBe16(std::string& out, uint16_t value) {
+    out += static_cast<char>(value >> 8);
+    out += static_cast<char>(value & 0xff);
+}
+
+void putBe32(std::string& out, uint32_t value) {
+    putBe16(out, static_cast<uint16_t>(value >> 16));
+    putBe16(out, static_cast<uint16_t>(value & 0xffff));
+}
+
+} // namespace
+
+void TrafficGenerator::appendText(std::string& out, size_t length) {
+    std::uniform_int_distribution<size_t> pick(0, sizeof(WORDS) / sizeof(WORDS[0]) - 1);
+    while (out.size() < length) {
+        out += WORDS[pick(rng)];
+        out += ' ';
+    }
+}
+
+std::string TrafficGenerator::generatePayload(uint32_t length) {
+    std::string payload;
+    payload.reserve(length);
+
+    switch (rng() % 4) {
+        case 0: {  // HTTP request
+            payload += (rng() % 3 == 0) ? "POST " : "GET ";
+            payload += PATHS[rng() % (sizeof(PATHS) / sizeof(PATHS[0]))];
+            payload += " HTTP/1.1\r\nHost: example.com\r\nUser-Agent: ";
+            payload += AGENTS[rng() % (sizeof(AGENTS) / sizeof(AGENTS[0]))];
+            payload += "\r\nAccept: */*\r\n\r\n";
+            appendText(payload, length);
+            break;
+        }
+        case 1: {  // Form body
+            while (payload.size() < length) {
+                payload += WORDS[rng() % (sizeof(WORDS) / sizeof(WORDS[0]))];
+                payload += '=';
+                payload += std::to_string(rng() % 100000);
+                payload += '&';
+            }
+            break;
+        }
+        case 2: {  // Binary
+            while (payload.size() < length) {
+                payload += static_cast<char>(rng() & 0xff);
+            }
+            break;
+        }
+        default:
+            appendText(payload, length);
+            break;
+    }
+
+    payload.resize(length);
+    return payload;
+}
+
+std::vector<GeneratedPacket> TrafficGenerator::generate(const TrafficProfile& profile,
+                                                        const std::vector<std::string>& patterns) {
+    std::vector<GeneratedPacket> packets;
+    packets.reserve(profile.packetCount);
+
+    std::uniform_int_distribution<uint32_t> lengthDist(profile.minPayload,
+                                                       std::max(profile.minPayload, profile.maxPayload));
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    uint32_t flows = std::max(1u, profile.flowCount);
+
+    for (size_t i = 0; i < profile.packetCount; ++i) {
+        GeneratedPacket packet;
+        packet.payload = generatePayload(lengthDist(rng));
+
+        if (!patterns.empty() && chance(rng) < profile.attackRate) {
+            std::string pattern = patterns[rng() % patterns.size()];
+            if (rng() % 2) {
+                for (char& c : pattern) {
+                    c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+                }
+            }
+            size_t at = packet.payload.empty() ? 0 : rng() % packet.payload.size();
+            packet.payload.replace(at, std::min(pattern.size(), packet.payload.size() - at), pattern);
+        }
+
+        // Client 10.0.x.y:port <-> server 10.1.0.z:80, direction chosen per packet
+        uint32_t flow = rng() % flows;
+        uint32_t clientIp = 0x0a000000u | (flow & 0xffff);
+        uint32_t serverIp = 0x0a010000u | (flow % 16);
+        uint16_t clientPort = static_cast<uint16_t>(32768 + flow % 28000);
+        if (rng() % 4 == 0) {
+            packet.srcIp = serverIp;
+            packet.dstIp = clientIp;
+            packet.srcPort = 80;
+            packet.dstPort = clientPort;
+        } else {
+            packet.srcIp = clientIp;
+            packet.dstIp = serverIp;
+            packet.srcPort = clientPort;
+            packet.dstPort = 80;
+        }
+        packets.push_back(std::move(packet));
+    }
+
+    return packets;
+}
+
+std::vector<std::string> TrafficGenerator::defaultPatterns() {
+    return {
+        // sql
+        "UNION SELECT", "' OR '1'='1", "DROP TABLE", "information_schema", "sleep(", "xp_cmdshell",
+        // xss
+        "<script", "javascript:", "onerror=", "document.cookie", "alert(", "<iframe",
+        // cmd
+        "/bin/sh", "cmd.exe", "wget http", "; cat /etc/passwd", "powershell -enc", "nc -e",
+        // malware
+        "X5O!P%@AP[4\\PZX54(P^)7CC)7}$EICAR", "eval(base64_decode", "mimikatz", "meterpreter",
+        // phishing
+        "verify your account", "login.php?redirect=", "paypal-secure", "account suspended"
+    };
+}
+
+bool TrafficGenerator::writePcap(const std::string& path, const std::vector<GeneratedPacket>& packets) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Could not create PCAP file: %s\n", path.c_str());
+        return false;
+    }
+
+    // Global header: magic, version 2.4, tz, sigfigs, snaplen, LINKTYPE_RAW
+    writeLe32(file, 0xa1b2c3d4);
+    writeLe32(file, 2 | (4u << 16));
+    writeLe32(file, 0);
+    writeLe32(file, 0);
+    writeLe32(file, 65535);
+    writeLe32(file, 101);
+
+    std::string frame;
+    for (size_t i = 0; i < packets.size(); ++i) {
+        const GeneratedPacket& packet = packets[i];
+        size_t payloadLen = std::min<size_t>(packet.payload.size(), 65535 - 40);
+
+        frame.clear();
+        // IPv4 header (20 bytes, checksum left zero)
+        frame += static_cast<char>(0x45);
+        frame += static_cast<char>(0);
+        putBe16(frame, static_cast<uint16_t>(40 + payloadLen));
+        putBe16(frame, static_cast<uint16_t>(i));
+        putBe16(frame, 0);
+        frame += static_cast<char>(64);
+        frame += static_cast<char>(6);
+        putBe16(frame, 0);
+        putBe32(frame, packet.srcIp);
+        putBe32(frame, packet.dstIp);
+        // TCP header (20 bytes)
+        putBe16(frame, packet.srcPort);
+        putBe16(frame, packet.dstPort);
+        putBe32(frame, static_cast<uint32_t>(i));
+        putBe32(frame, 0);
+        frame += static_cast<char>(0x50);
+        frame += static_cast<char>(0x18);
+        putBe16(frame, 65535);
+        putBe16(frame, 0);
+        putBe16(frame, 0);
+        frame.append(packet.payload, 0, payloadLen);
+
+        writeLe32(file, static_cast<uint32_t>(i / 1000));
+        writeLe32(file, static_cast<uint32_t>((i % 1000) * 1000));
+        writeLe32(file, static_cast<uint32_t>(frame.size()));
+        writeLe32(file, static_cast<uint32_t>(frame.size()));
+        fwrite(frame.data(), 1, frame.size(), file);
+    }
+
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,829 @@
+/**
+ * engine_oracle: differential correctness check for the matching engines
+ *
+ * Runs every engine over generated and fuzzed payloads and diffs the matches
+ * against a naive memmem reference (case-insensitive, all occurrences).
+ * Engines report in one of three shapes, each compared on what it promises:
+ *   - all occurrences:   (pattern, end position) pairs must be identical
+ *   - first per pattern: AhoCorasick::scan() keeps the first match per pattern
+ *   - positions only:    DFABuilder::match() reports end positions without
+ *                        patterns; it restarts at the start state on a miss,
+ *                        so it misses overlapping matches. Those misses are
+ *                        reported as a known legacy gap and only fail with
+ *                        --strict.
+ * The http.* engines wrap each payload in an HTTP message (percent-encoded
+ * URI; form-encoded, gzipped, base64 and chunked body), feed it in random
+ * pieces and expect the payload's matches in the normalized field; the
+ * .hex variants first pass the message through the hex decoding that
+ * POST /scan applies to "isHex" payloads. Chunked bodies end with a trailer
+ * field made of the payload, and every field besides the one under test
+ * must match exactly as it does scanned alone.
+ * The fields.* engines aim every pattern at the body and put the payload
+ * there (Content-Length or chunked, the latter ending with that trailer),
+ * with decoy copies of it in the URI, a header and the trailer that must
+ * not match.
+ * Also prints the throughput of every engine over the same corpus.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <map>
+#include <set>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <tuple>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "packet_inspection/ac/aho_corasick.hpp"
+#include "packet_inspection/pcap/packet_reader.hpp"
+#include "packet_inspection/dfa/dfa_builder.hpp"
+#include "packet_inspection/utils/patterns_loader.hpp"
+#include "packet_inspection/utils/traffic_generator.hpp"
+#include "packet_inspection/engine/matcher_selector.hpp"
+#include "packet_inspection/engine/scan_arena.hpp"
+#include "packet_inspection/http/http_scanner.hpp"
+#include "packet_inspection/http/field_scoped_matcher.hpp"
+#ifdef PKTINSPECT_ZLIB
+#include <zlib.h>
+#endif
+
+namespace {
+
+using MatchSet = std::vector<std::pair<uint32_t, uint32_t>>;  // (patternId, end position), sorted
+
+enum class MatchShape {
+    AllOccurrences,
+    FirstPerPattern,
+    PositionsOnly
+};
+
+/**
+ * One engine under test, built for a pattern set
+ * run() fills a MatchSet; for PositionsOnly engines patternId is 0
+ */
+struct OracleEngine {
+    std::string name;
+    MatchShape shape;
+    bool gating;  // Mismatches fail the run
+    std::function<void(const std::string& payload, MatchSet& out)> run;
+};
+
+struct EngineReport {
+    uint64_t payloads = 0;
+    uint64_t mismatchedPayloads = 0;
+    uint64_t missing = 0;
+    uint64_t extra = 0;
+    double seconds = 0.0;
+    uint64_t bytes = 0;
+    bool gating = true;
+    std::vector<std::string> examples;
+};
+
+struct Options {
+    std::string patternsFile;
+    uint32_t seed = 1;
+    int rounds = 20;
+    size_t payloadsPerRound = 300;
+    bool strict = false;
+    size_t maxExamples = 3;
+};
+
+std::string foldCase(const std::string& text) {
+    std::string folded(text);
+    for (char& c : folded) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return folded;
+}
+
+/**
+ * Reference matcher: memmem over case-folded text, every occurrence
+ */
+class NaiveReference {
+public:
+    explicit NaiveReference(const std::vector<std::string>& patterns) {
+        for (const auto& pattern : patterns) {
+            folded.push_back(foldCase(pattern));
+        }
+    }
+
+    void run(const std::string& payload, MatchSet& out) const {
+        std::string text = foldCase(payload);
+        for (uint32_t id = 0; id < folded.size(); ++id) {
+            const std::string& needle = folded[id];
+            if (needle.empty()) continue;
+            const char* base = text.data();
+            size_t offset = 0;
+            while (offset + needle.size() <= text.size()) {
+                const void* hit = memmem(base + offset, text.size() - offset, needle.data(), needle.size());
+                if (!hit) break;
+                size_t start = static_cast<const char*>(hit) - base;
+                out.emplace_back(id, static_cast<uint32_t>(start + needle.size() - 1));
+                offset = start + 1;
+            }
+        }
+    }
+
+private:
+    std::vector<std::string> folded;
+};
+
+std::string printable(const std::string& payload, size_t limit = 48) {
+    std::string out;
+    for (size_t i = 0; i < payload.size() && i < limit; ++i) {
+        unsigned char c = static_cast<unsigned char>(payload[i]);
+        if (std::isprint(c) && c != '\\') {
+            out += static_cast<char>(c);
+        } else {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\x%02x", c);
+            out += buf;
+        }
+    }
+    if (payload.size() > limit) out += "...";
+    return out;
+}
+
+/**
+ * Reduce the reference to what an engine of the given shape promises
+ */
+MatchSet expectedFor(MatchShape shape, const MatchSet& reference, const std::vector<std::string>& patterns) {
+    MatchSet expected;
+    if (shape == MatchShape::AllOccurrences) {
+        expected = reference;
+    } else if (shape == MatchShape::FirstPerPattern) {
+        // AhoCorasick::scan dedups by pattern text; identical patterns collapse to the lowest id
+        std::map<std::string, std::pair<uint32_t, uint32_t>> first;
+        for (const auto& [id, pos] : reference) {
+            auto it = first.find(patterns[id]);
+            if (it == first.end() || pos < it->second.second ||
+                (pos == it->second.second && id < it->second.first)) {
+                first[patterns[id]] = {id, pos};
+            }
+        }
+        for (const auto& [text, match] : first) {
+            expected.push_back(match);
+        }
+    } else {
+        std::set<uint32_t> positions;
+        for (const auto& match : reference) {
+            positions.insert(match.second);
+        }
+        for (uint32_t pos : positions) {
+            expected.emplace_back(0, pos);
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+    return expected;
+}
+
+/**
+ * Cut a payload into scattered spans: random sizes, with empty and
+ * single-byte pieces, so span boundaries land inside matches
+ */
+std::vector<ByteSpan> splitSpans(const std::string& payload) {
+    std::mt19937 rng(static_cast<uint32_t>(payload.size() * 2654435761u));
+    std::vector<ByteSpan> spans;
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(payload.data());
+    size_t offset = 0;
+    while (offset < payload.size()) {
+        uint32_t kind = rng() % 8;
+        size_t length = kind == 0 ? 0 : kind <= 2 ? 1 : 1 + rng() % 24;
+        length = std::min(length, payload.size() - offset);
+        spans.push_back({data + offset, length});
+        offset += length;
+    }
+    return spans;
+}
+
+/**
+ * Scan a payload inside a batch of its own pieces and keep its rows
+ * The payload sits at a length-dependent slot among the pieces, so lanes
+ * start, finish and refill at different points. Rows out of packet order
+ * add an impossible match, which fails the comparison.
+ */
+void runInBatch(const std::string& payload, const std::function<void(const ByteSpan*, size_t, BatchHits&)>& scanBatch,
+                MatchSet& out) {
+    std::vector<ByteSpan> packets = splitSpans(payload);
+    const uint32_t slot = static_cast<uint32_t>(payload.size() % (packets.size() + 1));
+    packets.insert(packets.begin() + slot, {reinterpret_cast<const uint8_t*>(payload.data()), payload.size()});
+
+    BatchHits hits;
+    scanBatch(packets.data(), packets.size(), hits);
+    for (size_t i = 0; i < hits.size(); ++i) {
+        if (i > 0 && hits.packetIndex[i] < hits.packetIndex[i - 1]) {
+            out.emplace_back(UINT32_MAX, UINT32_MAX);
+        }
+        if (hits.packetIndex[i] == slot) {
+            out.emplace_back(hits.patternId[i], hits.offset[i]);
+        }
+    }
+}
+
+const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+/**
+ * Percent-encode a random share of the bytes, and every byte that would
+ * not survive as itself ('%', '+', '?', space and controls)
+ * @param plusForSpace Encode spaces as '+' (form bodies)
+ */
+std::string percentEncode(const std::string& text, std::mt19937& rng, bool plusForSpace) {
+    std::string out;
+    for (unsigned char c : text) {
+        if (c == ' ' && plusForSpace) {
+            out += '+';
+        } else if (std::isalnum(c) && rng() % 2 == 0) {
+            out += static_cast<char>(c);
+        } else {
+            out += '%';
+            out += HEX_DIGITS[c >> 4];
+            out += HEX_DIGITS[c & 0x0f];
+        }
+    }
+    return out;
+}
+
+std::string base64Encode(const std::string& data) {
+    static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    size_t i = 0;
+    for (; i + 3 <= data.size(); i += 3) {
+        uint32_t bits = static_cast<uint8_t>(data[i]) << 16 | static_cast<uint8_t>(data[i + 1]) << 8 |
+                        static_cast<uint8_t>(data[i + 2]);
+        for (int shift = 18; shift >= 0; shift -= 6) out += alphabet[(bits >> shift) & 63];
+        if (i % 57 == 54) out += "\r\n";  // MIME line breaks
+    }
+    if (i < data.size()) {
+        uint32_t bits = static_cast<uint8_t>(data[i]) << 16;
+        if (i + 1 < data.size()) bits |= static_cast<uint8_t>(data[i + 1]) << 8;
+        out += alphabet[bits >> 18];
+        out += alphabet[(bits >> 12) & 63];
+        out += i + 1 < data.size() ? alphabet[(bits >> 6) & 63] : '=';
+        out += '=';
+    }
+    return out;
+}
+
+#ifdef PKTINSPECT_ZLIB
+std::string gzipEncode(const std::string& data) {
+    z_stream stream{};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+    std::string out(deflateBound(&stream, data.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(out.data());
+    stream.avail_out = static_cast<uInt>(out.size());
+    deflate(&stream, Z_FINISH);
+    out.resize(stream.total_out);
+    deflateEnd(&stream);
+    return out;
+}
+#endif
+
+/**
+ * Trailer field of a chunked message built from the payload
+ * The name is the payload's token characters, so a body match carried into
+ * the trailer (or a trailer counted as body) shows up as an extra match
+ */
+std::pair<std::string, std::string> trailerField(const std::string& payload) {
+    std::string name = "X-", value = payload.substr(0, 256);
+    for (char c : value) {
+        if (std::isalnum(static_cast<unsigned char>(c)) || c == '-') name += c;
+    }
+    for (char& c : value) {
+        if (!std::isgraph(static_cast<unsigned char>(c))) c = '_';
+    }
+    return {name, value};
+}
+
+/**
+ * A field of an oracle HTTP message other than the one under test, as sent
+ */
+struct SentField {
+    HttpField field;
+    std::string text;
+};
+
+/**
+ * Wrap a payload in an HTTP request whose normalized field is the payload
+ * @param field HttpField::Uri or HttpField::Body
+ * @param others Receives the message's other fields, in order
+ */
+std::string httpMessage(const std::string& payload, HttpField field, std::mt19937& rng,
+                        std::vector<SentField>& others) {
+    std::string headers;
+    auto header = [&](const std::string& name, const std::string& value) {
+        headers += name + ": " + value + "\r\n";
+        others.push_back({HttpField::HeaderName, name});
+        others.push_back({HttpField::HeaderValue, value});
+    };
+
+    if (field == HttpField::Uri) {
+        others = {{HttpField::Method, "GET"}, {HttpField::Version, "HTTP/1.1"}};
+        header("Host", "oracle");
+        return "GET " + percentEncode(payload, rng, false) + " HTTP/1.1\r\n" + headers + "\r\n";
+    }
+
+    others = {{HttpField::Method, "POST"}, {HttpField::Uri, "/submit"}, {HttpField::Version, "HTTP/1.1"}};
+    std::string body = percentEncode(payload, rng, true);
+    header("Content-Type", "application/x-www-form-urlencoded");
+#ifdef PKTINSPECT_ZLIB
+    body = gzipEncode(body);
+    header("Content-Encoding", "gzip");
+#endif
+    body = base64Encode(body);
+    header("Content-Transfer-Encoding", "base64");
+    header("Transfer-Encoding", "chunked");
+
+    std::string message = "POST /submit HTTP/1.1\r\n" + headers + "\r\n";
+    size_t offset = 0;
+    while (offset < body.size()) {
+        size_t length = std::min<size_t>(body.size() - offset, 1 + rng() % 64);
+        char size[24];
+        snprintf(size, sizeof(size), "%zx\r\n", length);
+        message += size;
+        message.append(body, offset, length);
+        message += "\r\n";
+        offset += length;
+    }
+    auto [name, value] = trailerField(payload);
+    headers.clear();
+    header(name, value);
+    return message + "0\r\n" + headers + "\r\n";
+}
+
+/**
+ * Feed a payload's HTTP message in random pieces and keep the hits in its field
+ * The other fields must match exactly as they do scanned alone, so nothing
+ * carries over between neighbouring fields (body and trailer, say)
+ * @param hex Send the message through the hex encoding /scan accepts ("isHex") first
+ */
+void runHttp(const std::string& payload, HttpField field, bool hex, const Matcher& matcher,
+             HttpScanner& scanner, MatchSet& out) {
+    if (payload.empty() && field == HttpField::Uri) {
+        return;  // A request line needs a URI
+    }
+    std::mt19937 rng(static_cast<uint32_t>(payload.size() * 2654435761u));
+    std::vector<SentField> others;
+    std::string message = httpMessage(payload, field, rng, others);
+    if (hex) {
+        message = PacketReader::hexToBytes(
+            PacketReader::bytesToHex(reinterpret_cast<const uint8_t*>(message.data()), message.size()));
+    }
+    std::vector<ByteSpan> pieces = splitSpans(message);
+
+    scanner.reset();
+    scanner.clearHits();
+    bool valid = true;
+    for (const ByteSpan& piece : pieces) {
+        valid = scanner.feed(piece.data, piece.length) && valid;
+    }
+    scanner.finish();
+    if (!valid) {
+        out.emplace_back(UINT32_MAX, UINT32_MAX);  // Fails the comparison
+    }
+
+    std::vector<std::tuple<HttpField, uint32_t, uint32_t>> expected, seen;
+    std::vector<PatternHit> alone;
+    for (const SentField& other : others) {
+        alone.clear();
+        matcher.scan(reinterpret_cast<const uint8_t*>(other.text.data()), other.text.size(), alone);
+        for (const PatternHit& hit : alone) {
+            expected.emplace_back(other.field, hit.patternId, hit.position);
+        }
+    }
+    for (const HttpHit& hit : scanner.getHits()) {
+        if (hit.field == field) {
+            out.emplace_back(hit.patternId, hit.position);
+        } else {
+            seen.emplace_back(hit.field, hit.patternId, hit.position);
+        }
+    }
+    std::sort(expected.begin(), expected.end());
+    std::sort(seen.begin(), seen.end());
+    if (seen != expected) {
+        out.emplace_back(UINT32_MAX, UINT32_MAX);
+    }
+}
+
+/**
+ * Scan a payload sent as a message body with field-scoped patterns (all aimed at the body)
+ * @param chunked Chunked framing with random chunk sizes instead of Content-Length
+ */
+void runFields(const std::string& payload, bool chunked, const FieldScopedMatcher& matcher, MatchSet& out) {
+    std::string decoy = payload.substr(0, 256);
+    for (char& c : decoy) {
+        if (!std::isgraph(static_cast<unsigned char>(c))) c = '_';
+    }
+    std::string message = "POST /" + decoy + " HTTP/1.1\r\nX-Decoy: " + decoy + "\r\n";
+
+    // Body pieces as (message offset, payload offset)
+    std::vector<std::pair<size_t, size_t>> pieces;
+    if (chunked) {
+        message += "Transfer-Encoding: chunked\r\n\r\n";
+        std::mt19937 rng(static_cast<uint32_t>(payload.size() * 2654435761u));
+        size_t offset = 0;
+        while (offset < payload.size()) {
+            size_t length = std::min<size_t>(payload.size() - offset, 1 + rng() % 48);
+            char size[24];
+            snprintf(size, sizeof(size), "%zx\r\n", length);
+            message += size;
+            pieces.emplace_back(message.size(), offset);
+            message.append(payload, offset, length);
+            message += "\r\n";
+            offset += length;
+        }
+        auto [name, value] = trailerField(payload);
+        message += "0\r\n" + name + ": " + value + "\r\n\r\n";
+    } else {
+        message += "Content-Length: " + std::to_string(payload.size()) + "\r\n\r\n";
+        pieces.emplace_back(message.size(), 0);
+        message += payload;
+    }
+
+    std::vector<FieldHit> hits;
+    if (!matcher.scan(reinterpret_cast<const uint8_t*>(message.data()), message.size(), hits)) {
+        out.emplace_back(UINT32_MAX, UINT32_MAX);  // Fails the comparison
+        return;
+    }
+    for (const FieldHit& hit : hits) {
+        // Back to a payload offset through the piece holding the match's last byte
+        auto piece = std::upper_bound(pieces.begin(), pieces.end(), std::make_pair(size_t(hit.position), SIZE_MAX));
+        if (hit.field != HttpField::Body || piece == pieces.begin()) {
+            out.emplace_back(UINT32_MAX, hit.position);
+            continue;
+        }
+        --piece;
+        out.emplace_back(hit.patternId, static_cast<uint32_t>(hit.position - piece->first + piece->second));
+    }
+}
+
+std::vector<OracleEngine> makeEngines(const std::vector<std::string>& patterns,
+                                      AhoCorasick& automaton, DFABuilder& dfa) {
+    std::vector<OracleEngine> engines;
+
+    engines.push_back({"ac.scanHits", MatchShape::AllOccurrences, true,
+        [&automaton](const std::string& payload, MatchSet& out) {
+            std::vector<PatternHit> hits;
+            automaton.scanHits(reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), hits);
+            for (const auto& hit : hits) {
+                out.emplace_back(hit.patternId, hit.position);
+            }
+        }});
+
+    engines.push_back({"ac.scanHits.spans", MatchShape::AllOccurrences, true,
+        [&automaton](const std::string& payload, MatchSet& out) {
+            std::vector<ByteSpan> spans = splitSpans(payload);
+            std::vector<PatternHit> hits;
+            automaton.scanHits(spans.data(), spans.size(), hits);
+            for (const auto& hit : hits) {
+                out.emplace_back(hit.patternId, hit.position);
+            }
+        }});
+
+    engines.push_back({"ac.scanBatch", MatchShape::AllOccurrences, true,
+        [&automaton](const std::string& payload, MatchSet& out) {
+            runInBatch(payload, [&automaton](const ByteSpan* packets, size_t count, BatchHits& hits) {
+                automaton.scanBatch(packets, count, hits);
+            }, out);
+        }});
+
+    engines.push_back({"ac.scan", MatchShape::FirstPerPattern, true,
+        [&automaton](const std::string& payload, MatchSet& out) {
+            ScanResult result = automaton.scan(payload, 0);
+            for (const auto& match : result.matches) {
+                out.emplace_back(match.patternId, match.position);
+            }
+        }});
+
+    engines.push_back({"dfa.match", MatchShape::PositionsOnly, false,
+        [&dfa](const std::string& payload, MatchSet& out) {
+            std::set<uint32_t> positions;
+            for (uint32_t pos : dfa.match(payload)) {
+                positions.insert(pos);
+            }
+            for (uint32_t pos : positions) {
+                out.emplace_back(0, pos);
+            }
+        }});
+
+    // Every registered Matcher engine that accepts the set
+    auto patternSet = std::make_shared<const PatternSet>(patterns);
+    for (const EngineInfo& info : MatcherSelector::engines()) {
+        if (!info.supports(*patternSet)) continue;
+        std::shared_ptr<Matcher> matcher = info.create(patternSet);
+        engines.push_back({std::string("engine.") + info.name, MatchShape::AllOccurrences, true,
+            [matcher](const std::string& payload, MatchSet& out) {
+                std::vector<PatternHit> hits;
+                matcher->scan(reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), hits);
+                for (const auto& hit : hits) {
+                    out.emplace_back(hit.patternId, hit.position);
+                }
+            }});
+        engines.push_back({std::string("engine.") + info.name + ".spans", MatchShape::AllOccurrences, true,
+            [matcher](const std::string& payload, MatchSet& out) {
+                std::vector<ByteSpan> spans = splitSpans(payload);
+                std::vector<PatternHit> hits;
+                matcher->scanSpans(spans.data(), spans.size(), hits);
+                for (const auto& hit : hits) {
+                    out.emplace_back(hit.patternId, hit.position);
+                }
+            }});
+        engines.push_back({std::string("engine.") + info.name + ".batch", MatchShape::AllOccurrences, true,
+            [matcher](const std::string& payload, MatchSet& out) {
+                runInBatch(payload, [&matcher](const ByteSpan* packets, size_t count, BatchHits& hits) {
+                    matcher->scanBatch(packets, count, hits);
+                }, out);
+            }});
+    }
+
+    // The /scan-pcap result path: engine hits reduced to first-per-pattern in a ScanArena
+    if (auto matcher = std::shared_ptr<Matcher>(MatcherSelector::create("ac-table", patternSet))) {
+        auto arena = std::make_shared<ScanArena>();
+        engines.push_back({"arena.ac-table", MatchShape::FirstPerPattern, true,
+            [matcher, arena, patternSet](const std::string& payload, MatchSet& out) {
+                std::vector<PatternHit> hits;
+                const uint8_t* data = reinterpret_cast<const uint8_t*>(payload.data());
+                matcher->scan(data, payload.size(), hits);
+                arena->reset(patternSet);
+                arena->add(0, 0, data, static_cast<uint32_t>(payload.size()), hits.data(), hits.size());
+                const PacketMatches& packet = arena->packetAt(0);
+                for (uint32_t i = 0; i < packet.matchCount; ++i) {
+                    const PatternHit& match = arena->matchAt(packet.firstMatch + i);
+                    out.emplace_back(match.patternId, match.position);
+                }
+            }});
+    }
+
+    // Field-scoped matching: every pattern aimed at the body
+    FieldTarget body;
+    FieldTarget::parse("body", body);
+    auto fields = std::make_shared<const FieldScopedMatcher>(patternSet,
+                                                             std::vector<FieldTarget>(patterns.size(), body));
+    for (bool chunked : {false, true}) {
+        engines.push_back({chunked ? "fields.chunked" : "fields.body", MatchShape::AllOccurrences, true,
+            [fields, chunked](const std::string& payload, MatchSet& out) { runFields(payload, chunked, *fields, out); }});
+    }
+
+    // Matching on normalized HTTP fields (HttpScanner over the ac-table DFA)
+    auto table = std::make_shared<const AcTableMatcher>(patternSet);
+    for (HttpField field : {HttpField::Uri, HttpField::Body}) {
+        for (bool hex : {false, true}) {
+            auto scanner = std::make_shared<HttpScanner>(table);
+            engines.push_back({std::string("http.") + httpFieldName(field) + (hex ? ".hex" : ""),
+                MatchShape::AllOccurrences, true, [table, scanner, field, hex](const std::string& payload, MatchSet& out) {
+                    runHttp(payload, field, hex, *table, *scanner, out);
+                }});
+        }
+    }
+
+    return engines;
+}
+
+/**
+ * Pattern sets that stress fail links: tiny alphabets, shared prefixes and
+ * suffixes, patterns contained in other patterns, duplicates, mixed case.
+ * Some sets hold only long literals (4-40 bytes) or only secrets (32-96
+ * bytes), and some mix secrets into short sets, so the engines that need a
+ * minimum length (wu-manber, rabin-karp) or a mix (hybrid) are exercised too.
+ */
+std::vector<std::string> fuzzPatterns(std::mt19937& rng) {
+    const std::string alphabet = (rng() % 2) ? "ab" : "abcAB";
+    const uint32_t mode = rng() % 4;  // 0: long literals, 1: secrets, else short
+    auto randomPattern = [&](size_t length) {
+        std::string pattern;
+        for (size_t j = 0; j < length; ++j) {
+            pattern += alphabet[rng() % alphabet.size()];
+        }
+        return pattern;
+    };
+
+    std::vector<std::string> patterns;
+    size_t count = 1 + rng() % 12;
+    for (size_t i = 0; i < count; ++i) {
+        size_t length = mode == 0 ? 4 + rng() % 37 : mode == 1 ? 32 + rng() % 65 : 1 + rng() % 6;
+        patterns.push_back(randomPattern(length));
+    }
+    if (mode != 1 && rng() % 3 == 0) {
+        for (size_t i = 1 + rng() % 2; i > 0; --i) {
+            patterns.push_back(randomPattern(32 + rng() % 65));
+        }
+    }
+    if (rng() % 3 == 0) {
+        patterns.push_back(patterns[rng() % patterns.size()]);
+    }
+    return patterns;
+}
+
+std::vector<std::string> fuzzPayloads(std::mt19937& rng, const std::vector<std::string>& patterns, size_t count) {
+    std::vector<std::string> payloads;
+    for (size_t i = 0; i < count; ++i) {
+        std::string payload;
+        size_t pieces = rng() % 16;
+        for (size_t j = 0; j < pieces; ++j) {
+            switch (rng() % 4) {
+                case 0:  // Whole pattern, random case
+                case 1: {
+                    std::string piece = patterns[rng() % patterns.size()];
+                    for (char& c : piece) {
+                        if (rng() % 2) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+                    }
+                    payload += piece;
+                    break;
+                }
+                case 2: {  // Pattern prefix, builds overlaps with the next piece
+                    const std::string& piece = patterns[rng() % patterns.size()];
+                    payload += piece.substr(0, rng() % (piece.size() + 1));
+                    break;
+                }
+                default:  // Random bytes, including the high range
+                    for (size_t k = rng() % 4; k > 0; --k) {
+                        payload += static_cast<char>(rng() % 256);
+                    }
+            }
+        }
+        payloads.push_back(payload);
+    }
+    return payloads;
+}
+
+void checkRound(const std::vector<std::string>& patterns, const std::vector<std::string>& payloads,
+                std::map<std::string, EngineReport>& reports, const Options& opts) {
+    AhoCorasick automaton;
+    automaton.buildFromPatterns(patterns);
+    DFABuilder dfa;
+    dfa.buildFromPatterns(patterns);
+    NaiveReference reference(patterns);
+
+    std::vector<OracleEngine> engines = makeEngines(patterns, automaton, dfa);
+    engines.insert(engines.begin(), OracleEngine{"memmem", MatchShape::AllOccurrences, false,
+        [&reference](const std::string& payload, MatchSet& out) { reference.run(payload, out); }});
+
+    MatchSet expectedAll;
+    MatchSet actual;
+    for (const auto& payload : payloads) {
+        expectedAll.clear();
+        reference.run(payload, expectedAll);
+        std::sort(expectedAll.begin(), expectedAll.end());
+
+        for (const auto& engine : engines) {
+            EngineReport& report = reports[engine.name];
+            report.gating = engine.gating;
+            actual.clear();
+
+            auto start = std::chrono::steady_clock::now();
+            engine.run(payload, actual);
+            report.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            report.bytes += payload.size();
+            report.payloads++;
+
+            std::sort(actual.begin(), actual.end());
+            MatchSet expected = expectedFor(engine.shape, expectedAll, patterns);
+            if (actual == expected) {
+                continue;
+            }
+
+            MatchSet missing, extra;
+            std::set_difference(expected.begin(), expected.end(), actual.begin(), actual.end(),
+                                std::back_inserter(missing));
+            std::set_difference(actual.begin(), actual.end(), expected.begin(), expected.end(),
+                                std::back_inserter(extra));
+            report.mismatchedPayloads++;
+            report.missing += missing.size();
+            report.extra += extra.size();
+
+            if (report.examples.size() < opts.maxExamples) {
+                std::string example = "payload \"" + printable(payload) + "\"";
+                auto describe = [&](const char* label, const MatchSet& set) {
+                    if (set.empty()) return;
+                    example += std::string("\n      ") + label + ":";
+                    for (size_t k = 0; k < set.size() && k < 4; ++k) {
+                        // Out-of-range ids are the failure markers of the http.* and fields.* runs
+                        example += engine.shape == MatchShape::PositionsOnly ? " @" + std::to_string(set[k].second)
+                                 : set[k].first >= patterns.size() ? std::string(" <not valid or stray match>")
+                                 : " \"" + printable(patterns[set[k].first], 24) + "\"@" + std::to_string(set[k].second);
+                    }
+                    if (set.size() > 4) example += " ...";
+                };
+                describe("missing", missing);
+                describe("extra", extra);
+                report.examples.push_back(example);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool valid = true;
+        try {
+            if (arg == "--patterns" && hasValue) {
+                opts.patternsFile = argv[++i];
+            } else if (arg == "--seed" && hasValue) {
+                opts.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--rounds" && hasValue) {
+                opts.rounds = std::stoi(argv[++i]);
+            } else if (arg == "--payloads" && hasValue) {
+                opts.payloadsPerRound = std::stoul(argv[++i]);
+            } else if (arg == "--strict") {
+                opts.strict = true;
+            } else {
+                valid = false;
+            }
+        } catch (const std::exception&) {
+            fprintf(stderr, "Error: invalid value for %s: %s\n", arg.c_str(), argv[i]);
+            valid = false;
+        }
+        if (!valid) {
+            fprintf(stderr,
+                "Usage: %s [--patterns FILE] [--seed N] [--rounds N] [--payloads N] [--strict]\n"
+                "  --strict  also fail on the known DFABuilder::match overlap misses\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::vector<std::string> basePatterns = opts.patternsFile.empty()
+        ? TrafficGenerator::defaultPatterns()
+        : PatternsLoader::flattenPatterns(PatternsLoader::loadPatterns(opts.patternsFile));
+    if (basePatterns.empty()) {
+        fprintf(stderr, "Error: no patterns loaded\n");
+        return 1;
+    }
+
+    // Engine construction logs to stdout; keep the report readable
+    std::map<std::string, EngineReport> reports;
+    std::mt19937 rng(opts.seed);
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    int devNull = open("/dev/null", O_WRONLY);
+    dup2(devNull, STDOUT_FILENO);
+
+    // Round 0: realistic traffic against the real pattern set
+    {
+        TrafficProfile profile;
+        profile.packetCount = opts.payloadsPerRound * 4;
+        profile.attackRate = 0.3;
+        TrafficGenerator generator(opts.seed);
+        std::vector<std::string> payloads;
+        for (auto& packet : generator.generate(profile, basePatterns)) {
+            payloads.push_back(std::move(packet.payload));
+        }
+        std::vector<std::string> fuzzed = fuzzPayloads(rng, basePatterns, opts.payloadsPerRound);
+        payloads.insert(payloads.end(), fuzzed.begin(), fuzzed.end());
+        checkRound(basePatterns, payloads, reports, opts);
+    }
+
+    // Remaining rounds: fuzzed pattern sets over fuzzed payloads
+    for (int round = 1; round < opts.rounds; ++round) {
+        std::vector<std::string> patterns = fuzzPatterns(rng);
+        checkRound(patterns, fuzzPayloads(rng, patterns, opts.payloadsPerRound), reports, opts);
+    }
+
+    fflush(stdout);
+    dup2(savedStdout, STDOUT_FILENO);
+    close(savedStdout);
+    close(devNull);
+
+    int failures = 0;
+    printf("%-26s %10s %12s %10s %10s %10s  %s\n",
+           "engine", "payloads", "mismatched", "missing", "extra", "MB/s", "verdict");
+    std::vector<std::string> order = {"memmem"};
+    for (const auto& [name, r] : reports) {
+        if (name != "memmem") order.push_back(name);
+    }
+
+    for (const auto& name : order) {
+        const EngineReport& r = reports[name];
+        bool failed = r.mismatchedPayloads > 0 && (r.gating || opts.strict);
+        const char* verdict = r.mismatchedPayloads == 0 ? "ok"
+                            : failed ? "MISMATCH" : "known gap, not gating (see --strict)";
+        if (failed) failures++;
+
+        double mbPerSec = r.seconds > 0 ? static_cast<double>(r.bytes) / (1024.0 * 1024.0) / r.seconds : 0.0;
+        printf("%-26s %10llu %12llu %10llu %10llu %10.1f  %s\n", name.c_str(),
+               (unsigned long long)r.payloads, (unsigned long long)r.mismatchedPayloads,
+               (unsigned long long)r.missing, (unsigned long long)r.extra, mbPerSec, verdict);
+        for (const auto& example : r.examples) {
+            printf("    %s\n", example.c_str());
+        }
+    }
+
+    if (failures > 0) {
+        printf("\nengine_oracle FAILED: %d engine(s) disagree with the reference\n", failures);
+        return 1;
+    }
+    printf("\nengine_oracle passed\n");
+    return 0;
+}
@@ -0,0 +1,1115 @@
+/**
+ * pi_bench: benchmark harness for the matching engines
+ *
+ * Runs each engine over a generated workload several times and reports
+ * wall-clock throughput and heap allocations. With --counters, a separate
+ * pass reads hardware counters (perf_event_open) around every engine call and
+ * reports them per byte and per packet, so layout changes can be judged on
+ * cache misses and branch mispredicts rather than time alone.
+ *
+ * Regression gate (the perf-check target):
+ *   pi_bench --check perf/baseline.json --reference-dir DIR
+ * generates the reference capture described by the baseline's config, runs
+ * the suite on it and fails with a diff table when a case got slower or
+ * allocates more than the baseline allows. --update-baseline rewrites it.
+ * The baseline records the build type, compiler and flags it was taken with;
+ * the gate only runs from a Release build matching that record, and reruns a
+ * case that looks slower before calling it a regression.
+ *
+ * Times are also reported normalized to a fixed calibration loop run on the
+ * same machine, which is what the gate compares; raw nanoseconds from a
+ * different machine would not be comparable.
+ *
+ * Crossover mode (--crossover) sweeps the pattern length over random literal
+ * sets and reports where the hashing engine (wu-manber) overtakes the
+ * Aho-Corasick engines.
+ *
+ * TLB mode (--tlb) builds one large ac-table and scans it from 4 KB pages,
+ * transparent huge pages and hugetlb pages, with dTLB misses when counters
+ * are available.
+ *
+ * Scaling mode (--scaling) runs the capture through PacketPipeline with 1, 2,
+ * 4... matcher workers under each dispatch policy: work stealing, flow hash
+ * and plain round-robin batches.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <new>
+#include <atomic>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <fstream>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+#include "packet_inspection/ac/aho_corasick.hpp"
+#include "packet_inspection/dfa/dfa_builder.hpp"
+#include "packet_inspection/pcap/packet_reader.hpp"
+#include "packet_inspection/perf/perf_counters.hpp"
+#include "packet_inspection/utils/patterns_loader.hpp"
+#include "packet_inspection/utils/traffic_generator.hpp"
+#include "packet_inspection/engine/matcher_selector.hpp"
+#include "packet_inspection/stats/pattern_stats.hpp"
+#include "packet_inspection/pipeline/packet_pipeline.hpp"
+#include "packet_inspection/async/capture_stream.hpp"
+#include "packet_inspection/engine/ac_table_matcher.hpp"
+#include "packet_inspection/engine/scan_arena.hpp"
+#include "packet_inspection/http/http_scanner.hpp"
+#include "packet_inspection/http/field_scoped_matcher.hpp"
+#include "packet_inspection/mem/huge_page_buffer.hpp"
+
+using json = nlohmann::json;
+
+// Process-wide allocation counter for the allocation columns and the gate
+static std::atomic<uint64_t> g_allocations{0};
+
+// Results of otherwise side-effect-free cases land here so they are not optimized out
+static volatile uint64_t g_sink = 0;
+
+// GCC pairs the inlined free() below with the operator new it came from and flags
+// every one as mismatched; both sides are replaced here, so the pairing is sound
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    size_t align = std::max(static_cast<size_t>(alignment), sizeof(void*));
+    // aligned_alloc() wants the size to be a multiple of the alignment
+    size_t rounded = ((size ? size : 1) + align - 1) / align * align;
+    if (void* p = std::aligned_alloc(align, rounded)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+
+#pragma GCC diagnostic pop
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    std::string patternsFile;
+    std::vector<std::string> engines;
+    std::string jsonOutput;
+    std::string checkBaseline;
+    std::string referenceDir = ".";
+    TrafficProfile profile;
+    uint32_t seed = 42;
+    int iterations = 5;
+    bool counters = false;
+    bool updateBaseline = false;
+    bool crossover = false;
+    size_t crossoverPatterns = 500;
+    bool tlb = false;
+    size_t tlbPatterns = 20000;
+    bool scaling = false;
+    unsigned scalingWorkers = 64;
+};
+
+/**
+ * One benchmarked engine
+ * perPayload is called once per packet; perPass (if set) instead runs a whole
+ * pass itself, for cases such as reading the capture file
+ */
+struct BenchCase {
+    std::string name;
+    std::function<void(const std::string& payload)> perPayload;
+    std::function<void()> perPass;
+};
+
+struct BenchResult {
+    std::string name;
+    std::vector<double> seconds;  // One sample per iteration
+    double nsPerPacket = 0.0;
+    double madNsPerPacket = 0.0;  // Median absolute deviation across samples
+    double normalized = 0.0;      // nsPerPacket / calibration nsPerPacket
+    double mbPerSec = 0.0;
+    double allocsPerPacket = 0.0;
+    PerfCounts counts;
+};
+
+struct Workload {
+    std::vector<std::string> patterns;
+    std::vector<std::string> payloads;
+    std::string capturePath;
+    uint64_t totalBytes = 0;
+};
+
+void printUsage(const char* argv0) {
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --patterns FILE       patterns.json (default: built-in signature set)\n"
+        "  --packets N           generated packets (default 10000)\n"
+        "  --min-size N          minimum payload size (default 64)\n"
+        "  --max-size N          maximum payload size (default 1460)\n"
+        "  --attack-rate R       fraction of packets with a pattern (default 0.05)\n"
+        "  --seed N              generator seed (default 42)\n"
+        "  --iterations N        timed passes per engine (default 5)\n"
+        "  --engine NAME         only run this engine, repeatable\n"
+        "  --counters            collect hardware counters around each engine call\n"
+        "  --json FILE           also write results as JSON\n"
+        "  --reference-dir DIR   where the reference capture is written (default .)\n"
+        "  --check FILE          compare with a baseline, exit 1 on regression\n"
+        "  --update-baseline     with --check, rewrite the baseline from this run\n"
+        "  --crossover           sweep pattern lengths: wu-manber vs Aho-Corasick\n"
+        "  --crossover-patterns N  patterns per length in the sweep (default 500)\n"
+        "  --tlb                 compare page backings of a large ac-table\n"
+        "  --tlb-patterns N      patterns in the --tlb automaton (default 20000)\n"
+        "  --flows N             TCP connections in the generated traffic (default 64)\n"
+        "  --scaling             pipeline throughput for 1, 2, 4... matcher workers\n"
+        "  --scaling-workers N   largest worker count in the --scaling sweep (default 64)\n",
+        argv0);
+}
+
+bool parseArgs(int argc, char** argv, Options& opts) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--patterns" && hasValue) {
+                opts.patternsFile = argv[++i];
+            } else if (arg == "--packets" && hasValue) {
+                opts.profile.packetCount = std::stoul(argv[++i]);
+            } else if (arg == "--min-size" && hasValue) {
+                opts.profile.minPayload = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--max-size" && hasValue) {
+                opts.profile.maxPayload = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--attack-rate" && hasValue) {
+                opts.profile.attackRate = std::stod(argv[++i]);
+            } else if (arg == "--seed" && hasValue) {
+                opts.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--iterations" && hasValue) {
+                opts.iterations = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--engine" && hasValue) {
+                opts.engines.push_back(argv[++i]);
+            } else if (arg == "--json" && hasValue) {
+                opts.jsonOutput = argv[++i];
+            } else if (arg == "--reference-dir" && hasValue) {
+                opts.referenceDir = argv[++i];
+            } else if (arg == "--check" && hasValue) {
+                opts.checkBaseline = argv[++i];
+            } else if (arg == "--update-baseline") {
+                opts.updateBaseline = true;
+            } else if (arg == "--counters") {
+                opts.counters = true;
+            } else if (arg == "--crossover") {
+                opts.crossover = true;
+            } else if (arg == "--tlb") {
+                opts.tlb = true;
+            } else if (arg == "--tlb-patterns" && hasValue) {
+                opts.tlbPatterns = std::max<size_t>(1, std::stoul(argv[++i]));
+            } else if (arg == "--flows" && hasValue) {
+                opts.profile.flowCount = std::max(1u, static_cast<uint32_t>(std::stoul(argv[++i])));
+            } else if (arg == "--scaling") {
+                opts.scaling = true;
+            } else if (arg == "--scaling-workers" && hasValue) {
+                opts.scalingWorkers = std::max(1u, static_cast<unsigned>(std::stoul(argv[++i])));
+            } else if (arg == "--crossover-patterns" && hasValue) {
+                opts.crossoverPatterns = std::max<size_t>(1, std::stoul(argv[++i]));
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            fprintf(stderr, "Error: invalid value for %s: %s\n", arg.c_str(), argv[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2.0;
+}
+
+double medianAbsoluteDeviation(const std::vector<double>& values) {
+    double center = median(values);
+    std::vector<double> deviations;
+    for (double v : values) {
+        deviations.push_back(std::fabs(v - center));
+    }
+    return median(deviations);
+}
+
+/**
+ * Generate the workload, write it as a capture and read it back through
+ * PacketReader, so the benchmarked payloads are what the reader produces
+ */
+bool buildWorkload(const Options& opts, Workload& workload) {
+    workload.patterns = opts.patternsFile.empty()
+        ? TrafficGenerator::defaultPatterns()
+        : PatternsLoader::flattenPatterns(PatternsLoader::loadPatterns(opts.patternsFile));
+    if (workload.patterns.empty()) {
+        fprintf(stderr, "Error: no patterns loaded\n");
+        return false;
+    }
+
+    std::error_code ec;
+    fs::create_directories(opts.referenceDir, ec);
+    workload.capturePath = (fs::path(opts.referenceDir) /
+        ("reference-" + std::to_string(opts.seed) + "-" + std::to_string(opts.profile.packetCount) + ".pcap")).string();
+
+    TrafficGenerator generator(opts.seed);
+    if (!TrafficGenerator::writePcap(workload.capturePath, generator.generate(opts.profile, workload.patterns))) {
+        return false;
+    }
+
+    PacketReader reader;
+    for (const auto& packet : reader.readPcapFile(workload.capturePath)) {
+        workload.payloads.emplace_back(packet.payloadBytes.begin(), packet.payloadBytes.end());
+        workload.totalBytes += packet.payloadLength;
+    }
+    return !workload.payloads.empty();
+}
+
+void runPass(const BenchCase& bench, const std::vector<std::string>& payloads) {
+    if (bench.perPass) {
+        bench.perPass();
+        return;
+    }
+    for (const auto& payload : payloads) {
+        bench.perPayload(payload);
+    }
+}
+
+BenchResult runCase(const BenchCase& bench, const Workload& workload,
+                    int iterations, PerfCounters* counters) {
+    BenchResult result;
+    result.name = bench.name;
+    const double packets = static_cast<double>(workload.payloads.size());
+
+    // Warm-up pass so the first sample does not pay for cold caches
+    runPass(bench, workload.payloads);
+
+    for (int iter = 0; iter < iterations; ++iter) {
+        auto start = std::chrono::steady_clock::now();
+        runPass(bench, workload.payloads);
+        result.seconds.push_back(
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::vector<double> nsSamples;
+    for (double s : result.seconds) {
+        nsSamples.push_back(s * 1e9 / packets);
+    }
+    result.nsPerPacket = median(nsSamples);
+    result.madNsPerPacket = medianAbsoluteDeviation(nsSamples);
+    result.mbPerSec = static_cast<double>(workload.totalBytes) / (1024.0 * 1024.0) /
+                      (result.nsPerPacket * packets / 1e9);
+
+    uint64_t allocationsBefore = g_allocations.load();
+    runPass(bench, workload.payloads);
+    result.allocsPerPacket = static_cast<double>(g_allocations.load() - allocationsBefore) / packets;
+
+    // Counters in their own pass: the ioctls per call would skew wall-clock samples
+    if (counters) {
+        if (bench.perPass) {
+            PerfScope scope(*counters, result.counts);
+            bench.perPass();
+        } else {
+            for (const auto& payload : workload.payloads) {
+                PerfScope scope(*counters, result.counts);
+                bench.perPayload(payload);
+            }
+        }
+    }
+
+    return result;
+}
+
+json resultToJson(const BenchResult& result, const Workload& workload, bool withCounters) {
+    json entry;
+    entry["name"] = result.name;
+    entry["seconds"] = result.seconds;
+    entry["nsPerPacket"] = result.nsPerPacket;
+    entry["madNsPerPacket"] = result.madNsPerPacket;
+    entry["normalized"] = result.normalized;
+    entry["mbPerSec"] = result.mbPerSec;
+    entry["allocsPerPacket"] = result.allocsPerPacket;
+    if (withCounters) {
+        entry["counters"] = result.counts.toJson(workload.totalBytes, workload.payloads.size());
+    }
+    return entry;
+}
+
+#ifndef PKTINSPECT_BUILD_TYPE
+#define PKTINSPECT_BUILD_TYPE ""
+#endif
+#ifndef PKTINSPECT_CXX_FLAGS
+#define PKTINSPECT_CXX_FLAGS ""
+#endif
+#ifndef PKTINSPECT_COMPILER
+#define PKTINSPECT_COMPILER ""
+#endif
+
+/**
+ * Build this binary was compiled with, as recorded in the baseline
+ */
+json buildInfo() {
+    return json{{"type", PKTINSPECT_BUILD_TYPE},
+                {"compiler", PKTINSPECT_COMPILER},
+                {"flags", PKTINSPECT_CXX_FLAGS}};
+}
+
+/**
+ * Check that this build may be compared with (or recorded as) the baseline
+ * Timings from a Debug build or a different compiler say nothing about a
+ * Release baseline, so the gate refuses instead of reporting regressions
+ * @param baseline Parsed baseline, or null when recording a fresh one
+ * @return true when the builds match
+ */
+bool checkBuild(const json& baseline) {
+    json current = buildInfo();
+    if (current["type"] != "Release") {
+        fprintf(stderr, "Error: perf gate needs a Release build (this is '%s'); "
+                        "reconfigure with -DCMAKE_BUILD_TYPE=Release\n",
+                current["type"].get<std::string>().c_str());
+        return false;
+    }
+    if (baseline.is_null()) {
+        return true;
+    }
+    if (!baseline.contains("build")) {
+        fprintf(stderr, "Error: baseline does not record its build; re-record it with perf-baseline\n");
+        return false;
+    }
+    const json& recorded = baseline["build"];
+    for (const char* key : {"type", "compiler", "flags"}) {
+        if (recorded.value(key, std::string()) != current[key].get<std::string>()) {
+            fprintf(stderr, "Error: baseline was recorded with %s '%s', this build has '%s'\n", key,
+                    recorded.value(key, std::string()).c_str(), current[key].get<std::string>().c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Compare a run with the baseline and print a diff table
+ * A case regresses when its normalized time grows by more than the relative
+ * tolerance AND by more than noiseFactor times the combined sample spread,
+ * or when it allocates more per packet than the baseline allowed. Cases
+ * faster than the calibration loop use the wider shortCaseTolerance, and a
+ * case that looks slower is rerun up to `retries` times, keeping its best run
+ * @param rerun Runs one case again by name
+ * @return Number of regressions
+ */
+int compareWithBaseline(const json& baseline, std::vector<BenchResult>& results,
+                        const std::function<BenchResult(const std::string&)>& rerun) {
+    const json& thresholds = baseline["thresholds"];
+    double timeTolerance = thresholds.value("timeTolerance", 0.25);
+    double shortCaseTolerance = thresholds.value("shortCaseTolerance", 0.5);
+    double noiseFactor = thresholds.value("noiseFactor", 3.0);
+    double allocTolerance = thresholds.value("allocTolerance", 0.0);
+    int retries = thresholds.value("retries", 2);
+
+    int regressions = 0;
+    printf("\n%-16s %12s %12s %9s %12s %12s  %s\n",
+           "case", "base norm", "now norm", "change", "base alloc", "now alloc", "verdict");
+
+    for (const auto& expected : baseline["results"]) {
+        std::string name = expected["name"];
+        auto it = std::find_if(results.begin(), results.end(),
+                               [&](const BenchResult& r) { return r.name == name; });
+        if (it == results.end()) {
+            printf("%-16s %12s %12s %9s %12s %12s  MISSING\n", name.c_str(), "-", "-", "-", "-", "-");
+            regressions++;
+            continue;
+        }
+
+        double baseNorm = expected["normalized"];
+        double baseNs = expected["nsPerPacket"];
+        double baseMad = expected.value("madNsPerPacket", 0.0);
+        double baseAllocs = expected["allocsPerPacket"];
+        double tolerance = baseNorm < 1.0 ? std::max(timeTolerance, shortCaseTolerance) : timeTolerance;
+
+        auto isSlower = [&](const BenchResult& now) {
+            // Spread expressed in normalized units of each run
+            double noise = noiseFactor * (baseNs > 0 ? baseMad / baseNs * baseNorm : 0.0) +
+                           noiseFactor * (now.nsPerPacket > 0 ? now.madNsPerPacket / now.nsPerPacket * now.normalized : 0.0);
+            double change = baseNorm > 0 ? (now.normalized - baseNorm) / baseNorm : 0.0;
+            return change > tolerance && (now.normalized - baseNorm) > noise;
+        };
+
+        int reruns = 0;
+        bool slower = isSlower(*it);
+        while (slower && reruns < retries) {
+            BenchResult again = rerun(name);
+            reruns++;
+            if (again.normalized < it->normalized) {
+                *it = again;
+            }
+            slower = isSlower(*it);
+        }
+
+        double change = baseNorm > 0 ? (it->normalized - baseNorm) / baseNorm : 0.0;
+        bool moreAllocs = it->allocsPerPacket > baseAllocs * (1.0 + allocTolerance) + 0.005;
+        const char* verdict = slower && moreAllocs ? "REGRESSED (time, allocations)"
+                            : slower ? "REGRESSED (time)"
+                            : moreAllocs ? "REGRESSED (allocations)"
+                            : change < -tolerance ? "improved" : "ok";
+        if (slower || moreAllocs) {
+            regressions++;
+        }
+
+        printf("%-16s %12.3f %12.3f %+8.1f%% %12.2f %12.2f  %s", name.c_str(), baseNorm, it->normalized,
+               change * 100.0, baseAllocs, it->allocsPerPacket, verdict);
+        if (reruns > 0) {
+            printf(" (%d rerun%s)", reruns, reruns == 1 ? "" : "s");
+        }
+        printf("\n");
+    }
+
+    return regressions;
+}
+
+/**
+ * Best-of-N throughput of one engine over in-memory payloads
+ * @return MB/s
+ */
+double measureMbPerSec(const Matcher& matcher, const std::vector<std::string>& payloads,
+                       uint64_t totalBytes, int iterations) {
+    std::vector<PatternHit> hits;
+    double best = 0.0;
+    for (int iter = 0; iter <= iterations; ++iter) {  // First pass warms up
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& payload : payloads) {
+            hits.clear();
+            matcher.scan(reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), hits);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        g_sink = g_sink + hits.size();
+        if (iter > 0 && seconds > 0) {
+            best = std::max(best, static_cast<double>(totalBytes) / (1024.0 * 1024.0) / seconds);
+        }
+    }
+    return best;
+}
+
+/**
+ * Pattern length sweep: random literal sets of a fixed length, injected into
+ * generated traffic, scanned by the hashing engines and both Aho-Corasick
+ * engines (rabin-karp only from its window length up)
+ * @return Process exit code
+ */
+int runCrossover(const Options& opts) {
+    const std::vector<size_t> lengths = {4, 6, 8, 12, 16, 24, 32, 48, 64, 96, 128};
+    const std::vector<std::string> engines = {"wu-manber", "rabin-karp", "ac-table", "ac-compressed", "ac-trie"};
+    const std::string alphabet = "abcdefghijklmnopqrstuvwxyz0123456789/._-";
+
+    printf("Crossover: %zu patterns per length, %zu packets, %d iterations\n\n",
+           opts.crossoverPatterns, opts.profile.packetCount, opts.iterations);
+    printf("%8s", "length");
+    for (const auto& engine : engines) {
+        printf(" %12s %10s", (engine + " MB/s").c_str(), "KB");
+    }
+    printf("  %s\n", "fastest");
+
+    json report = json::array();
+    size_t crossoverLength = 0;
+    std::mt19937 rng(opts.seed);
+
+    for (size_t length : lengths) {
+        std::vector<std::string> patterns;
+        for (size_t i = 0; i < opts.crossoverPatterns; ++i) {
+            std::string pattern;
+            for (size_t j = 0; j < length; ++j) {
+                pattern += alphabet[rng() % alphabet.size()];
+            }
+            patterns.push_back(pattern);
+        }
+        auto patternSet = std::make_shared<const PatternSet>(patterns);
+
+        TrafficGenerator generator(opts.seed);
+        std::vector<std::string> payloads;
+        uint64_t totalBytes = 0;
+        for (auto& packet : generator.generate(opts.profile, patterns)) {
+            totalBytes += packet.payload.size();
+            payloads.push_back(std::move(packet.payload));
+        }
+
+        // Build first: the trie builder logs to stdout and would split the row
+        std::vector<std::unique_ptr<Matcher>> matchers;
+        for (const auto& name : engines) {
+            matchers.push_back(MatcherSelector::create(name, patternSet));
+        }
+
+        json row;
+        row["length"] = length;
+        printf("%8zu", length);
+        std::string fastest;
+        double fastestMbPerSec = 0.0;
+        double acBest = 0.0;
+        double wuManber = 0.0;
+
+        for (size_t e = 0; e < engines.size(); ++e) {
+            const std::string& name = engines[e];
+            const Matcher* matcher = matchers[e].get();
+            if (!matcher) {
+                printf(" %12s %10s", "-", "-");
+                continue;
+            }
+            double mbPerSec = measureMbPerSec(*matcher, payloads, totalBytes, opts.iterations);
+            printf(" %12.1f %10zu", mbPerSec, matcher->memoryUsage() / 1024);
+            row[name]["mbPerSec"] = mbPerSec;
+            row[name]["memoryBytes"] = matcher->memoryUsage();
+
+            if (mbPerSec > fastestMbPerSec) {
+                fastestMbPerSec = mbPerSec;
+                fastest = name;
+            }
+            if (name == "wu-manber") {
+                wuManber = mbPerSec;
+            } else if (name != "rabin-karp") {
+                acBest = std::max(acBest, mbPerSec);
+            }
+        }
+        printf("  %s\n", fastest.c_str());
+        row["fastest"] = fastest;
+        report.push_back(row);
+
+        if (crossoverLength == 0 && wuManber > acBest) {
+            crossoverLength = length;
+        }
+    }
+
+    if (crossoverLength) {
+        printf("\nwu-manber overtakes Aho-Corasick at pattern length %zu\n", crossoverLength);
+    } else {
+        printf("\nwu-manber did not overtake Aho-Corasick in this sweep\n");
+    }
+
+    if (!opts.jsonOutput.empty()) {
+        json out;
+        out["patterns"] = opts.crossoverPatterns;
+        out["crossoverLength"] = crossoverLength;
+        out["results"] = report;
+        std::ofstream file(opts.jsonOutput);
+        file << out.dump(2) << std::endl;
+    }
+    return 0;
+}
+
+/**
+ * Page backing comparison: one large ac-table image placed on each backing,
+ * scanned over the same traffic
+ * @return Process exit code
+ */
+int runTlbComparison(const Options& opts) {
+    const std::string alphabet = "abcdefghijklmnopqrstuvwxyz0123456789/._-";
+    std::mt19937 rng(opts.seed);
+    std::vector<std::string> patterns;
+    for (size_t i = 0; i < opts.tlbPatterns; ++i) {
+        std::string pattern;
+        for (size_t j = 8 + rng() % 25; j > 0; --j) {
+            pattern += alphabet[rng() % alphabet.size()];
+        }
+        patterns.push_back(pattern);
+    }
+    auto patternSet = std::make_shared<const PatternSet>(patterns);
+
+    TrafficGenerator generator(opts.seed);
+    std::vector<std::string> payloads;
+    uint64_t totalBytes = 0;
+    for (auto& packet : generator.generate(opts.profile, patterns)) {
+        totalBytes += packet.payload.size();
+        payloads.push_back(std::move(packet.payload));
+    }
+
+    PerfCounters counters;
+    if (opts.counters && !counters.open()) {
+        fprintf(stderr, "Warning: perf_event_open failed, running without counters\n");
+    }
+
+    printf("TLB: %zu patterns, %zu packets, %d iterations\n\n", opts.tlbPatterns, payloads.size(), opts.iterations);
+    printf("%-10s %-10s %12s %12s %12s %12s %14s\n", "requested", "obtained", "table MB", "huge MB",
+           "build ms", "MB/s", "dTLBmiss/KB");
+
+    json report = json::array();
+    for (PageBacking backing : {PageBacking::Small, PageBacking::Transparent, PageBacking::Explicit}) {
+        auto start = std::chrono::steady_clock::now();
+        AcTableMatcher matcher(patternSet, backing);
+        double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        double mbPerSec = measureMbPerSec(matcher, payloads, totalBytes, opts.iterations);
+
+        PerfCounts counts;
+        if (counters.isOpen()) {
+            std::vector<PatternHit> hits;
+            PerfScope scope(counters, counts);
+            for (const auto& payload : payloads) {
+                hits.clear();
+                matcher.scan(reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), hits);
+            }
+        }
+
+        const double tableMb = static_cast<double>(matcher.memoryUsage()) / (1024.0 * 1024.0);
+        const double hugeMb = static_cast<double>(matcher.hugePageBytes()) / (1024.0 * 1024.0);
+        printf("%-10s %-10s %12.1f %12.1f %12.1f %12.1f", HugePageBuffer::backingName(backing),
+               HugePageBuffer::backingName(matcher.pageBacking()), tableMb, hugeMb, buildMs, mbPerSec);
+        if (counts.has(PerfEvent::DTLBMisses)) {
+            printf(" %14.3f\n", static_cast<double>(counts.get(PerfEvent::DTLBMisses)) * 1024.0 / totalBytes);
+        } else {
+            printf(" %14s\n", "n/a");
+        }
+
+        json row;
+        row["requested"] = HugePageBuffer::backingName(backing);
+        row["obtained"] = HugePageBuffer::backingName(matcher.pageBacking());
+        row["tableBytes"] = matcher.memoryUsage();
+        row["hugePageBytes"] = matcher.hugePageBytes();
+        row["buildMs"] = buildMs;
+        row["mbPerSec"] = mbPerSec;
+        if (counters.isOpen()) {
+            row["counters"] = counts.toJson(totalBytes, payloads.size());
+        }
+        report.push_back(row);
+    }
+
+    if (!opts.jsonOutput.empty()) {
+        std::ofstream file(opts.jsonOutput);
+        file << report.dump(2) << std::endl;
+    }
+    return 0;
+}
+
+/**
+ * Worker scaling: the reference capture through PacketPipeline with 1, 2, 4...
+ * ac-table workers under each dispatch policy (work stealing, flow hash, batch).
+ * Pinning and NUMA placement come from the PKTINSPECT_PIPELINE_* environment.
+ * @return Process exit code
+ */
+int runScaling(const Options& opts) {
+    Workload workload;
+    if (!buildWorkload(opts, workload)) {
+        return 1;
+    }
+    auto matcher = std::shared_ptr<const Matcher>(
+        MatcherSelector::create("ac-table", std::make_shared<const PatternSet>(workload.patterns)));
+    const double megabytes = static_cast<double>(workload.totalBytes) / (1024.0 * 1024.0);
+
+    struct Sample {
+        double mbPerSec = 0.0;
+        double imbalance = 0.0;    // Busiest worker's packets over the mean (1.0 = perfectly even)
+        double utilization = 0.0;  // Mean share of the run the workers spent matching
+        uint64_t steals = 0;
+    };
+
+    // Best throughput of the iterations; the other columns come from the last run
+    auto measure = [&](unsigned workers, PipelineConfig::Dispatch dispatch) {
+        Sample sample;
+        for (int iter = 0; iter <= opts.iterations; ++iter) {  // First pass warms up
+            PipelineConfig config = PipelineConfig::fromEnvironment();
+            config.workers = workers;
+            config.dispatch = dispatch;
+            PacketPipeline pipeline(matcher, config);
+            uint64_t hits = 0;
+            auto start = std::chrono::steady_clock::now();
+            pipeline.run(workload.capturePath, [&](const PipelinePacket& packet) { hits += packet.hits.size(); });
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            g_sink = g_sink + hits;
+            if (iter > 0 && seconds > 0) {
+                sample.mbPerSec = std::max(sample.mbPerSec, megabytes / seconds);
+            }
+
+            uint64_t most = 0, total = 0;
+            double utilization = 0.0;
+            sample.steals = 0;
+            json stats = pipeline.statsJson();
+            for (const auto& stage : stats["stages"]) {
+                if (stage["name"].get<std::string>().rfind("worker-", 0) == 0) {
+                    uint64_t processed = stage["processed"].get<uint64_t>();
+                    most = std::max(most, processed);
+                    total += processed;
+                    utilization += stage["utilization"].get<double>();
+                    sample.steals += stage["steals"].get<uint64_t>();
+                }
+            }
+            sample.imbalance = total ? static_cast<double>(most) * workers / total : 0.0;
+            sample.utilization = utilization / workers;
+        }
+        return sample;
+    };
+
+    const std::vector<PipelineConfig::Dispatch> policies = {
+        PipelineConfig::Dispatch::Steal, PipelineConfig::Dispatch::Flow, PipelineConfig::Dispatch::Batch};
+
+    printf("Scaling: %zu packets, %u flows, %.2f MB, %u hardware threads, %d iterations\n\n",
+           workload.payloads.size(), opts.profile.flowCount, megabytes,
+           std::thread::hardware_concurrency(), opts.iterations);
+    printf("%8s", "workers");
+    for (auto policy : policies) {
+        std::string name = PipelineConfig::dispatchName(policy);
+        printf(" %11s %7s %9s %6s", (name + " MB/s").c_str(), "speedup", "imbalance", "util");
+    }
+    printf(" %10s\n", "steals");
+
+    json report = json::array();
+    std::vector<double> base(policies.size(), 0.0);
+    for (unsigned workers = 1; workers <= opts.scalingWorkers; workers *= 2) {
+        json row;
+        row["workers"] = workers;
+        printf("%8u", workers);
+        uint64_t steals = 0;
+        for (size_t p = 0; p < policies.size(); ++p) {
+            Sample sample = measure(workers, policies[p]);
+            if (workers == 1) {
+                base[p] = sample.mbPerSec;
+            }
+            double speedup = base[p] > 0 ? sample.mbPerSec / base[p] : 0.0;
+            printf(" %11.1f %7.2f %9.2f %6.2f", sample.mbPerSec, speedup, sample.imbalance, sample.utilization);
+            row[PipelineConfig::dispatchName(policies[p])] = {
+                {"mbPerSec", sample.mbPerSec}, {"speedup", speedup}, {"imbalance", sample.imbalance},
+                {"utilization", sample.utilization}, {"steals", sample.steals}};
+            if (policies[p] == PipelineConfig::Dispatch::Steal) {
+                steals = sample.steals;
+            }
+        }
+        printf(" %10llu\n", static_cast<unsigned long long>(steals));
+        report.push_back(row);
+    }
+
+    if (!opts.jsonOutput.empty()) {
+        std::ofstream file(opts.jsonOutput);
+        file << report.dump(2) << std::endl;
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+    if (opts.crossover) {
+        return runCrossover(opts);
+    }
+    if (opts.tlb) {
+        return runTlbComparison(opts);
+    }
+    if (opts.scaling) {
+        return runScaling(opts);
+    }
+
+    // The baseline pins the workload so runs stay comparable
+    json baseline;
+    if (!opts.checkBaseline.empty()) {
+        std::ifstream in(opts.checkBaseline);
+        if (in.is_open()) {
+            in >> baseline;
+            const json& config = baseline["config"];
+            opts.profile.packetCount = config.value("packets", opts.profile.packetCount);
+            opts.profile.minPayload = config.value("minSize", opts.profile.minPayload);
+            opts.profile.maxPayload = config.value("maxSize", opts.profile.maxPayload);
+            opts.profile.attackRate = config.value("attackRate", opts.profile.attackRate);
+            opts.seed = config.value("seed", opts.seed);
+            opts.iterations = config.value("iterations", opts.iterations);
+        } else if (!opts.updateBaseline) {
+            fprintf(stderr, "Error: Could not open baseline: %s\n", opts.checkBaseline.c_str());
+            return 2;
+        }
+        if (!checkBuild(opts.updateBaseline ? json() : baseline)) {
+            return 2;
+        }
+    }
+
+    Workload workload;
+    if (!buildWorkload(opts, workload)) {
+        return 1;
+    }
+    const auto& patterns = workload.patterns;
+    const auto& payloads = workload.payloads;
+
+    AhoCorasick automaton;
+    automaton.buildFromPatterns(patterns);
+    DFABuilder dfa;
+    dfa.buildFromPatterns(patterns);
+
+    std::vector<PatternHit> hits;
+    uint64_t checksum = 0;
+    std::vector<BenchCase> cases = {
+        // Fixed scalar loop used to normalize times across machines
+        {"calibration", [&](const std::string& payload) {
+            uint32_t hash = 2166136261u;
+            for (unsigned char c : payload) {
+                hash = (hash ^ c) * 16777619u;
+            }
+            checksum += hash;
+        }, nullptr},
+        {"ac.scan", [&](const std::string& payload) {
+            automaton.scan(payload, 0);
+        }, nullptr},
+        {"ac.scanHits", [&](const std::string& payload) {
+            hits.clear();
+            automaton.scanHits(reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), hits);
+        }, nullptr},
+        {"dfa.match", [&](const std::string& payload) {
+            dfa.match(payload);
+        }, nullptr},
+    };
+
+    // One case per Matcher engine that accepts the pattern set
+    auto patternSet = std::make_shared<const PatternSet>(patterns);
+    std::vector<std::unique_ptr<Matcher>> matchers;
+    for (const EngineInfo& info : MatcherSelector::engines()) {
+        if (!info.supports(*patternSet)) continue;
+        const Matcher* matcher = matchers.emplace_back(info.create(patternSet)).get();
+        cases.push_back({std::string("engine.") + info.name, [&hits, matcher](const std::string& payload) {
+            hits.clear();
+            matcher->scan(reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), hits);
+        }, nullptr});
+    }
+
+    // Same scan as engine.ac-table plus per-pattern hit counting, to keep the counters' cost visible
+    PatternStats patternStats(patterns);
+    const Matcher* statsMatcher = matchers.emplace_back(MatcherSelector::create("ac-table", patternSet)).get();
+    // engine.ac-table over the same payloads cut into four spans, state carried across them
+    std::vector<ByteSpan> spans;
+    cases.push_back({"spans.ac-table", [&hits, &spans, statsMatcher](const std::string& payload) {
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(payload.data());
+        size_t quarter = payload.size() / 4;
+        spans = {{data, quarter}, {data + quarter, quarter}, {data + 2 * quarter, quarter},
+                 {data + 3 * quarter, payload.size() - 3 * quarter}};
+        hits.clear();
+        statsMatcher->scanSpans(spans.data(), spans.size(), hits);
+    }, nullptr});
+    cases.push_back({"stats.record", [&hits, &patternStats, statsMatcher](const std::string& payload) {
+        hits.clear();
+        statsMatcher->scan(reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), hits);
+        patternStats.record(hits, payload.size());
+    }, nullptr});
+    // The /scan-pcap result path: engine.ac-table, then the ScanArena record and its JSON text
+    ScanArena arena;
+    std::string resultJson;
+    cases.push_back({"results.arena", [&hits, &arena, &resultJson, patternSet, statsMatcher](const std::string& payload) {
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(payload.data());
+        hits.clear();
+        statsMatcher->scan(data, payload.size(), hits);
+        if (arena.size() % 1024 == 0) {
+            arena.reset(patternSet);
+            resultJson.clear();
+        }
+        arena.add(arena.size(), 0, data, static_cast<uint32_t>(payload.size()), hits.data(), hits.size());
+        arena.appendJson(resultJson, arena.packetAt(arena.size() - 1));
+    }, nullptr});
+
+    // engine.ac-table through scanBatch(), 256 packets per call
+    std::vector<ByteSpan> batchPackets;
+    for (const std::string& payload : payloads) {
+        batchPackets.push_back({reinterpret_cast<const uint8_t*>(payload.data()), payload.size()});
+    }
+    BatchHits batchHits;
+    cases.push_back({"batch.ac-table", nullptr, [&batchPackets, &batchHits, &checksum, statsMatcher]() {
+        for (size_t first = 0; first < batchPackets.size(); first += 256) {
+            batchHits.clear();
+            statsMatcher->scanBatch(batchPackets.data() + first, std::min<size_t>(256, batchPackets.size() - first),
+                                    batchHits);
+            checksum += batchHits.size();
+        }
+    }});
+
+    // Each payload as an HTTP stream of its own, fields normalized and matched as they are parsed
+    auto httpScanner = std::make_shared<HttpScanner>(std::make_shared<const AcTableMatcher>(patternSet));
+    cases.push_back({"http.normalize", [httpScanner, &checksum](const std::string& payload) {
+        httpScanner->reset();
+        httpScanner->clearHits();
+        httpScanner->feed(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+        httpScanner->finish();
+        checksum += httpScanner->getHits().size();
+    }, nullptr});
+
+    // The patterns dealt round-robin to the URI, header values and body, each field scanned for its share only
+    std::vector<FieldTarget> targets(workload.patterns.size());
+    const char* targetNames[] = {"uri", "header", "body"};
+    for (size_t i = 0; i < targets.size(); ++i) {
+        FieldTarget::parse(targetNames[i % 3], targets[i]);
+    }
+    auto fieldMatcher = std::make_shared<const FieldScopedMatcher>(patternSet, targets);
+    cases.push_back({"fields.scoped", [fieldMatcher, &checksum](const std::string& payload) {
+        thread_local std::vector<FieldHit> fieldHits;
+        fieldHits.clear();
+        fieldMatcher->scan(reinterpret_cast<const uint8_t*>(payload.data()), payload.size(), fieldHits);
+        checksum += fieldHits.size();
+    }, nullptr});
+
+    cases.insert(cases.end(), {
+        {"reader.hex", [&](const std::string& payload) {
+            PacketReader::bytesToHex(std::vector<uint8_t>(payload.begin(), payload.end()));
+        }, nullptr},
+        {"reader.readPcap", nullptr, [&]() {
+            PacketReader reader;
+            checksum += reader.readPcapFile(workload.capturePath).size();
+        }},
+        {"reader.forEach", nullptr, [&]() {
+            PacketReader reader;
+            reader.forEachPayload(workload.capturePath, [&](const PacketView& packet) {
+                checksum += packet.payloadLength;
+            });
+        }},
+        {"pipeline.ac-table", nullptr, [&, tableMatcher = std::shared_ptr<const Matcher>(
+                                              MatcherSelector::create("ac-table", patternSet))]() {
+            // Reader, decoder, one ac-table worker and sink on their own threads
+            PipelineConfig config;
+            config.workers = 1;  // Pinned: the default follows the machine's thread count
+            PacketPipeline pipeline(tableMatcher, config);
+            pipeline.run(workload.capturePath, [&](const PipelinePacket& packet) {
+                checksum += packet.hits.size();
+            });
+        }},
+        {"async.ac-table", nullptr, [&, tableMatcher = std::shared_ptr<const Matcher>(
+                                           MatcherSelector::create("ac-table", patternSet)),
+                                       executor = std::make_shared<Executor>(1)]() {
+            // Capture generator on this thread, batches of 256 packets hopping to one executor thread
+            AsyncScanSummary summary = syncWait(scanCaptureAsync(*executor, *tableMatcher, workload.capturePath));
+            checksum += summary.hits;
+        }},
+    });
+
+    PerfCounters counters;
+    if (opts.counters && !counters.open()) {
+        fprintf(stderr, "Warning: perf_event_open failed (check /proc/sys/kernel/perf_event_paranoid), "
+                        "running without counters\n");
+    }
+
+    printf("Workload: %zu packets, %.2f MB, %zu patterns, %d iterations\n\n",
+           payloads.size(), static_cast<double>(workload.totalBytes) / (1024.0 * 1024.0),
+           patterns.size(), opts.iterations);
+    printf("%-16s %12s %8s %12s %10s %10s", "engine", "ns/packet", "+/-", "MB/s", "normalized", "allocs/pkt");
+    if (counters.isOpen()) {
+        printf(" %9s %9s %6s %11s %11s %11s %11s", "cyc/B", "ins/B", "IPC", "L1miss/pkt", "LLCmiss/pkt",
+               "brmiss/pkt", "dTLBmiss/pkt");
+    }
+    printf("\n");
+
+    json report;
+    report["config"]["packets"] = opts.profile.packetCount;
+    report["config"]["minSize"] = opts.profile.minPayload;
+    report["config"]["maxSize"] = opts.profile.maxPayload;
+    report["config"]["attackRate"] = opts.profile.attackRate;
+    report["config"]["seed"] = opts.seed;
+    report["config"]["iterations"] = opts.iterations;
+    report["build"] = buildInfo();
+    report["bytes"] = workload.totalBytes;
+    report["patterns"] = patterns.size();
+    report["results"] = json::array();
+
+    std::vector<BenchResult> results;
+    double calibrationNs = 0.0;
+
+    for (const auto& bench : cases) {
+        bool isCalibration = bench.name == "calibration";
+        if (!isCalibration && !opts.engines.empty() &&
+            std::find(opts.engines.begin(), opts.engines.end(), bench.name) == opts.engines.end()) {
+            continue;
+        }
+
+        BenchResult result = runCase(bench, workload, opts.iterations,
+                                     counters.isOpen() ? &counters : nullptr);
+        if (isCalibration) {
+            calibrationNs = result.nsPerPacket;
+        }
+        result.normalized = calibrationNs > 0 ? result.nsPerPacket / calibrationNs : 0.0;
+
+        printf("%-16s %12.1f %8.1f %12.1f %10.3f %10.2f", result.name.c_str(), result.nsPerPacket,
+               result.madNsPerPacket, result.mbPerSec, result.normalized, result.allocsPerPacket);
+        if (counters.isOpen()) {
+            const PerfCounts& c = result.counts;
+            double bytes = static_cast<double>(workload.totalBytes);
+            double packets = static_cast<double>(payloads.size());
+            auto ratio = [](uint64_t value, double per) { return static_cast<double>(value) / per; };
+            printf(" %9.2f %9.2f %6.2f %11.2f %11.2f %11.2f %11.2f",
+                   ratio(c.get(PerfEvent::Cycles), bytes), ratio(c.get(PerfEvent::Instructions), bytes),
+                   c.get(PerfEvent::Cycles) ? ratio(c.get(PerfEvent::Instructions), static_cast<double>(c.get(PerfEvent::Cycles))) : 0.0,
+                   ratio(c.get(PerfEvent::L1DMisses), packets), ratio(c.get(PerfEvent::LLCMisses), packets),
+                   ratio(c.get(PerfEvent::BranchMisses), packets), ratio(c.get(PerfEvent::DTLBMisses), packets));
+        }
+        printf("\n");
+
+        report["results"].push_back(resultToJson(result, workload, counters.isOpen()));
+        results.push_back(result);
+    }
+
+    if (!opts.jsonOutput.empty()) {
+        std::ofstream out(opts.jsonOutput);
+        out << report.dump(2) << "\n";
+    }
+
+    g_sink = checksum;
+    if (opts.checkBaseline.empty()) {
+        return 0;
+    }
+
+    if (opts.updateBaseline) {
+        json updated = report;
+        updated["thresholds"] = baseline.contains("thresholds")
+            ? baseline["thresholds"]
+            : json{{"timeTolerance", 0.25}, {"shortCaseTolerance", 0.5}, {"noiseFactor", 3.0},
+                   {"allocTolerance", 0.0}, {"retries", 2}};
+        for (auto& entry : updated["results"]) {
+            entry.erase("seconds");
+            entry.erase("counters");
+        }
+        std::ofstream out(opts.checkBaseline);
+        out << updated.dump(2) << "\n";
+        printf("\nBaseline written to %s\n", opts.checkBaseline.c_str());
+        return 0;
+    }
+
+    // A rerun recalibrates first, so a burst of load elsewhere is normalized away
+    auto rerun = [&](const std::string& name) {
+        auto find = [&](const std::string& caseName) {
+            return std::find_if(cases.begin(), cases.end(),
+                                [&](const BenchCase& c) { return c.name == caseName; });
+        };
+        double nowCalibrationNs = runCase(*find("calibration"), workload, opts.iterations, nullptr).nsPerPacket;
+        BenchResult result = runCase(*find(name), workload, opts.iterations, nullptr);
+        result.normalized = nowCalibrationNs > 0 ? result.nsPerPacket / nowCalibrationNs : 0.0;
+        return result;
+    };
+    int regressions = compareWithBaseline(baseline, results, rerun);
+    if (regressions > 0) {
+        printf("\nperf-check FAILED: %d case(s) regressed against %s\n", regressions, opts.checkBaseline.c_str());
+        return 1;
+    }
+    printf("\nperf-check passed\n");
+    return 0;
+}
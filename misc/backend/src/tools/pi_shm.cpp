@@ -0,0 +1,144 @@
+/**
+ * pi_shm: loader for the shared-memory automaton
+ *
+ * Builds the ac-table automaton from patterns.json and publishes it under a
+ * name that server processes attach to (PKTINSPECT_SHM_NAME). With --watch,
+ * stays running and publishes a new generation whenever the patterns file
+ * changes; attached servers switch on their next request.
+ *
+ *   pi_shm publish --name NAME [--patterns FILE] [--watch SECONDS]
+ *   pi_shm info    --name NAME
+ *   pi_shm remove  --name NAME
+ */
+
+#include <cstdio>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <filesystem>
+
+#include "packet_inspection/shm/shared_automaton.hpp"
+#include "packet_inspection/utils/patterns_loader.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct Options {
+    std::string command;
+    std::string name;
+    std::string patternsFile = "backend/pcap/patterns.json";
+    int watchSeconds = 0;
+};
+
+void printUsage(const char* argv0) {
+    fprintf(stderr,
+        "Usage: %s publish|info|remove --name NAME [options]\n"
+        "  --name NAME           shared automaton name\n"
+        "  --patterns FILE       patterns.json to compile (publish, default backend/pcap/patterns.json)\n"
+        "  --watch SECONDS       keep running, republish when the file changes\n",
+        argv0);
+}
+
+bool parseArgs(int argc, char** argv, Options& opts) {
+    if (argc < 2) return false;
+    opts.command = argv[1];
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        try {
+            if (arg == "--name" && hasValue) {
+                opts.name = argv[++i];
+            } else if (arg == "--patterns" && hasValue) {
+                opts.patternsFile = argv[++i];
+            } else if (arg == "--watch" && hasValue) {
+                opts.watchSeconds = std::max(1, std::stoi(argv[++i]));
+            } else {
+                return false;
+            }
+        } catch (const std::exception&) {
+            fprintf(stderr, "Error: invalid value for %s: %s\n", arg.c_str(), argv[i]);
+            return false;
+        }
+    }
+    return !opts.name.empty() &&
+           (opts.command == "publish" || opts.command == "info" || opts.command == "remove");
+}
+
+uint64_t publishOnce(const Options& opts) {
+    std::vector<std::string> patterns =
+        PatternsLoader::flattenPatterns(PatternsLoader::loadPatterns(opts.patternsFile));
+    if (patterns.empty()) {
+        fprintf(stderr, "Error: No patterns loaded from %s\n", opts.patternsFile.c_str());
+        return 0;
+    }
+
+    AcTableMatcher matcher(std::make_shared<const PatternSet>(patterns));
+    uint64_t generation = SharedAutomaton::publish(opts.name, matcher);
+    if (generation) {
+        printf("Published %s generation %llu: %zu patterns, %u states, %zu bytes\n", opts.name.c_str(),
+               static_cast<unsigned long long>(generation), patterns.size(), matcher.getStateCount(),
+               matcher.memoryUsage());
+        fflush(stdout);
+    }
+    return generation;
+}
+
+int runPublish(const Options& opts) {
+    if (!publishOnce(opts)) {
+        return 1;
+    }
+    if (opts.watchSeconds == 0) {
+        return 0;
+    }
+
+    std::error_code ec;
+    auto lastWrite = fs::last_write_time(opts.patternsFile, ec);
+    while (true) {
+        std::this_thread::sleep_for(std::chrono::seconds(opts.watchSeconds));
+        auto now = fs::last_write_time(opts.patternsFile, ec);
+        if (ec || now == lastWrite) {
+            continue;
+        }
+        lastWrite = now;
+        publishOnce(opts);  // On failure the previous generation stays current
+    }
+}
+
+int runInfo(const Options& opts) {
+    uint64_t generation = 0;
+    auto matcher = SharedAutomaton::attach(opts.name, &generation);
+    if (!matcher) {
+        fprintf(stderr, "Error: Nothing valid published as %s\n", opts.name.c_str());
+        return 1;
+    }
+    printf("%s: generation %llu, %zu patterns, %u states, stride %u, %zu bytes\n", opts.name.c_str(),
+           static_cast<unsigned long long>(generation), matcher->patternSet().size(), matcher->getStateCount(),
+           matcher->getStride(), matcher->memoryUsage());
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    if (opts.command == "publish") {
+        return runPublish(opts);
+    }
+    if (opts.command == "info") {
+        return runInfo(opts);
+    }
+    if (!SharedAutomaton::remove(opts.name)) {
+        fprintf(stderr, "Error: Nothing published as %s\n", opts.name.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,817 @@
+/**
+ * pktscan: headless batch scanner for PCAP captures
+ *
+ * Scans every capture in the given files/directories with all cores and
+ * streams matches as NDJSON (one line per packet) or a compact binary format.
+ * No HTTP server and no JSON request parsing on this path; payloads are
+ * scanned straight from the file buffer.
+ *
+ * Work is spread by a work-stealing TaskScheduler: one task per capture,
+ * which loads the file and splits its packets into chunks of about
+ * --chunk-bytes of payload. Idle threads steal chunks, so one large capture
+ * or a run of jumbo payloads no longer keeps a single thread busy while the
+ * others wait.
+ *
+ * Patterns in a patterns.json may name a field ({"pattern": ..., "field":
+ * "uri"}). Those are not scanned over the whole payload: each packet is
+ * parsed as HTTP and each field is scanned only for the patterns aimed at
+ * it (FieldScopedMatcher). Their matches carry a "field" in NDJSON.
+ *
+ * With --http every payload is also parsed as HTTP and its fields are
+ * matched after normalization (percent-decoding, gzip/deflate inflation,
+ * base64; see HttpNormalizer). Each packet is a stream of its own (there is
+ * no TCP reassembly), so this covers messages that fit in one payload.
+ *
+ * Binary format (little-endian):
+ *   "PKTSCAN1"
+ *   u32 patternCount, then per pattern: u16 length, bytes
+ *   records:
+ *     u8 1 (file),  u32 fileIndex, u16 pathLength, path bytes
+ *     u8 2 (match), u32 fileIndex, u32 packetId, u32 patternId, u32 position
+ *     u8 3 (normalized match, --http), u32 fileIndex, u32 packetId, u32 patternId,
+ *          u32 position, u8 field (HttpField), u32 message
+ *     u8 4 (field-scoped match), u32 fileIndex, u32 packetId, u32 patternId,
+ *          u32 position, u8 field (HttpField)
+ *   A file record is written once its capture has loaded; captures that fail
+ *   to load get none. Patterns or paths over 65535 bytes are rejected.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <unistd.h>
+
+#include "packet_inspection/pcap/packet_reader.hpp"
+#include "packet_inspection/ac/aho_corasick.hpp"
+#include "packet_inspection/utils/patterns_loader.hpp"
+#include "packet_inspection/trace/tracer.hpp"
+#include "packet_inspection/stats/pattern_stats.hpp"
+#include "packet_inspection/sched/task_scheduler.hpp"
+#include "packet_inspection/sched/cancel_token.hpp"
+#include "packet_inspection/http/http_scanner.hpp"
+#include "packet_inspection/http/field_scoped_matcher.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+enum class OutputFormat { NDJSON, Binary };
+
+struct Options {
+    std::vector<std::string> inputs;
+    std::vector<std::string> patternJsonFiles;
+    std::vector<std::string> patternTextFiles;
+    std::set<std::string> categories;
+    std::vector<std::string> extensions = {".pcap", ".cap"};
+    OutputFormat format = OutputFormat::NDJSON;
+    std::string outputPath;
+    unsigned threads = 0;
+    uint32_t minLength = 0;
+    uint32_t maxLength = UINT32_MAX;
+    bool allPackets = false;
+    size_t topPatterns = 0;
+    std::string heatmapPath;
+    uint32_t heatmapSample = 16;
+    size_t chunkBytes = 256 * 1024;
+    bool schedStats = false;
+    uint64_t deadlineMs = 0;
+    bool http = false;
+};
+
+void printUsage(const char* argv0) {
+    fprintf(stderr,
+        "Usage: %s [options] <capture file or directory>...\n"
+        "  -p, --patterns FILE       patterns.json (category -> list), repeatable\n"
+        "  -P, --pattern-file FILE   plain text, one pattern per line, repeatable\n"
+        "  -c, --category NAME       only use patterns from this category, repeatable\n"
+        "  -f, --format ndjson|binary  output format (default ndjson)\n"
+        "  -o, --output FILE         write results to FILE (default stdout)\n"
+        "  -j, --threads N           worker threads (default: all cores)\n"
+        "      --ext .EXT            capture extension for directory scans, repeatable\n"
+        "      --min-length N        skip payloads shorter than N bytes\n"
+        "      --max-length N        skip payloads longer than N bytes\n"
+        "      --all-packets         also emit packets without matches (ndjson)\n"
+        "      --http                also match normalized HTTP fields (PKTINSPECT_HTTP_* settings)\n"
+        "      --top N               print the N most frequent patterns to stderr\n"
+        "      --heatmap FILE        write the trie with state-visit and fail-link counters (ac-trie JSON)\n"
+        "      --heatmap-sample N    profile one payload in N per thread (default 16)\n"
+        "      --chunk-bytes N       payload bytes per scheduled task (default 262144)\n"
+        "      --sched-stats         print per-thread utilization and steal counters to stderr\n"
+        "      --deadline-ms N       stop scanning after N ms (output then covers part of the input)\n",
+        argv0);
+}
+
+bool parseArgs(int argc, char** argv, Options& opts) {
+    bool customExt = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: %s requires an argument\n", arg.c_str());
+                return nullptr;
+            }
+            return argv[++i];
+        };
+
+        const char* value = nullptr;
+        try {
+            if (arg == "-h" || arg == "--help") {
+                return false;
+            } else if (arg == "-p" || arg == "--patterns") {
+                if (!(value = next())) return false;
+                opts.patternJsonFiles.push_back(value);
+            } else if (arg == "-P" || arg == "--pattern-file") {
+                if (!(value = next())) return false;
+                opts.patternTextFiles.push_back(value);
+            } else if (arg == "-c" || arg == "--category") {
+                if (!(value = next())) return false;
+                opts.categories.insert(value);
+            } else if (arg == "-f" || arg == "--format") {
+                if (!(value = next())) return false;
+                if (strcmp(value, "ndjson") == 0) {
+                    opts.format = OutputFormat::NDJSON;
+                } else if (strcmp(value, "binary") == 0) {
+                    opts.format = OutputFormat::Binary;
+                } else {
+                    fprintf(stderr, "Error: unknown format: %s\n", value);
+                    return false;
+                }
+            } else if (arg == "-o" || arg == "--output") {
+                if (!(value = next())) return false;
+                opts.outputPath = value;
+            } else if (arg == "-j" || arg == "--threads") {
+                if (!(value = next())) return false;
+                opts.threads = static_cast<unsigned>(std::stoul(value));
+            } else if (arg == "--ext") {
+                if (!(value = next())) return false;
+                if (!customExt) {
+                    opts.extensions.clear();
+                    customExt = true;
+                }
+                opts.extensions.push_back(value);
+            } else if (arg == "--min-length") {
+                if (!(value = next())) return false;
+                opts.minLength = static_cast<uint32_t>(std::stoul(value));
+            } else if (arg == "--max-length") {
+                if (!(value = next())) return false;
+                opts.maxLength = static_cast<uint32_t>(std::stoul(value));
+            } else if (arg == "--all-packets") {
+                opts.allPackets = true;
+            } else if (arg == "--http") {
+                opts.http = true;
+            } else if (arg == "--top") {
+                if (!(value = next())) return false;
+                opts.topPatterns = static_cast<size_t>(std::stoul(value));
+            } else if (arg == "--chunk-bytes") {
+                if (!(value = next())) return false;
+                opts.chunkBytes = std::max<size_t>(1, std::stoul(value));
+            } else if (arg == "--sched-stats") {
+                opts.schedStats = true;
+            } else if (arg == "--deadline-ms") {
+                if (!(value = next())) return false;
+                opts.deadlineMs = std::stoull(value);
+            } else if (arg == "--heatmap") {
+                if (!(value = next())) return false;
+                opts.heatmapPath = value;
+            } else if (arg == "--heatmap-sample") {
+                if (!(value = next())) return false;
+                opts.heatmapSample = static_cast<uint32_t>(std::stoul(value));
+            } else if (!arg.empty() && arg[0] == '-') {
+                fprintf(stderr, "Error: unknown option: %s\n", arg.c_str());
+                return false;
+            } else {
+                opts.inputs.push_back(arg);
+            }
+        } catch (const std::exception&) {
+            // std::stoul() and friends on a value that is not a number
+            fprintf(stderr, "Error: invalid value for %s: %s\n", arg.c_str(), value ? value : "");
+            return false;
+        }
+    }
+
+    if (opts.inputs.empty()) {
+        fprintf(stderr, "Error: no capture files or directories given\n");
+        return false;
+    }
+    if (opts.patternJsonFiles.empty() && opts.patternTextFiles.empty()) {
+        fprintf(stderr, "Error: no pattern files given (use --patterns or --pattern-file)\n");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Loaded patterns; a pattern id indexes patterns, categories and targets
+ */
+struct PatternTable {
+    std::vector<std::string> patterns;
+    std::vector<std::string> categories;
+    std::vector<FieldTarget> targets;
+    std::vector<uint32_t> payloadIds;  // Automaton id -> pattern id (the patterns not scoped to a field)
+    bool scoped = false;               // Some patterns are scoped to a field
+};
+
+/**
+ * Load patterns from all sources, keeping the category and target of each pattern
+ */
+void loadPatterns(const Options& opts, PatternTable& table) {
+    std::map<std::string, std::vector<std::string>> patternMap;
+    std::map<std::string, std::vector<std::string>> fieldMap;
+
+    for (const auto& path : opts.patternJsonFiles) {
+        std::map<std::string, std::vector<std::string>> fields;
+        for (auto& [category, list] : PatternsLoader::loadPatterns(path, &fields)) {
+            auto& dest = patternMap[category];
+            dest.insert(dest.end(), list.begin(), list.end());
+            auto& destFields = fieldMap[category];
+            destFields.resize(dest.size() - list.size());
+            destFields.insert(destFields.end(), fields[category].begin(), fields[category].end());
+        }
+    }
+
+    for (const auto& path : opts.patternTextFiles) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            fprintf(stderr, "Error: Could not open pattern file: %s\n", path.c_str());
+            continue;
+        }
+        std::string category = fs::path(path).stem().string();
+        std::string line;
+        while (std::getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (!line.empty()) {
+                patternMap[category].push_back(line);
+            }
+        }
+    }
+
+    for (const auto& [category, list] : patternMap) {
+        if (!opts.categories.empty() && opts.categories.count(category) == 0) {
+            continue;
+        }
+        std::vector<std::string>& fields = fieldMap[category];
+        fields.resize(list.size());
+        for (size_t i = 0; i < list.size(); ++i) {
+            FieldTarget target;
+            if (!FieldTarget::parse(fields[i], target)) {
+                fprintf(stderr, "Warning: Unknown field '%s' for pattern '%s', matching the whole payload\n",
+                        fields[i].c_str(), list[i].c_str());
+            }
+            if (!target.scoped()) {
+                table.payloadIds.push_back(static_cast<uint32_t>(table.patterns.size()));
+            }
+            table.scoped = table.scoped || target.scoped();
+            table.patterns.push_back(list[i]);
+            table.categories.push_back(category);
+            table.targets.push_back(std::move(target));
+        }
+    }
+}
+
+void collectCaptures(const Options& opts, std::vector<std::string>& files) {
+    auto hasCaptureExtension = [&](const fs::path& path) {
+        std::string ext = path.extension().string();
+        return std::find(opts.extensions.begin(), opts.extensions.end(), ext) != opts.extensions.end();
+    };
+
+    for (const auto& input : opts.inputs) {
+        std::error_code ec;
+        if (fs::is_directory(input, ec)) {
+            for (auto it = fs::recursive_directory_iterator(input, ec);
+                 it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (ec) break;
+                if (it->is_regular_file(ec) && hasCaptureExtension(it->path())) {
+                    files.push_back(it->path().string());
+                }
+            }
+        } else if (fs::exists(input, ec)) {
+            files.push_back(input);
+        } else {
+            fprintf(stderr, "Warning: No such file or directory: %s\n", input.c_str());
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+}
+
+void appendJsonString(std::string& out, const std::string& value) {
+    out += '"';
+    for (unsigned char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (c < 0x20) {
+                    char buf[8];
+                    snprintf(buf, sizeof(buf), "\\u%04x", c);
+                    out += buf;
+                } else {
+                    out += static_cast<char>(c);
+                }
+        }
+    }
+    out += '"';
+}
+
+template <typename T>
+void appendRaw(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * Serialized writer shared by the workers; each worker batches into its own
+ * buffer and hands over large blocks so the lock is taken rarely
+ */
+class ResultWriter {
+public:
+    explicit ResultWriter(FILE* out) : out(out) {}
+
+    void write(const std::string& block) {
+        if (block.empty()) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        fwrite(block.data(), 1, block.size(), out);
+    }
+
+private:
+    FILE* out;
+    std::mutex mutex;
+};
+
+struct ScanTotals {
+    std::atomic<uint64_t> files{0};
+    std::atomic<uint64_t> failedFiles{0};
+    std::atomic<uint64_t> fileBytes{0};
+    std::atomic<uint64_t> packets{0};
+    std::atomic<uint64_t> payloadBytes{0};
+    std::atomic<uint64_t> matches{0};
+    std::atomic<uint64_t> normalizedMatches{0};
+    std::atomic<uint64_t> httpMessages{0};
+    std::atomic<uint64_t> skippedChunks{0};  // Not scanned because the deadline had passed
+};
+
+const size_t FLUSH_THRESHOLD = 1 << 20;
+const size_t MAX_BINARY_STRING = 0xffff;  // Paths and patterns carry a u16 length in binary output
+
+/**
+ * A loaded capture shared by the chunk tasks that scan it
+ * The packet views point into the reader's file buffer, freed with the last chunk
+ */
+struct CaptureJob {
+    size_t fileIndex = 0;
+    PacketReader reader;
+    std::vector<PacketView> packets;
+};
+
+/**
+ * Per-thread scratch, indexed by TaskScheduler::currentWorker()
+ */
+struct WorkerState {
+    std::vector<ByteSpan> packets;
+    BatchHits hits;
+    std::unique_ptr<HttpScanner> http;  // --http only
+    std::vector<HttpHit> normalized;
+    std::vector<FieldHit> fieldHits;
+    std::vector<uint32_t> fieldIds;  // Pattern ids of fieldHits, for the stats
+    std::string buffer;
+};
+
+/**
+ * Scans captures as scheduler tasks: scanFile() loads one capture and
+ * spawns scanChunk() tasks over its packets
+ */
+class CaptureScanner {
+public:
+    CaptureScanner(const Options& opts, const AhoCorasick& automaton, const PatternTable& table,
+                   const FieldScopedMatcher* fieldMatcher, const std::vector<std::string>& files,
+                   TaskScheduler& scheduler, ResultWriter& writer, ScanTotals& totals, PatternStats& stats,
+                   const CancelToken& cancel, std::shared_ptr<const AcTableMatcher> httpTable)
+        : opts(opts), automaton(automaton), table(table), fieldMatcher(fieldMatcher), files(files),
+          scheduler(scheduler), writer(writer), totals(totals), stats(stats), cancel(cancel),
+          states(scheduler.workerCount()) {
+        HttpNormalizerConfig httpConfig = HttpNormalizerConfig::fromEnvironment();
+        for (auto& state : states) {
+            state.buffer.reserve(FLUSH_THRESHOLD * 2);
+            if (httpTable) {
+                state.http = std::make_unique<HttpScanner>(httpTable, httpConfig);
+            }
+        }
+    }
+
+    void scanFile(size_t fileIndex) {
+        PI_TRACE_SCOPE("pktscan.file");
+        const std::string& path = files[fileIndex];
+        if (cancel.stopRequested()) {
+            return;
+        }
+
+        if (opts.format == OutputFormat::Binary && path.size() > MAX_BINARY_STRING) {
+            fprintf(stderr, "Error: path too long for binary output, skipping: %.64s...\n", path.c_str());
+            totals.failedFiles++;
+            return;
+        }
+
+        auto job = std::make_shared<CaptureJob>();
+        job->fileIndex = fileIndex;
+        int64_t bytesRead = job->reader.forEachPayload(path, [&](const PacketView& packet) {
+            if (packet.payloadLength >= opts.minLength && packet.payloadLength <= opts.maxLength) {
+                job->packets.push_back(packet);
+            }
+        });
+        if (bytesRead < 0) {
+            totals.failedFiles++;
+            return;
+        }
+        totals.files++;
+        totals.fileBytes += static_cast<uint64_t>(bytesRead);
+
+        // Only loaded files get a record, and it goes out before any chunk can emit matches
+        if (opts.format == OutputFormat::Binary) {
+            std::string record;
+            record += static_cast<char>(1);
+            appendRaw(record, static_cast<uint32_t>(fileIndex));
+            appendRaw(record, static_cast<uint16_t>(path.size()));
+            record += path;
+            writer.write(record);
+        }
+
+        // Chunks by payload bytes, so a jumbo payload is a chunk of its own
+        size_t begin = 0, chunkBytes = 0;
+        for (size_t i = 0; i < job->packets.size(); ++i) {
+            chunkBytes += job->packets[i].payloadLength;
+            if (chunkBytes >= opts.chunkBytes || i + 1 == job->packets.size()) {
+                scheduler.spawn([this, job, begin, end = i + 1]() { scanChunk(*job, begin, end); });
+                begin = i + 1;
+                chunkBytes = 0;
+            }
+        }
+    }
+
+    /**
+     * Write out what the workers still hold (after the scheduler run)
+     */
+    void flush() {
+        for (auto& state : states) {
+            writer.write(state.buffer);
+            state.buffer.clear();
+        }
+    }
+
+private:
+    void scanChunk(const CaptureJob& job, size_t begin, size_t end) {
+        PI_TRACE_SCOPE_ARG("pktscan.chunk", end - begin);
+        // Queued chunks drain in microseconds once the deadline has passed
+        if (cancel.stopRequested()) {
+            totals.skippedChunks++;
+            return;
+        }
+        WorkerState& state = states[TaskScheduler::currentWorker()];
+        BatchHits& hits = state.hits;
+        std::string& buffer = state.buffer;
+        const std::string& path = files[job.fileIndex];
+        uint64_t payloadBytes = 0;
+
+        // The whole chunk in one scanBatch() call, then its rows packet by packet
+        state.packets.clear();
+        for (size_t index = begin; index < end; ++index) {
+            state.packets.push_back({job.packets[index].payload, job.packets[index].payloadLength});
+            payloadBytes += job.packets[index].payloadLength;
+        }
+        hits.clear();
+        if (!table.payloadIds.empty()) {
+            automaton.scanBatch(state.packets.data(), state.packets.size(), hits);
+        }
+        if (table.scoped) {
+            // The automaton holds only the payload-wide patterns
+            for (uint32_t& id : hits.patternId) {
+                id = table.payloadIds[id];
+            }
+        }
+        stats.recordBatch(hits.patternId.data(), hits.size(), end - begin, payloadBytes);
+
+        size_t row = 0;
+        uint64_t normalizedCount = 0;
+        uint64_t fieldCount = 0;
+        std::vector<FieldHit>& fieldHits = state.fieldHits;
+        for (size_t index = begin; index < end; ++index) {
+            const PacketView& packet = job.packets[index];
+            size_t first = row;
+            if (row < hits.size() && hits.packetIndex[row] == index - begin) {
+                row = hits.packetEnd(row);
+            }
+            const std::vector<HttpHit>* normalized = state.http ? &scanHttp(state, packet) : nullptr;
+            size_t normalizedHits = normalized ? normalized->size() : 0;
+            normalizedCount += normalizedHits;
+            fieldHits.clear();
+            if (fieldMatcher) {
+                fieldMatcher->scan(packet.payload, packet.payloadLength, fieldHits);
+                state.fieldIds.clear();
+                for (const FieldHit& hit : fieldHits) {
+                    state.fieldIds.push_back(hit.patternId);
+                }
+                if (!state.fieldIds.empty()) {
+                    stats.recordBatch(state.fieldIds.data(), state.fieldIds.size(), 0, 0);
+                }
+                fieldCount += fieldHits.size();
+            }
+
+            if (opts.format == OutputFormat::Binary) {
+                for (size_t i = first; i < row; ++i) {
+                    buffer += static_cast<char>(2);
+                    appendRaw(buffer, static_cast<uint32_t>(job.fileIndex));
+                    appendRaw(buffer, packet.packetId);
+                    appendRaw(buffer, hits.patternId[i]);
+                    appendRaw(buffer, hits.offset[i]);
+                }
+                for (const FieldHit& hit : fieldHits) {
+                    buffer += static_cast<char>(4);
+                    appendRaw(buffer, static_cast<uint32_t>(job.fileIndex));
+                    appendRaw(buffer, packet.packetId);
+                    appendRaw(buffer, hit.patternId);
+                    appendRaw(buffer, hit.position);
+                    appendRaw(buffer, static_cast<uint8_t>(hit.field));
+                }
+                for (size_t i = 0; i < normalizedHits; ++i) {
+                    const HttpHit& hit = (*normalized)[i];
+                    buffer += static_cast<char>(3);
+                    appendRaw(buffer, static_cast<uint32_t>(job.fileIndex));
+                    appendRaw(buffer, packet.packetId);
+                    appendRaw(buffer, hit.patternId);
+                    appendRaw(buffer, hit.position);
+                    appendRaw(buffer, static_cast<uint8_t>(hit.field));
+                    appendRaw(buffer, hit.message);
+                }
+            } else if (row > first || !fieldHits.empty() || normalizedHits > 0 || opts.allPackets) {
+                buffer += "{\"file\":";
+                appendJsonString(buffer, path);
+                buffer += ",\"packetId\":" + std::to_string(packet.packetId);
+                buffer += ",\"timestamp\":" + std::to_string(packet.timestamp);
+                buffer += ",\"length\":" + std::to_string(packet.payloadLength);
+                buffer += ",\"matches\":[";
+                for (size_t i = first; i < row; ++i) {
+                    if (i > first) buffer += ',';
+                    buffer += "{\"pattern\":";
+                    appendJsonString(buffer, table.patterns[hits.patternId[i]]);
+                    buffer += ",\"category\":";
+                    appendJsonString(buffer, table.categories[hits.patternId[i]]);
+                    buffer += ",\"position\":" + std::to_string(hits.offset[i]) + "}";
+                }
+                for (size_t i = 0; i < fieldHits.size(); ++i) {
+                    const FieldHit& hit = fieldHits[i];
+                    if (i > 0 || row > first) buffer += ',';
+                    buffer += "{\"pattern\":";
+                    appendJsonString(buffer, table.patterns[hit.patternId]);
+                    buffer += ",\"category\":";
+                    appendJsonString(buffer, table.categories[hit.patternId]);
+                    buffer += ",\"field\":\"";
+                    buffer += httpFieldName(hit.field);
+                    buffer += "\",\"position\":" + std::to_string(hit.position) + "}";
+                }
+                buffer += "]";
+                if (normalized) {
+                    buffer += ",\"normalized\":[";
+                    for (size_t i = 0; i < normalizedHits; ++i) {
+                        const HttpHit& hit = (*normalized)[i];
+                        if (i > 0) buffer += ',';
+                        buffer += "{\"pattern\":";
+                        appendJsonString(buffer, table.patterns[hit.patternId]);
+                        buffer += ",\"category\":";
+                        appendJsonString(buffer, table.categories[hit.patternId]);
+                        buffer += ",\"field\":\"";
+                        buffer += httpFieldName(hit.field);
+                        buffer += "\",\"message\":" + std::to_string(hit.message);
+                        buffer += ",\"position\":" + std::to_string(hit.position) + "}";
+                    }
+                    buffer += "]";
+                }
+                buffer += "}\n";
+            }
+
+            if (buffer.size() >= FLUSH_THRESHOLD) {
+                writer.write(buffer);
+                buffer.clear();
+            }
+        }
+
+        totals.packets += end - begin;
+        totals.payloadBytes += payloadBytes;
+        totals.matches += hits.size() + fieldCount;
+        totals.normalizedMatches += normalizedCount;
+    }
+
+    /**
+     * Parse one payload as an HTTP stream of its own and match its normalized fields
+     * @return Matches in the fields their patterns target, empty unless the payload is valid HTTP
+     */
+    const std::vector<HttpHit>& scanHttp(WorkerState& state, const PacketView& packet) {
+        HttpScanner& http = *state.http;
+        uint64_t messagesBefore = http.getNormalizer().getStats().messages;
+        http.reset();
+        http.clearHits();
+        bool valid = http.feed(packet.payload, packet.payloadLength);
+        http.finish();
+        totals.httpMessages += http.getNormalizer().getStats().messages - messagesBefore;
+
+        state.normalized.clear();
+        if (valid) {
+            for (const HttpHit& hit : http.getHits()) {
+                if (table.targets[hit.patternId].admits(hit.field)) {
+                    state.normalized.push_back(hit);
+                }
+            }
+        }
+        return state.normalized;
+    }
+
+    const Options& opts;
+    const AhoCorasick& automaton;
+    const PatternTable& table;
+    const FieldScopedMatcher* fieldMatcher;  // Null unless some patterns are scoped to a field
+    const std::vector<std::string>& files;
+    TaskScheduler& scheduler;
+    ResultWriter& writer;
+    ScanTotals& totals;
+    PatternStats& stats;
+    const CancelToken& cancel;
+    std::vector<WorkerState> states;
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opts;
+    if (!parseArgs(argc, argv, opts)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    // Results own stdout; library diagnostics are redirected to stderr
+    fflush(stdout);
+    FILE* out = nullptr;
+    if (opts.outputPath.empty()) {
+        out = fdopen(dup(STDOUT_FILENO), "wb");
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+    } else {
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+        out = fopen(opts.outputPath.c_str(), "wb");
+    }
+    if (!out) {
+        fprintf(stderr, "Error: Could not open output: %s\n", opts.outputPath.c_str());
+        return 1;
+    }
+    setvbuf(out, nullptr, _IOFBF, FLUSH_THRESHOLD);
+
+    PatternTable table;
+    loadPatterns(opts, table);
+    const std::vector<std::string>& patterns = table.patterns;
+    if (patterns.empty()) {
+        fprintf(stderr, "Error: no patterns loaded\n");
+        return 1;
+    }
+    if (opts.format == OutputFormat::Binary) {
+        for (const auto& pattern : patterns) {
+            if (pattern.size() > MAX_BINARY_STRING) {
+                fprintf(stderr, "Error: binary output stores pattern lengths in 16 bits; a %zu-byte pattern does not fit\n",
+                        pattern.size());
+                return 1;
+            }
+        }
+    }
+
+    // Field-scoped patterns get their own sub-automata; the batch automaton keeps the rest
+    AhoCorasick automaton;
+    std::unique_ptr<FieldScopedMatcher> fieldMatcher;
+    if (table.scoped) {
+        std::vector<std::string> payloadPatterns;
+        for (uint32_t id : table.payloadIds) {
+            payloadPatterns.push_back(patterns[id]);
+        }
+        automaton.buildFromPatterns(payloadPatterns);
+        fieldMatcher = std::make_unique<FieldScopedMatcher>(std::make_shared<const PatternSet>(patterns),
+                                                            table.targets);
+        fprintf(stderr, "pktscan: %zu patterns scoped to HTTP fields\n", fieldMatcher->scopedCount());
+    } else {
+        automaton.buildFromPatterns(patterns);
+    }
+    if (!opts.heatmapPath.empty()) {
+        automaton.enableProfiling(opts.heatmapSample);
+    }
+
+    std::vector<std::string> files;
+    collectCaptures(opts, files);
+    if (files.empty()) {
+        fprintf(stderr, "Error: no capture files found\n");
+        return 1;
+    }
+
+    if (opts.format == OutputFormat::Binary) {
+        std::string header = "PKTSCAN1";
+        appendRaw(header, static_cast<uint32_t>(patterns.size()));
+        for (const auto& pattern : patterns) {
+            appendRaw(header, static_cast<uint16_t>(pattern.size()));
+            header += pattern;
+        }
+        fwrite(header.data(), 1, header.size(), out);
+    }
+
+    unsigned threadCount = std::max(1u, opts.threads ? opts.threads : std::thread::hardware_concurrency());
+
+    ResultWriter writer(out);
+    ScanTotals totals;
+    PatternStats stats(patterns);
+    TaskScheduler scheduler(threadCount);
+    CancelToken cancel;
+    if (opts.deadlineMs > 0) {
+        cancel.setTimeout(std::chrono::milliseconds(opts.deadlineMs));
+    }
+    std::shared_ptr<const AcTableMatcher> httpTable;
+    if (opts.http) {
+        httpTable = std::make_shared<const AcTableMatcher>(std::make_shared<const PatternSet>(patterns));
+        if (!HttpNormalizerConfig::inflateSupported()) {
+            fprintf(stderr, "Warning: built without zlib, gzip/deflate bodies are matched undecoded\n");
+        }
+    }
+    CaptureScanner scanner(opts, automaton, table, fieldMatcher.get(), files, scheduler, writer, totals, stats,
+                           cancel, httpTable);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<TaskScheduler::Task> fileTasks;
+    for (size_t i = 0; i < files.size(); ++i) {
+        fileTasks.push_back([&scanner, i]() { scanner.scanFile(i); });
+    }
+    scheduler.run(std::move(fileTasks));
+    scanner.flush();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    fclose(out);
+
+    if (cancel.reason() != CancelToken::Reason::None) {
+        fprintf(stderr, "pktscan: stopped (%s), %llu chunks not scanned\n",
+                CancelToken::reasonName(cancel.reason()), (unsigned long long)totals.skippedChunks.load());
+    }
+
+    double mb = static_cast<double>(totals.fileBytes) / (1024.0 * 1024.0);
+    fprintf(stderr,
+            "pktscan: %llu files (%llu failed), %llu packets, %llu payload bytes, %llu matches\n"
+            "pktscan: %.3f s on %u threads, %.1f MB/s, %.0f packets/s\n",
+            (unsigned long long)totals.files.load(), (unsigned long long)totals.failedFiles.load(),
+            (unsigned long long)totals.packets.load(), (unsigned long long)totals.payloadBytes.load(),
+            (unsigned long long)totals.matches.load(), seconds, threadCount,
+            seconds > 0 ? mb / seconds : 0.0,
+            seconds > 0 ? static_cast<double>(totals.packets) / seconds : 0.0);
+    if (opts.http) {
+        fprintf(stderr, "pktscan: %llu HTTP messages, %llu normalized matches\n",
+                (unsigned long long)totals.httpMessages.load(), (unsigned long long)totals.normalizedMatches.load());
+    }
+
+    if (!opts.heatmapPath.empty()) {
+        std::ofstream heatmap(opts.heatmapPath);
+        if (!heatmap) {
+            fprintf(stderr, "Error: Could not open heatmap output: %s\n", opts.heatmapPath.c_str());
+            return 1;
+        }
+        heatmap << automaton.exportHeatmapJson().dump();
+    }
+
+    json sched = scheduler.statsJson();
+    fprintf(stderr, "pktscan: %llu tasks, %llu steals, %.0f%% utilization\n",
+            (unsigned long long)sched["tasks"].get<uint64_t>(), (unsigned long long)sched["steals"].get<uint64_t>(),
+            sched["utilization"].get<double>() * 100.0);
+    if (opts.schedStats) {
+        const json& perWorker = sched["perWorker"];
+        for (size_t i = 0; i < perWorker.size(); ++i) {
+            fprintf(stderr, "pktscan: thread %2zu  %8llu tasks  %8llu steals  %8llu failed steals  %5.1f%% busy\n", i,
+                    (unsigned long long)perWorker[i]["tasks"].get<uint64_t>(),
+                    (unsigned long long)perWorker[i]["steals"].get<uint64_t>(),
+                    (unsigned long long)perWorker[i]["failedSteals"].get<uint64_t>(),
+                    perWorker[i]["utilization"].get<double>() * 100.0);
+        }
+    }
+
+    if (opts.topPatterns > 0) {
+        json top = stats.toJson({}, opts.topPatterns);
+        for (const auto& entry : top["patterns"]) {
+            uint32_t id = entry["id"];
+            fprintf(stderr, "pktscan: %10llu  %-12s %s\n",
+                    (unsigned long long)entry["hits"].get<uint64_t>(), table.categories[id].c_str(),
+                    entry["pattern"].get<std::string>().c_str());
+        }
+    }
+
+    return totals.failedFiles > 0 || cancel.reason() != CancelToken::Reason::None ? 1 : 0;
+}